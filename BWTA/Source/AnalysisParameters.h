@@ -0,0 +1,67 @@
+#pragma once
+
+namespace BWTA
+{
+	// Tuning constants of the terrain analysis. All of them are part of the cache key, so changing
+	// any value here invalidates the cached results (remember to add new ones to the hash functions below)
+
+	// polygon extraction (PolygonGenerator)
+	const int MIN_ARE_INNER_POLYGON = 140; // polygons with an area less than this will be discarded
+	const int MIN_ARE_POLYGON = 40; // polygons with an area less than this will be discarded
+	const int ANCHOR_MARGIN = 2; // margin to anchor a point into the borders of the map
+
+	// region and chokepoint detection (RegionGenerator)
+	const double DIFF_COEFICIENT = 0.31; // relative difference to consider a change between region<->chokepoint
+	const int MIN_NODE_DIST = 7; // minimum distance between nodes
+	const double MIN_REGION_OBST_DIST = 9.7; // minimum distance to object to be considered as a region
+	const double CHOKE_BUFFER_DISTANCE = 0.5; // buffer of the choke lines to ensure they will "cross" regions
+
+	// base locations (BaseLocationGenerator)
+	const int MIN_CLUSTER_DIST = 8; // minerals less than this distance will be grouped into the same cluster
+	const size_t MIN_RESOURCES = 3; // a cluster with less than this will be discarded
+	const int MAX_INFLUENCE_DISTANCE_RADIUS = 10; // max radius distance from a resource to place a base
+
+	// region coverage points (TerrainAnalysis)
+	const int COVERAGE_SIGHT_RANGE = 7 * 2 * 4; // SCV = 7 tiles * 2, transformed into walk tiles
+
+	// parameters of each stage of analyze_map(), also used to key the stage checkpoints (see StageCache.h)
+	template<typename Hasher>
+	void hashPolygonParameters(Hasher& hasher)
+	{
+		hasher.add(MIN_ARE_INNER_POLYGON);
+		hasher.add(MIN_ARE_POLYGON);
+		hasher.add(ANCHOR_MARGIN);
+	}
+
+	template<typename Hasher>
+	void hashGraphParameters(Hasher& hasher)
+	{
+		hasher.add(DIFF_COEFICIENT);
+		hasher.add(MIN_NODE_DIST);
+		hasher.add(MIN_REGION_OBST_DIST);
+	}
+
+	template<typename Hasher>
+	void hashRegionParameters(Hasher& hasher)
+	{
+		hasher.add(CHOKE_BUFFER_DISTANCE);
+	}
+
+	template<typename Hasher>
+	void hashBaseParameters(Hasher& hasher)
+	{
+		hasher.add(MIN_CLUSTER_DIST);
+		hasher.add(static_cast<uint64_t>(MIN_RESOURCES));
+		hasher.add(MAX_INFLUENCE_DISTANCE_RADIUS);
+		hasher.add(COVERAGE_SIGHT_RANGE);
+	}
+
+	template<typename Hasher>
+	void hashAnalysisParameters(Hasher& hasher)
+	{
+		hashPolygonParameters(hasher);
+		hashGraphParameters(hasher);
+		hashRegionParameters(hasher);
+		hashBaseParameters(hasher);
+	}
+}
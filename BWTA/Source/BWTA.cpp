@@ -1,14 +1,26 @@
 #include <BWTA.h>
 #include "BWTA_Result.h"
-#include "Heap.h"
 #include "MapData.h"
 #include "Pathfinding.h"
+#include "LoadData.h"
+#include "ClearanceSearch.h"
+#include "DistanceTransform.h"
+#include "DialSearch.h"
+#include "ObstacleOverlay.h"
+#include "FlowFieldCache.h"
+#include "LineOfSight.h"
 
 namespace BWTA
 {
 	void cleanMemory()
 	{
-		// clear everything
+		waitForAnalysis(); // never free the results under a running analysis
+		clearResults();
+		clearDistanceMatrixScheduler();
+	}
+
+	void clearResults()
+	{
 		for (auto r : BWTA_Result::regions) delete r;
 		BWTA_Result::regions.clear();
 		for (auto c : BWTA_Result::chokepoints) delete c;
@@ -18,6 +30,20 @@ namespace BWTA
 		for (auto b : BWTA_Result::baselocations) delete b;
 		BWTA_Result::baselocations.clear();
 		BWTA_Result::startlocations.clear();
+		BWTA_Result::skeleton.clear();
+		BWTA_Result::jumpTable.clear();
+		BWTA_Result::landmarks.clear();
+		BWTA_Result::contractionHierarchy.clear();
+		BWTA_Result::navMesh.clear();
+		getFlowFieldCache().clear();
+		getWalkabilityBits().reset();
+		clearChokeNodes();
+		closeCacheFile();
+	}
+
+	void setCompactLabelMaps(bool compact)
+	{
+		BWTA_Result::compactLabelMaps = compact;
 	}
 
 	const std::vector<Region*>& getRegions()			{ return BWTA_Result::regions; }
@@ -26,6 +52,12 @@ namespace BWTA
 	const std::set<BaseLocation*>& getStartLocations()	{ return BWTA_Result::startlocations; }
 	const std::vector<Polygon*>& getUnwalkablePolygons()	{ return BWTA_Result::unwalkablePolygons; }
 
+	const Skeleton& getSkeleton()
+	{
+		BWTA_Result::require(BWTA_Result::LAZY_SKELETON);
+		return BWTA_Result::skeleton;
+	}
+
 	BWAPI::Position getNearestUnwalkablePosition(BWAPI::Position position)
 	{
 		Polygon* p = BWTA::getNearestUnwalkablePolygon(position.x / 32, position.y / 32);
@@ -58,12 +90,16 @@ namespace BWTA
 	Region* getRegion(BWAPI::TilePosition tilePos) { return getRegion(BWAPI::WalkPosition(tilePos)); }
 	Region* getRegion(BWAPI::WalkPosition walkPos)
 	{
-		if (walkPos.x<0 || walkPos.y<0 || 
-			walkPos.x>=BWTA_Result::regionLabelMap.getWidth() || walkPos.y>=BWTA_Result::regionLabelMap.getHeight()) {
+		// in compact mode the label is read from the runs instead of rebuilding the dense map
+		bool compact = BWTA_Result::pendingMembers[BWTA_Result::LAZY_REGION_LABEL].load(std::memory_order_acquire);
+		int width = compact ? BWTA_Result::compactRegionLabelMap.getWidth() : BWTA_Result::regionLabelMap.getWidth();
+		int height = compact ? BWTA_Result::compactRegionLabelMap.getHeight() : BWTA_Result::regionLabelMap.getHeight();
+		if (walkPos.x<0 || walkPos.y<0 || walkPos.x>=width || walkPos.y>=height) {
 				LOG("WARNING getRegion called with wrong WalkPosition " << walkPos);
 				return nullptr;
 		}
-		int regionLabel = BWTA_Result::regionLabelMap[walkPos.x][walkPos.y];
+		int regionLabel = compact ? BWTA_Result::compactRegionLabelMap.getItem(walkPos.x, walkPos.y)
+			: BWTA_Result::regionLabelMap[walkPos.x][walkPos.y];
 		for (const auto& r : BWTA_Result::regions) {
 			if (r->getLabel() == regionLabel) { // TODO I need a vector to map labelId to Region*
 				return r;
@@ -84,6 +120,7 @@ namespace BWTA
 	}
 	Chokepoint* getNearestChokepoint(BWAPI::Position position)
 	{
+		BWTA_Result::require(BWTA_Result::LAZY_CHOKEPOINT_W);
 		return BWTA_Result::getChokepointW.getItemSafe(position.x / 8, position.y / 8);
 	}
 	BaseLocation* getNearestBaseLocation(int x, int y)
@@ -96,14 +133,17 @@ namespace BWTA
 	}
 	BaseLocation* getNearestBaseLocation(BWAPI::Position position)
 	{
+		BWTA_Result::require(BWTA_Result::LAZY_BASELOCATION_W);
 		return BWTA_Result::getBaseLocationW.getItemSafe(position.x / 8, position.y / 8);
 	}
 	Polygon* getNearestUnwalkablePolygon(int x, int y)
 	{
+		BWTA_Result::require(BWTA_Result::LAZY_UNWALKABLE_POLYGON);
 		return BWTA_Result::getUnwalkablePolygon.getItemSafe(x, y);
 	}
 	Polygon* getNearestUnwalkablePolygon(BWAPI::TilePosition tileposition)
 	{
+		BWTA_Result::require(BWTA_Result::LAZY_UNWALKABLE_POLYGON);
 		return BWTA_Result::getUnwalkablePolygon.getItemSafe(tileposition.x, tileposition.y);
 	}
 
@@ -116,7 +156,41 @@ namespace BWTA
 		Region* r1 = getRegion(a);
 		Region* r2 = getRegion(b);
 		if (r1 == nullptr || r2 == nullptr) return false;
-		return r1->isReachable(r2);
+		if (!r1->isReachable(r2)) return false;
+		return getObstacleOverlay().empty() || getObstacleOverlay().isConnected(a, b);
+	}
+
+	static std::vector<BWAPI::TilePosition> getRectangleTiles(BWAPI::TilePosition topLeft, int width, int height)
+	{
+		std::vector<BWAPI::TilePosition> tiles;
+		for (int x = topLeft.x; x < topLeft.x + width; ++x) {
+			for (int y = topLeft.y; y < topLeft.y + height; ++y) tiles.push_back(BWAPI::TilePosition(x, y));
+		}
+		return tiles;
+	}
+	void blockTiles(const std::vector<BWAPI::TilePosition>& tiles)
+	{
+		getObstacleOverlay().block(tiles);
+	}
+	void blockTiles(BWAPI::TilePosition topLeft, int width, int height)
+	{
+		getObstacleOverlay().block(getRectangleTiles(topLeft, width, height));
+	}
+	void unblockTiles(const std::vector<BWAPI::TilePosition>& tiles)
+	{
+		getObstacleOverlay().unblock(tiles);
+	}
+	void unblockTiles(BWAPI::TilePosition topLeft, int width, int height)
+	{
+		getObstacleOverlay().unblock(getRectangleTiles(topLeft, width, height));
+	}
+	void unblockAllTiles()
+	{
+		getObstacleOverlay().unblockAll();
+	}
+	bool isTileBlocked(BWAPI::TilePosition tile)
+	{
+		return getObstacleOverlay().isBlocked(tile);
 	}
 	std::pair<BWAPI::TilePosition, double> getNearestTilePosition(BWAPI::TilePosition start, const std::set<BWAPI::TilePosition>& targets)
 	{
@@ -149,44 +223,29 @@ namespace BWTA
 	}
 	void getGroundDistanceMap(BWAPI::TilePosition start, RectangleArray<double>& distanceMap)
 	{
-		distanceMap.resize(MapData::mapWidthTileRes, MapData::mapHeightTileRes);
-		Heap< BWAPI::TilePosition, int > heap(true);
-		for (unsigned int x = 0; x < distanceMap.getWidth(); x++) {
-			for (unsigned int y = 0; y < distanceMap.getHeight(); y++) {
-				distanceMap[x][y] = -1;
-			}
-		}
-		heap.push(std::make_pair(start, 0));
-		int sx = (int)start.x;
-		int sy = (int)start.y;
-		distanceMap[sx][sy] = 0;
-		while (!heap.empty()) {
-			BWAPI::TilePosition pos = heap.top().first;
-			int distance = heap.top().second;
-			heap.pop();
-			int x = (int)pos.x;
-			int y = (int)pos.y;
-			int min_x = std::max(x - 1, 0);
-			int max_x = std::min(x + 1, (int)distanceMap.getWidth() - 1);
-			int min_y = std::max(y - 1, 0);
-			int max_y = std::min(y + 1, (int)distanceMap.getHeight() - 1);
-			for (int ix = min_x; ix <= max_x; ix++) {
-				for (int iy = min_y; iy <= max_y; iy++) {
-					int f = std::abs(ix - x) * 32 + std::abs(iy - y) * 32;
-					if (f > 32) { f = 45; }
-					int v = distance + f;
-					if (distanceMap[ix][iy] > v) {
-						heap.push(std::make_pair(BWAPI::TilePosition(x, y), v));
-						distanceMap[ix][iy] = v;
-					} else {
-						if (distanceMap[ix][iy] == -1 && MapData::lowResWalkability[ix][iy] == true) {
-							distanceMap[ix][iy] = v;
-							heap.push(std::make_pair(BWAPI::TilePosition(ix, iy), v));
-						}
-					}
-				}
+		dialSearch(start, distanceMap, -1.0, std::numeric_limits<int>::max());
+	}
+	void getGroundDistanceMap(BWAPI::TilePosition start, RectangleArray<uint16_t>& distanceMap)
+	{
+		dialSearch(start, distanceMap, std::numeric_limits<uint16_t>::max(), std::numeric_limits<uint16_t>::max() - 1);
+	}
+	void getGroundDistanceMatrix(const std::vector<BWAPI::TilePosition>& sources, const std::vector<BWAPI::TilePosition>& targets,
+		RectangleArray<double>& matrix, bool parallel)
+	{
+		// same test as isConnected, with one region lookup per position instead of one per pair
+		std::vector<Region*> targetRegions;
+		for (const auto& target : targets) targetRegions.push_back(getRegion(target));
+		const bool blocked = !getObstacleOverlay().empty();
+		std::vector<char> connected(sources.size() * targets.size(), 0);
+		for (size_t i = 0; i < sources.size(); ++i) {
+			Region* sourceRegion = getRegion(sources[i]);
+			if (sourceRegion == nullptr) continue;
+			for (size_t j = 0; j < targets.size(); ++j) {
+				connected[i * targets.size() + j] = targetRegions[j] != nullptr && sourceRegion->isReachable(targetRegions[j])
+					&& (!blocked || getObstacleOverlay().isConnected(sources[i], targets[j]));
 			}
 		}
+		DijkstraDistanceMatrix(sources, targets, connected, matrix, parallel);
 	}
 	std::vector<BWAPI::TilePosition> getShortestPath(BWAPI::TilePosition start, BWAPI::TilePosition end)
 	{
@@ -194,6 +253,31 @@ namespace BWTA
 		if (!isConnected(start, end)) return path;
 		return AstarSearchPath(start, end);
 	}
+	std::vector<BWAPI::TilePosition> getAnyAnglePath(BWAPI::TilePosition start, BWAPI::TilePosition end)
+	{
+		return smoothPath(getShortestPath(start, end));
+	}
+	bool hasLineOfSight(BWAPI::TilePosition a, BWAPI::TilePosition b)
+	{
+		return getWalkabilityBits().hasLineOfSight(a, b);
+	}
+	std::vector<BWAPI::Position> getNavMeshPath(BWAPI::Position start, BWAPI::Position end)
+	{
+		std::vector<BWAPI::Position> path;
+		if (!isConnected(BWAPI::TilePosition(start), BWAPI::TilePosition(end))) return path;
+		BWTA_Result::require(BWTA_Result::LAZY_NAVMESH);
+		if (getObstacleOverlay().empty()) path = BWTA_Result::navMesh.getPath(start, end);
+		if (!path.empty()) return path;
+		// blocked tiles, or a passage the simplified polygons closed
+		for (const auto& tile : getAnyAnglePath(BWAPI::TilePosition(start), BWAPI::TilePosition(end))) {
+			path.push_back(BWAPI::Position(tile) + BWAPI::Position(16, 16));
+		}
+		if (!path.empty()) {
+			path.front() = start;
+			path.back() = end;
+		}
+		return path;
+	}
 	std::vector<BWAPI::TilePosition> getShortestPath(BWAPI::TilePosition start, const std::set<BWAPI::TilePosition>& targets)
 	{
 		std::vector<BWAPI::TilePosition> path;
@@ -208,13 +292,73 @@ namespace BWTA
 		return AstarSearchPath(start, valid_targets);
 	}
 
+	static int getUnitSize(BWAPI::UnitType unitType)
+	{
+		return std::max(unitType.width(), unitType.height());
+	}
+	std::vector<BWAPI::WalkPosition> getClearancePath(BWAPI::WalkPosition start, BWAPI::WalkPosition end, int unitSize)
+	{
+		std::vector<BWAPI::WalkPosition> path;
+		clearanceSearch(start, end, getRequiredClearance(unitSize), &path);
+		return path;
+	}
+	std::vector<BWAPI::WalkPosition> getClearancePath(BWAPI::WalkPosition start, BWAPI::WalkPosition end, BWAPI::UnitType unitType)
+	{
+		return getClearancePath(start, end, getUnitSize(unitType));
+	}
+	double getClearanceDistance(BWAPI::WalkPosition start, BWAPI::WalkPosition end, int unitSize)
+	{
+		int cost = clearanceSearch(start, end, getRequiredClearance(unitSize), nullptr);
+		if (cost == -1) return -1;
+		return cost * 8.0 / 10.0;
+	}
+	double getClearanceDistance(BWAPI::WalkPosition start, BWAPI::WalkPosition end, BWAPI::UnitType unitType)
+	{
+		return getClearanceDistance(start, end, getUnitSize(unitType));
+	}
+
 	int getMaxDistanceTransform()
 	{
+		requireDistanceTransform();
 		return MapData::maxDistanceTransform;
 	}
 
 	RectangleArray<int>* getDistanceTransformMap()
 	{
+		requireDistanceTransform();
 		return &MapData::distanceTransform;
 	}
+
+	GridView<bool> getWalkabilityView()			{ return GridView<bool>(MapData::walkability); }
+	GridView<int> getDistanceTransformView()	{ requireDistanceTransform(); return GridView<int>(MapData::distanceTransform); }
+	GridView<bool> getBuildabilityView()		{ return GridView<bool>(MapData::buildability); }
+	GridView<Chokepoint*> getNearestChokepointView()		{ return GridView<Chokepoint*>(BWTA_Result::getChokepoint); }
+	GridView<BaseLocation*> getNearestBaseLocationView()	{ return GridView<BaseLocation*>(BWTA_Result::getBaseLocation); }
+
+	// in compact mode or with lazy loading the dense arrays are built on the first request
+	GridView<int> getRegionLabelView()
+	{
+		BWTA_Result::require(BWTA_Result::LAZY_REGION_LABEL);
+		return GridView<int>(BWTA_Result::regionLabelMap);
+	}
+	GridView<int> getClosestObstacleLabelView()
+	{
+		BWTA_Result::require(BWTA_Result::LAZY_CLOSEST_OBSTACLE_LABEL);
+		return GridView<int>(BWTA_Result::closestObstacleLabelMap);
+	}
+	GridView<Chokepoint*> getNearestChokepointWalkView()
+	{
+		BWTA_Result::require(BWTA_Result::LAZY_CHOKEPOINT_W);
+		return GridView<Chokepoint*>(BWTA_Result::getChokepointW);
+	}
+	GridView<BaseLocation*> getNearestBaseLocationWalkView()
+	{
+		BWTA_Result::require(BWTA_Result::LAZY_BASELOCATION_W);
+		return GridView<BaseLocation*>(BWTA_Result::getBaseLocationW);
+	}
+	GridView<Polygon*> getNearestUnwalkablePolygonView()
+	{
+		BWTA_Result::require(BWTA_Result::LAZY_UNWALKABLE_POLYGON);
+		return GridView<Polygon*>(BWTA_Result::getUnwalkablePolygon);
+	}
 }
\ No newline at end of file
@@ -9,6 +9,11 @@ namespace BWTA
 		std::set<BaseLocation*> baselocations;
 		std::set<BaseLocation*> startlocations;
 		std::vector<Polygon*> unwalkablePolygons;
+		Skeleton skeleton;
+		JumpTable jumpTable;
+		LandmarkTable landmarks;
+		ContractionHierarchy contractionHierarchy;
+		NavMesh navMesh;
 
 		RectangleArray<Region*> getRegion;
 		RectangleArray<Polygon*> getUnwalkablePolygon;
@@ -20,5 +25,12 @@ namespace BWTA
 		RectangleArray<int> obstacleLabelMap;
 		RectangleArray<int> closestObstacleLabelMap;
 		RectangleArray<int> regionLabelMap;	// stores the region ID in walk resolution
+
+		bool compactLabelMaps = false;
+		RleColumnArray compactObstacleLabelMap;
+		RleColumnArray compactClosestObstacleLabelMap;
+		RleColumnArray compactRegionLabelMap;
+
+		std::atomic<bool> pendingMembers[LAZY_MEMBER_COUNT];
 	};
 }
\ No newline at end of file
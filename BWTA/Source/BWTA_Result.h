@@ -1,6 +1,12 @@
 #pragma once
 
 #include <BWTA.h>
+#include "RleColumnArray.h"
+#include "JumpPointSearch.h"
+#include "LandmarkTable.h"
+#include "ContractionHierarchy.h"
+#include "NavMesh.h"
+#include <atomic>
 
 namespace BWTA
 {
@@ -13,6 +19,11 @@ namespace BWTA
 		extern std::set<BaseLocation*> baselocations;
 		extern std::set<BaseLocation*> startlocations;
 		extern std::vector<Polygon*> unwalkablePolygons;
+		extern Skeleton skeleton;
+		extern JumpTable jumpTable; // JPS+ jump distances, tile resolution
+		extern LandmarkTable landmarks; // ALT landmark distances, tile resolution
+		extern ContractionHierarchy contractionHierarchy; // GroundDistanceOracle, tile resolution
+		extern NavMesh navMesh; // getNavMeshPath, pixels
 
 		// Distance Map to closest elements (by defaults in Tile resolution, W = Walk resolution)
 		extern RectangleArray<Region*> getRegion; // TODO remove, use regionLabelMap instead
@@ -22,10 +33,40 @@ namespace BWTA
 		extern RectangleArray<BaseLocation*> getBaseLocationW;
 		extern RectangleArray<BaseLocation*> getBaseLocation;
 
-		// TODO save this data
+		// label maps (walk resolution), also stored in the cache file
 		extern RectangleArray<int> obstacleLabelMap;
 		extern RectangleArray<int> closestObstacleLabelMap;
 		extern RectangleArray<int> regionLabelMap;
 		// TODO add closestRegionLabelMap
+
+		// run-length encoded label maps, only filled when compactLabelMaps is set
+		extern bool compactLabelMaps;
+		extern RleColumnArray compactObstacleLabelMap;
+		extern RleColumnArray compactClosestObstacleLabelMap;
+		extern RleColumnArray compactRegionLabelMap;
+		void compressLabelMaps(); // defined in LoadData.cpp
+
+		// Members that, when loaded from the cache file (or compacted), are only materialized on first access
+		enum LazyMember {
+			LAZY_CHOKEPOINT_W,			// getChokepointW
+			LAZY_BASELOCATION_W,		// getBaseLocationW
+			LAZY_UNWALKABLE_POLYGON,	// getUnwalkablePolygon
+			LAZY_BASE_DISTANCES,		// BaseLocationImpl ground/air distances
+			LAZY_OBSTACLE_LABEL,		// obstacleLabelMap (compact mode)
+			LAZY_CLOSEST_OBSTACLE_LABEL,// closestObstacleLabelMap (compact mode)
+			LAZY_REGION_LABEL,			// regionLabelMap (compact mode)
+			LAZY_SKELETON,				// skeleton
+			LAZY_JUMP_TABLE,			// jumpTable
+			LAZY_LANDMARKS,				// landmarks
+			LAZY_CONTRACTION_HIERARCHY,	// contractionHierarchy
+			LAZY_NAVMESH,				// navMesh
+			LAZY_MEMBER_COUNT
+		};
+		extern std::atomic<bool> pendingMembers[LAZY_MEMBER_COUNT];
+		void materialize(LazyMember member); // defined in LoadData.cpp
+		inline void require(LazyMember member)
+		{
+			if (pendingMembers[member].load(std::memory_order_acquire)) materialize(member);
+		}
 	};
 }
\ No newline at end of file
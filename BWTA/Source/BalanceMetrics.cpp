@@ -6,7 +6,6 @@ namespace BWTA
 	{
 		// TODO check if map is analyzed
 		// TODO check if distance transform is procesed
-		// TODO check if buildChokeNodes was called (MapData::chokeNodes was populated)
 		
 		LOG("Starting map balance analysis");
 		// **************************************************
@@ -55,6 +54,19 @@ namespace BWTA
 		LOG(standardDeviationOpenness);
 		LOG(meanOpenness);
 
+		// ground distances from every base location to every start location, computed once for metrics 2-4
+		std::vector<BWTA::BaseLocation*> allBaseLocations(BWTA::getBaseLocations().begin(), BWTA::getBaseLocations().end());
+		std::map<BWTA::BaseLocation*, int> baseIndex;
+		std::vector<BWAPI::TilePosition> basePositions;
+		std::vector<BWAPI::TilePosition> startPositions;
+		for (const auto& base : allBaseLocations) {
+			baseIndex[base] = (int)basePositions.size();
+			basePositions.push_back(BWAPI::TilePosition(base->getPosition()));
+		}
+		for (const auto& startLocation : startLocations) startPositions.push_back(BWAPI::TilePosition(startLocation->getPosition()));
+		RectangleArray<double> groundDistances;
+		BWTA::getGroundDistanceMatrix(basePositions, startPositions, groundDistances, true);
+
 		// **************************************************
 		// METRIC 2
 		// --------------------------------------------------
@@ -73,7 +85,7 @@ namespace BWTA
 		for(int i = 0; i < startSize ; i++) {
 			for(int j = 0 ; j < startSize ; j++) {
 				if(i < j) {
-					distanceA = BWTA::getGroundDistance(BWAPI::TilePosition(startLocations[i]->getPosition()), BWAPI::TilePosition(startLocations[j]->getPosition()));
+					distanceA = groundDistances[baseIndex[startLocations[i]]][j];
 					distanceE = startLocations[i]->getPosition().getDistance(startLocations[j]->getPosition());
 
 					meanAstar += distanceA;
@@ -92,7 +104,7 @@ namespace BWTA
 		for(int i = 0; i < startSize ; i++) {
 			for(int j = 0 ; j < startSize ; j++) {
 				if(i < j) {
-					distanceA = BWTA::getGroundDistance(BWAPI::TilePosition(startLocations[i]->getPosition()), BWAPI::TilePosition(startLocations[j]->getPosition()));
+					distanceA = groundDistances[baseIndex[startLocations[i]]][j];
 					distanceE = startLocations[i]->getPosition().getDistance(startLocations[j]->getPosition());
 
 					standardDeviationAstar += pow(distanceA-meanAstar,2); 
@@ -126,13 +138,14 @@ namespace BWTA
 		double distance;
 
 		for (std::vector<BWTA::BaseLocation*>::const_iterator it = startLocations.begin(); it != startLocations.end(); ++it) {
+			const int startIndex = (int)(it - startLocations.begin());
 			std::set<BWTA::BaseLocation*> allBases = BWTA::getBaseLocations();
 			allBases.erase(*it);
 			baseExpansions[*it].dist1 = (std::numeric_limits<double>::max)();
 			baseExpansions[*it].dist2 = (std::numeric_limits<double>::max)();
 			for(std::set<BWTA::BaseLocation*>::iterator i=allBases.begin();i!=allBases.end();++i) {
 				// calculate distance
-				distance = BWTA::getGroundDistance(BWAPI::TilePosition((*i)->getPosition()), BWAPI::TilePosition((*it)->getPosition()));
+				distance = groundDistances[baseIndex[*i]][startIndex];
 				// insert to map
 				if (distance > -1 && baseExpansions[*it].dist2 > distance) {
 					baseExpansions[*it].dist2 = distance;
@@ -185,7 +198,7 @@ namespace BWTA
 
 		for (std::vector<BWTA::BaseLocation*>::const_iterator it = startLocations.begin(); it != startLocations.end(); ++it) {
 			for(std::set<BWTA::BaseLocation*>::iterator i=allExpansions.begin();i!=allExpansions.end();++i) {
-				distance = BWTA::getGroundDistance(BWAPI::TilePosition((*i)->getPosition()), BWAPI::TilePosition((*it)->getPosition()));
+				distance = groundDistances[baseIndex[*i]][id];
 				meanExp[id] += distance;
 			}
 			
@@ -197,7 +210,7 @@ namespace BWTA
 		id = 0;
 		for (std::vector<BWTA::BaseLocation*>::const_iterator it = startLocations.begin(); it != startLocations.end(); ++it) {
 			for(std::set<BWTA::BaseLocation*>::iterator i=allExpansions.begin();i!=allExpansions.end();++i) {
-				distance = BWTA::getGroundDistance(BWAPI::TilePosition((*i)->getPosition()), BWAPI::TilePosition((*it)->getPosition()));
+				distance = groundDistances[baseIndex[*i]][id];
 				standardDeviationExp[id] += pow(distance-meanExp[id],2);
 			}
 			standardDeviationExp[id] = sqrt(standardDeviationExp[id]/allExpansions.size());
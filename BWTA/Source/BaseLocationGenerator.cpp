@@ -3,13 +3,10 @@
 #include "BaseLocationImpl.h"
 #include "RegionImpl.h"
 #include "Heap.h"
+#include "AnalysisParameters.h"
 
 namespace BWTA
 {
-	const int MIN_CLUSTER_DIST = 8; // minerals less than this distance will be grouped into the same cluster
-	const size_t MIN_RESOURCES = 3; // a cluster with less than this will be discarded
-	const int MAX_INFLUENCE_DISTANCE_RADIUS = 10; // max radius distance from a resource to place a base
-
 	// TODO review this method, probably we can optimize it
 	void calculate_walk_distances_area(const BWAPI::Position& start, int width, int height, int max_distance, 
 		RectangleArray<int>& distance_map)
@@ -339,29 +336,34 @@ namespace BWTA
 		}
 	}
 
-	void calculateBaseLocationProperties()
+	void calculateBaseLocationDistances(BaseLocation* base)
 	{
-		RectangleArray<double> distanceMap; 
-		for (auto& base : BWTA_Result::baselocations) {
-			BaseLocationImpl* baseI = static_cast<BaseLocationImpl*>(base);
-
-			// TODO this can be optimized only computing the distance between reachable base locations
-			BWAPI::TilePosition baseTile = base->getTilePosition();
-			getGroundDistanceMap(baseTile, distanceMap);
-			// assume the base location is an island unless we can walk from this base location to another base location
-			for (const auto& base2 : BWTA_Result::baselocations) {
-				if (base == base2) {
-					baseI->groundDistances[base2] = 0;
-					baseI->airDistances[base2] = 0;
-				} else {
-					BWAPI::TilePosition base2Tile = base2->getTilePosition();
-					if (baseI->_isIsland && isConnected(baseTile, base2Tile)) {
-						baseI->_isIsland = false;
-					}
-					baseI->groundDistances[base2] = distanceMap[base2Tile.x][base2Tile.y];
-					baseI->airDistances[base2] = baseTile.getDistance(base2Tile);
+		RectangleArray<double> distanceMap;
+		BaseLocationImpl* baseI = static_cast<BaseLocationImpl*>(base);
+
+		// TODO this can be optimized only computing the distance between reachable base locations
+		BWAPI::TilePosition baseTile = base->getTilePosition();
+		getGroundDistanceMap(baseTile, distanceMap);
+		// assume the base location is an island unless we can walk from this base location to another base location
+		for (const auto& base2 : BWTA_Result::baselocations) {
+			if (base == base2) {
+				baseI->groundDistances[base2] = 0;
+				baseI->airDistances[base2] = 0;
+			} else {
+				BWAPI::TilePosition base2Tile = base2->getTilePosition();
+				if (baseI->_isIsland && isConnected(baseTile, base2Tile)) {
+					baseI->_isIsland = false;
 				}
+				baseI->groundDistances[base2] = distanceMap[base2Tile.x][base2Tile.y];
+				baseI->airDistances[base2] = baseTile.getDistance(base2Tile);
 			}
+		}
+	}
+
+	void assignBaseLocationsToRegions()
+	{
+		for (auto& base : BWTA_Result::baselocations) {
+			BaseLocationImpl* baseI = static_cast<BaseLocationImpl*>(base);
 
 			// find what region this base location is in and tell that region about the base location
 			BWAPI::WalkPosition baseWalkPos(base->getPosition());
@@ -373,7 +375,6 @@ namespace BWTA
 					break;
 				}
 			}
-
 		}
 	}
 }
\ No newline at end of file
@@ -8,5 +8,8 @@ namespace BWTA
 {
 	void detectBaseLocations(std::set<BaseLocation*>& baseLocations);
 	void attachResourcePointersToBaseLocations(std::set<BaseLocation*>& baseLocations);
-	void calculateBaseLocationProperties();
+	// distances to the other base locations and isIsland, independent for each base location
+	void calculateBaseLocationDistances(BaseLocation* base);
+	// sets the region of each base location, after their distances
+	void assignBaseLocationsToRegions();
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "BaseLocationImpl.h"
+#include "BWTA_Result.h"
 
 namespace BWTA
 {
@@ -38,6 +39,7 @@ namespace BWTA
 
 	const double BaseLocationImpl::getGroundDistance(BaseLocation* other) const
 	{
+		BWTA_Result::require(BWTA_Result::LAZY_BASE_DISTANCES);
 		auto it = groundDistances.find(other);
 		if (it == groundDistances.end()) return -1;
 		return (*it).second;
@@ -45,6 +47,7 @@ namespace BWTA
 
 	const double BaseLocationImpl::getAirDistance(BaseLocation* other) const
 	{
+		BWTA_Result::require(BWTA_Result::LAZY_BASE_DISTANCES);
 		auto it = airDistances.find(other);
 		if (it == airDistances.end()) return -1;
 		return (*it).second;
@@ -0,0 +1,348 @@
+#include "CacheFile.h"
+#include "RleColumnArray.h"
+
+#include <atomic>
+#include <cstdio>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace BWTA
+{
+	namespace CacheFile
+	{
+		bool readHeader(const std::string& filename, Header& header)
+		{
+			std::ifstream file_in(filename.c_str(), std::ios::in | std::ios::binary);
+			if (!file_in) return false;
+
+			unsigned char bytes[HEADER_SIZE];
+			file_in.read(reinterpret_cast<char*>(bytes), HEADER_SIZE);
+			if (file_in.gcount() != HEADER_SIZE) return false;
+
+			header.magic = readUInt32(bytes);
+			header.version = readUInt32(bytes + 4);
+			header.sectionCount = readUInt32(bytes + 8);
+			header.width = readUInt32(bytes + 12);
+			header.height = readUInt32(bytes + 16);
+			return header.magic == MAGIC;
+		}
+
+		std::string temporaryFilename(const std::string& filename)
+		{
+			// the process id keeps other processes apart, the counter the threads of this one
+			static std::atomic<unsigned> counter(0);
+#ifdef _WIN32
+			unsigned long processId = GetCurrentProcessId();
+#else
+			unsigned long processId = (unsigned long)getpid();
+#endif
+			std::ostringstream name;
+			name << filename << "." << processId << "." << counter++ << ".tmp";
+			return name.str();
+		}
+
+		bool replaceFile(const std::string& tmpFilename, const std::string& filename)
+		{
+#ifdef _WIN32
+			// fails while another process has the file mapped, the old file then stays valid
+			bool replaced = MoveFileExA(tmpFilename.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+			bool replaced = std::rename(tmpFilename.c_str(), filename.c_str()) == 0;
+#endif
+			if (!replaced) std::remove(tmpFilename.c_str());
+			return replaced;
+		}
+
+		static void appendUInt32(std::vector<unsigned char>& out, uint32_t value)
+		{
+			out.push_back(static_cast<unsigned char>(value & 0xFF));
+			out.push_back(static_cast<unsigned char>((value >> 8) & 0xFF));
+			out.push_back(static_cast<unsigned char>((value >> 16) & 0xFF));
+			out.push_back(static_cast<unsigned char>((value >> 24) & 0xFF));
+		}
+
+		static size_t alignUp(size_t value)
+		{
+			return (value + SECTION_ALIGNMENT - 1) & ~(size_t)(SECTION_ALIGNMENT - 1);
+		}
+	}
+
+	//------------------------------------------------ WRITER ------------------------------------------------
+
+	void CacheWriter::beginSection(uint32_t id, uint32_t encoding)
+	{
+		// pad the body so every section (and the grid data after its 8 bytes header) is aligned
+		_body.resize(CacheFile::alignUp(_body.size()), 0);
+		CacheFile::SectionEntry entry;
+		entry.id = id;
+		entry.encoding = encoding;
+		entry.offset = static_cast<uint32_t>(_body.size()); // relative to the body until save()
+		entry.size = 0;
+		_sections.push_back(entry);
+	}
+
+	void CacheWriter::endSection()
+	{
+		CacheFile::SectionEntry& entry = _sections.back();
+		entry.size = static_cast<uint32_t>(_body.size() - entry.offset);
+	}
+
+	void CacheWriter::writeInt(int32_t value)
+	{
+		CacheFile::appendUInt32(_body, static_cast<uint32_t>(value));
+	}
+
+	void CacheWriter::writeDouble(double value)
+	{
+		uint64_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		CacheFile::appendUInt32(_body, static_cast<uint32_t>(bits & 0xFFFFFFFF));
+		CacheFile::appendUInt32(_body, static_cast<uint32_t>(bits >> 32));
+	}
+
+	void CacheWriter::writeBytes(const void* bytes, size_t size)
+	{
+		const unsigned char* p = static_cast<const unsigned char*>(bytes);
+		_body.insert(_body.end(), p, p + size);
+	}
+
+	void CacheWriter::writeGrid(const RectangleArray<int>& grid)
+	{
+		writeInt(grid.getWidth());
+		writeInt(grid.getHeight());
+		size_t count = (size_t)grid.getWidth() * grid.getHeight();
+		if (count == 0) return;
+		if (CacheFile::isLittleEndianHost()) {
+			// data is contiguous and column-major, the first column points to the beginning
+			writeBytes(grid[0], count * sizeof(int32_t));
+		} else {
+			for (unsigned int x = 0; x < grid.getWidth(); ++x) {
+				for (unsigned int y = 0; y < grid.getHeight(); ++y) writeInt(grid[x][y]);
+			}
+		}
+	}
+
+	void CacheWriter::writeGridSection(uint32_t id, const RectangleArray<int>& grid, bool allowRle)
+	{
+		if (allowRle) {
+			RleColumnArray rle;
+			rle.encode(grid);
+			size_t rawSize = (2 + (size_t)grid.getWidth() * grid.getHeight()) * sizeof(int32_t);
+			if (rle.byteSize() < rawSize) {
+				beginSection(id, CacheFile::RLE);
+				rle.write(*this);
+				endSection();
+				return;
+			}
+		}
+		beginSection(id, CacheFile::RAW);
+		writeGrid(grid);
+		endSection();
+	}
+
+	bool CacheWriter::save(const std::string& filename, uint32_t version, uint32_t width, uint32_t height) const
+	{
+		std::vector<unsigned char> head;
+		CacheFile::appendUInt32(head, CacheFile::MAGIC);
+		CacheFile::appendUInt32(head, version);
+		CacheFile::appendUInt32(head, static_cast<uint32_t>(_sections.size()));
+		CacheFile::appendUInt32(head, width);
+		CacheFile::appendUInt32(head, height);
+
+		size_t bodyOffset = CacheFile::alignUp(CacheFile::HEADER_SIZE + _sections.size() * CacheFile::SECTION_ENTRY_SIZE);
+		for (const auto& entry : _sections) {
+			CacheFile::appendUInt32(head, entry.id);
+			CacheFile::appendUInt32(head, entry.encoding);
+			CacheFile::appendUInt32(head, static_cast<uint32_t>(bodyOffset + entry.offset));
+			CacheFile::appendUInt32(head, entry.size);
+		}
+		head.resize(bodyOffset, 0);
+
+		// write to a temporary file first, so a crash never leaves a half written cache behind
+		std::string tmpFilename = CacheFile::temporaryFilename(filename);
+		{
+			std::ofstream file_out(tmpFilename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!file_out) return false;
+			file_out.write(reinterpret_cast<const char*>(head.data()), head.size());
+			if (!_body.empty()) file_out.write(reinterpret_cast<const char*>(_body.data()), _body.size());
+			if (!file_out) {
+				file_out.close();
+				std::remove(tmpFilename.c_str());
+				return false;
+			}
+		}
+		return CacheFile::replaceFile(tmpFilename, filename);
+	}
+
+	//------------------------------------------------ CURSOR ------------------------------------------------
+
+	bool SectionCursor::require(size_t size)
+	{
+		if (!_ok || (size_t)(_end - _pos) < size) {
+			_ok = false;
+			return false;
+		}
+		return true;
+	}
+
+	int32_t SectionCursor::readInt()
+	{
+		if (!require(sizeof(int32_t))) return 0;
+		int32_t value = static_cast<int32_t>(CacheFile::readUInt32(_pos));
+		_pos += sizeof(int32_t);
+		return value;
+	}
+
+	double SectionCursor::readDouble()
+	{
+		if (!require(sizeof(uint64_t))) return 0.0;
+		uint64_t bits = uint64_t(CacheFile::readUInt32(_pos)) | (uint64_t(CacheFile::readUInt32(_pos + 4)) << 32);
+		_pos += sizeof(uint64_t);
+		double value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	int SectionCursor::readCount(size_t minBytesPerItem)
+	{
+		int count = readInt();
+		if (count < 0 || !require((size_t)count * minBytesPerItem)) {
+			_ok = false;
+			return 0;
+		}
+		return count;
+	}
+
+	void SectionCursor::skip(size_t size)
+	{
+		if (require(size)) _pos += size;
+	}
+
+	//------------------------------------------------ READER ------------------------------------------------
+
+	bool CacheReader::open(const std::string& filename, uint32_t expectedVersion)
+	{
+		close();
+		if (!_file.open(filename)) return false;
+
+		const unsigned char* data = _file.data();
+		size_t size = _file.size();
+		if (size < CacheFile::HEADER_SIZE ||
+			CacheFile::readUInt32(data) != CacheFile::MAGIC ||
+			CacheFile::readUInt32(data + 4) != expectedVersion) {
+			close();
+			return false;
+		}
+
+		uint32_t sectionCount = CacheFile::readUInt32(data + 8);
+		_width = CacheFile::readUInt32(data + 12);
+		_height = CacheFile::readUInt32(data + 16);
+		if (sectionCount > (size - CacheFile::HEADER_SIZE) / CacheFile::SECTION_ENTRY_SIZE) {
+			close();
+			return false;
+		}
+
+		const unsigned char* table = data + CacheFile::HEADER_SIZE;
+		for (uint32_t i = 0; i < sectionCount; ++i) {
+			const unsigned char* e = table + i * CacheFile::SECTION_ENTRY_SIZE;
+			CacheFile::SectionEntry entry;
+			entry.id = CacheFile::readUInt32(e);
+			entry.encoding = CacheFile::readUInt32(e + 4);
+			entry.offset = CacheFile::readUInt32(e + 8);
+			entry.size = CacheFile::readUInt32(e + 12);
+			if ((size_t)entry.offset > size || (size_t)entry.size > size - entry.offset) {
+				LOG("WARNING cache section " << entry.id << " out of bounds");
+				close();
+				return false;
+			}
+			_sections.push_back(entry);
+		}
+		return true;
+	}
+
+	void CacheReader::close()
+	{
+		_file.close();
+		_sections.clear();
+		_width = 0;
+		_height = 0;
+	}
+
+	const CacheFile::SectionEntry* CacheReader::sectionEntry(uint32_t id) const
+	{
+		for (const auto& entry : _sections) {
+			if (entry.id == id) return &entry;
+		}
+		return nullptr;
+	}
+
+	bool CacheReader::hasSection(uint32_t id) const
+	{
+		return sectionEntry(id) != nullptr;
+	}
+
+	SectionCursor CacheReader::section(uint32_t id) const
+	{
+		const CacheFile::SectionEntry* entry = sectionEntry(id);
+		if (entry == nullptr) return SectionCursor();
+		const unsigned char* begin = _file.data() + entry->offset;
+		return SectionCursor(begin, begin + entry->size);
+	}
+
+	bool CacheReader::decodeGrid(uint32_t id, RectangleArray<int>& grid) const
+	{
+		RleColumnArray rle;
+		SectionCursor cursor = section(id);
+		// the grids are at most in walk resolution, 4 walk tiles per build tile of the header size
+		if (!rle.read(cursor, _width * 4, _height * 4)) return false;
+		rle.decode(grid);
+		return true;
+	}
+
+	bool CacheReader::readCompactGrid(uint32_t id, RleColumnArray& grid)
+	{
+		const CacheFile::SectionEntry* entry = sectionEntry(id);
+		if (entry == nullptr) return false;
+		if (entry->encoding == CacheFile::RLE) {
+			SectionCursor cursor = section(id);
+			return grid.read(cursor, _width * 4, _height * 4);
+		}
+		RectangleArray<int> dense;
+		if (!attachGrid(id, dense)) return false;
+		grid.encode(dense);
+		return true;
+	}
+
+	bool CacheReader::attachGrid(uint32_t id, RectangleArray<int>& grid)
+	{
+		const CacheFile::SectionEntry* entry = sectionEntry(id);
+		if (entry != nullptr && entry->encoding == CacheFile::RLE) return decodeGrid(id, grid);
+		if (entry == nullptr || entry->encoding != CacheFile::RAW) return false;
+
+		SectionCursor cursor = section(id);
+		int width = cursor.readInt();
+		int height = cursor.readInt();
+		if (!cursor.ok() || width <= 0 || height <= 0) return false;
+		size_t count = (size_t)width * height;
+		const unsigned char* values = cursor.position();
+		cursor.skip(count * sizeof(int32_t));
+		if (!cursor.ok()) return false;
+
+		if (CacheFile::isLittleEndianHost() && reinterpret_cast<uintptr_t>(values) % sizeof(int32_t) == 0) {
+			// the view is copy-on-write, so it is safe to hand out a mutable pointer
+			int* mapped = reinterpret_cast<int*>(_file.mutableData() + (values - _file.data()));
+			grid.attach(width, height, mapped);
+		} else {
+			grid.resize(width, height);
+			for (int x = 0; x < width; ++x) {
+				for (int y = 0; y < height; ++y) {
+					grid[x][y] = static_cast<int32_t>(CacheFile::readUInt32(values));
+					values += sizeof(int32_t);
+				}
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "MappedFile.h"
+
+namespace BWTA
+{
+	/**
+	 * Binary layout of the .bwta cache file (every value is little-endian):
+	 *   header        : magic "BWTA", version, section count, map width, map height (tile resolution)
+	 *   section table : section count x { id, encoding, offset, size }
+	 *   sections      : each one starts 8-byte aligned, grids are stored as width, height and then
+	 *                   width*height int32 values in the same column-major order as RectangleArray
+	 */
+	class RleColumnArray;
+
+	namespace CacheFile
+	{
+		const uint32_t MAGIC = 0x41545742; // "BWTA"
+		const uint32_t SECTION_ALIGNMENT = 8;
+
+		enum SectionId : uint32_t {
+			POLYGONS = 1,
+			REGIONS,
+			CHOKEPOINTS,
+			BASELOCATIONS,
+			BASE_DISTANCES,
+			REGION_MAP,					// getRegion, tile resolution
+			CHOKEPOINT_MAP,				// getChokepoint, tile resolution
+			BASELOCATION_MAP,			// getBaseLocation, tile resolution
+			CHOKEPOINT_MAP_WALK,		// getChokepointW, walk resolution
+			BASELOCATION_MAP_WALK,		// getBaseLocationW, walk resolution
+			POLYGON_MAP,				// getUnwalkablePolygon, tile resolution
+			REGION_LABEL_MAP,			// regionLabelMap, walk resolution
+			OBSTACLE_LABEL_MAP,			// obstacleLabelMap, walk resolution
+			CLOSEST_OBSTACLE_LABEL_MAP,	// closestObstacleLabelMap, walk resolution
+			SKELETON,					// skeleton, nodes and CSR adjacency
+			JUMP_TABLE,					// jumpTable, int16 distances per tile and direction
+			LANDMARKS,					// landmarks, uint16 distances per landmark and tile
+			CONTRACTION_HIERARCHY,		// contractionHierarchy, CSR upward edges (only when enabled)
+			NAVMESH						// navMesh, vertices and triangle corners
+		};
+
+		enum Encoding : uint32_t {
+			RAW = 0,
+			RLE = 1		// grid stored as RleColumnArray runs
+		};
+
+		struct Header {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t sectionCount;
+			uint32_t width;
+			uint32_t height;
+		};
+
+		struct SectionEntry {
+			uint32_t id;
+			uint32_t encoding;
+			uint32_t offset;
+			uint32_t size;
+		};
+
+		const size_t HEADER_SIZE = 5 * sizeof(uint32_t);
+		const size_t SECTION_ENTRY_SIZE = 4 * sizeof(uint32_t);
+
+		inline bool isLittleEndianHost()
+		{
+			const uint16_t probe = 1;
+			return *reinterpret_cast<const unsigned char*>(&probe) == 1;
+		}
+
+		inline uint32_t readUInt32(const unsigned char* p)
+		{
+			return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+		}
+
+		// Reads only the header of a cache file; returns false if the file is missing or is not a cache file
+		bool readHeader(const std::string& filename, Header& header);
+
+		// Name of a temporary file next to filename, unique to this process and call, so two writers
+		// never write to the same temporary file
+		std::string temporaryFilename(const std::string& filename);
+		// Replaces filename by tmpFilename in one step, a reader sees the old file or the new one;
+		// tmpFilename is deleted if it fails
+		bool replaceFile(const std::string& tmpFilename, const std::string& filename);
+	}
+
+	/** Builds the sections of a cache file in memory and writes them in a single pass */
+	class CacheWriter
+	{
+	public:
+		void beginSection(uint32_t id, uint32_t encoding = CacheFile::RAW);
+		void endSection();
+
+		void writeInt(int32_t value);
+		void writeDouble(double value);
+		template<typename PointType>
+		void writePoint(const PointType& p) { writeInt(p.x); writeInt(p.y); }
+		void writeBytes(const void* bytes, size_t size);
+
+		// grid of int32 values (width, height, column-major data)
+		void writeGrid(const RectangleArray<int>& grid);
+		// grid of pointers translated to indices using ids (nullptr is stored as -1)
+		template<typename T>
+		void writeGrid(const RectangleArray<T*>& grid, const std::map<T*, int>& ids)
+		{
+			writeInt(grid.getWidth());
+			writeInt(grid.getHeight());
+			for (unsigned int x = 0; x < grid.getWidth(); ++x) {
+				for (unsigned int y = 0; y < grid.getHeight(); ++y) {
+					T* item = grid[x][y];
+					if (item == nullptr) {
+						writeInt(-1);
+					} else {
+						auto it = ids.find(item);
+						writeInt(it == ids.end() ? -1 : it->second);
+					}
+				}
+			}
+		}
+
+		/**
+		 * Writes grid as a complete section, run-length encoded when that is smaller than the raw
+		 * values (walk resolution label maps usually shrink several times)
+		 */
+		void writeGridSection(uint32_t id, const RectangleArray<int>& grid, bool allowRle = true);
+		template<typename T>
+		void writeGridSection(uint32_t id, const RectangleArray<T*>& grid, const std::map<T*, int>& ids, bool allowRle = true)
+		{
+			RectangleArray<int> indices(grid.getWidth(), grid.getHeight());
+			for (unsigned int x = 0; x < grid.getWidth(); ++x) {
+				for (unsigned int y = 0; y < grid.getHeight(); ++y) {
+					auto it = ids.find(grid[x][y]);
+					indices[x][y] = (it == ids.end()) ? -1 : it->second;
+				}
+			}
+			writeGridSection(id, indices, allowRle);
+		}
+
+		bool save(const std::string& filename, uint32_t version, uint32_t width, uint32_t height) const;
+
+	private:
+		std::vector<CacheFile::SectionEntry> _sections;
+		std::vector<unsigned char> _body;
+	};
+
+	/** Sequential reader over one section of a mapped cache file */
+	class SectionCursor
+	{
+	public:
+		SectionCursor() : _pos(nullptr), _end(nullptr), _ok(false) {}
+		SectionCursor(const unsigned char* begin, const unsigned char* end) : _pos(begin), _end(end), _ok(begin != nullptr) {}
+
+		int32_t readInt();
+		double readDouble();
+		template<typename PointType>
+		PointType readPoint() { int x = readInt(); int y = readInt(); return PointType(x, y); }
+		// reads a count and checks that at least count*minBytesPerItem bytes remain
+		int readCount(size_t minBytesPerItem = sizeof(int32_t));
+		const unsigned char* position() const { return _pos; }
+		size_t remaining() const { return _ok ? (size_t)(_end - _pos) : 0; }
+		void skip(size_t size);
+
+		bool ok() const { return _ok; }
+
+	private:
+		bool require(size_t size);
+
+		const unsigned char* _pos;
+		const unsigned char* _end;
+		bool _ok;
+	};
+
+	/** Validates and exposes the sections of a memory mapped cache file */
+	class CacheReader
+	{
+	public:
+		CacheReader() : _width(0), _height(0) {}
+
+		bool open(const std::string& filename, uint32_t expectedVersion);
+		void close();
+		bool isOpen() const { return _file.isOpen(); }
+
+		bool hasSection(uint32_t id) const;
+		SectionCursor section(uint32_t id) const;
+		const CacheFile::SectionEntry* sectionEntry(uint32_t id) const;
+
+		/**
+		 * Binds grid to the int32 data of section id. On little-endian hosts a raw grid points
+		 * directly into the (copy-on-write) mapping, otherwise the values are copied or decoded.
+		 */
+		bool attachGrid(uint32_t id, RectangleArray<int>& grid);
+		// Reads the grid of section id as runs, without building the dense array if it is RLE encoded
+		bool readCompactGrid(uint32_t id, RleColumnArray& grid);
+		// Translates the indices stored in section id to pointers using objects (-1 is nullptr)
+		template<typename T, typename Container>
+		bool readGrid(uint32_t id, RectangleArray<T*>& grid, const Container& objects) const
+		{
+			const CacheFile::SectionEntry* entry = sectionEntry(id);
+			if (entry != nullptr && entry->encoding == CacheFile::RLE) {
+				RectangleArray<int> indices;
+				if (!decodeGrid(id, indices)) return false;
+				grid.resize(indices.getWidth(), indices.getHeight());
+				for (unsigned int x = 0; x < indices.getWidth(); ++x) {
+					for (unsigned int y = 0; y < indices.getHeight(); ++y) {
+						int index = indices[x][y];
+						grid[x][y] = (index < 0 || index >= (int)objects.size()) ? nullptr : objects[index];
+					}
+				}
+				return true;
+			}
+
+			SectionCursor cursor = section(id);
+			int width = cursor.readInt();
+			int height = cursor.readInt();
+			if (!cursor.ok() || width <= 0 || height <= 0) return false;
+			grid.resize(width, height);
+			for (int x = 0; x < width; ++x) {
+				for (int y = 0; y < height; ++y) {
+					int index = cursor.readInt();
+					if (!cursor.ok()) return false;
+					if (index < 0 || index >= (int)objects.size()) {
+						grid[x][y] = nullptr;
+					} else {
+						grid[x][y] = objects[index];
+					}
+				}
+			}
+			return true;
+		}
+
+		uint32_t getWidth() const { return _width; }
+		uint32_t getHeight() const { return _height; }
+
+	private:
+		bool decodeGrid(uint32_t id, RectangleArray<int>& grid) const;
+
+		MappedFile _file;
+		std::vector<CacheFile::SectionEntry> _sections;
+		uint32_t _width;
+		uint32_t _height;
+	};
+}
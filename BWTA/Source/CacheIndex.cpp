@@ -0,0 +1,206 @@
+#include "CacheIndex.h"
+
+#include "AnalysisParameters.h"
+#include "CacheFile.h"
+#include "ContractionHierarchy.h"
+#include "Utils.h"
+#include "filesystem/path.h"
+
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <tuple>
+
+namespace BWTA
+{
+	static size_t cacheSizeLimit = 256 * 1024 * 1024;
+
+	void setCacheSizeLimit(size_t bytes)
+	{
+		cacheSizeLimit = bytes;
+	}
+
+	size_t getCacheSizeLimit()
+	{
+		return cacheSizeLimit;
+	}
+
+	//------------------------------------------------ HASH ------------------------------------------------
+
+	void Fnv1a::addBytes(const void* bytes, size_t size)
+	{
+		const unsigned char* p = static_cast<const unsigned char*>(bytes);
+		for (size_t i = 0; i < size; ++i) {
+			_hash ^= p[i];
+			_hash *= 1099511628211ULL;
+		}
+	}
+
+	void Fnv1a::add(int32_t value)
+	{
+		add(static_cast<uint64_t>(static_cast<uint32_t>(value)));
+	}
+
+	void Fnv1a::add(uint64_t value)
+	{
+		unsigned char bytes[8];
+		for (int i = 0; i < 8; ++i) bytes[i] = static_cast<unsigned char>((value >> (8 * i)) & 0xFF);
+		addBytes(bytes, sizeof(bytes));
+	}
+
+	void Fnv1a::add(double value)
+	{
+		uint64_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		add(bits);
+	}
+
+	void Fnv1a::add(const RectangleArray<bool>& grid)
+	{
+		add(static_cast<int32_t>(grid.getWidth()));
+		add(static_cast<int32_t>(grid.getHeight()));
+		// pack 8 cells per byte, column by column
+		unsigned char bits = 0;
+		int used = 0;
+		for (unsigned int x = 0; x < grid.getWidth(); ++x) {
+			for (unsigned int y = 0; y < grid.getHeight(); ++y) {
+				if (grid[x][y]) bits |= static_cast<unsigned char>(1 << used);
+				if (++used == 8) {
+					addBytes(&bits, 1);
+					bits = 0;
+					used = 0;
+				}
+			}
+		}
+		if (used > 0) addBytes(&bits, 1);
+	}
+
+	std::string computeCacheKey()
+	{
+		Fnv1a hasher;
+		hasher.add(BWTA_FILE_VERSION);
+		hasher.add(MapData::rawWalkability);
+		hasher.add(MapData::buildability);
+
+		// units are sorted, so maps that only reorder them share the key
+		std::vector<std::tuple<int, int, int, int>> units;
+		for (const auto& resource : MapData::resources) {
+			units.emplace_back(resource.type.getID(), resource.pos.x, resource.pos.y, (int)resource.amount);
+		}
+		std::sort(units.begin(), units.end());
+		hasher.add(static_cast<uint64_t>(units.size()));
+		for (const auto& unit : units) {
+			hasher.add(std::get<0>(unit));
+			hasher.add(std::get<1>(unit));
+			hasher.add(std::get<2>(unit));
+			hasher.add(std::get<3>(unit));
+		}
+
+		units.clear();
+		for (const auto& building : MapData::staticNeutralBuildings) {
+			units.emplace_back(building.first.getID(), building.second.x, building.second.y, 0);
+		}
+		std::sort(units.begin(), units.end());
+		hasher.add(static_cast<uint64_t>(units.size()));
+		for (const auto& unit : units) {
+			hasher.add(std::get<0>(unit));
+			hasher.add(std::get<1>(unit));
+			hasher.add(std::get<2>(unit));
+		}
+
+		std::vector<std::pair<int, int>> starts;
+		for (const auto& start : MapData::startLocations) starts.emplace_back(start.x, start.y);
+		std::sort(starts.begin(), starts.end());
+		hasher.add(static_cast<uint64_t>(starts.size()));
+		for (const auto& start : starts) {
+			hasher.add(start.first);
+			hasher.add(start.second);
+		}
+
+		hashAnalysisParameters(hasher);
+		// with the oracle enabled the cache file has one more section, it is a different file
+		hasher.add(isGroundDistanceOracleEnabled() ? 1 : 0);
+
+		std::ostringstream key;
+		key << std::hex << std::setw(16) << std::setfill('0') << hasher.value();
+		return key.str();
+	}
+
+	//------------------------------------------------ INDEX ------------------------------------------------
+
+	bool CacheIndex::load()
+	{
+		_entries.clear();
+		_tick = 0;
+		std::ifstream file_in((_directory + "cache.index").c_str());
+		if (!file_in) return false;
+
+		std::string label;
+		if (!(file_in >> label >> _tick) || label != "tick") {
+			_tick = 0;
+			return false;
+		}
+		std::string key;
+		Entry entry;
+		while (file_in >> key >> entry.size >> entry.lastUse) {
+			// files deleted by hand are forgotten
+			if (filesystem::path(fileName(key)).exists()) _entries[key] = entry;
+		}
+		return true;
+	}
+
+	bool CacheIndex::save() const
+	{
+		std::string filename = _directory + "cache.index";
+		std::string tmpFilename = CacheFile::temporaryFilename(filename);
+		{
+			std::ofstream file_out(tmpFilename.c_str(), std::ios::out | std::ios::trunc);
+			if (!file_out) return false;
+			file_out << "tick " << _tick << std::endl;
+			for (const auto& entry : _entries) {
+				file_out << entry.first << " " << entry.second.size << " " << entry.second.lastUse << std::endl;
+			}
+			if (!file_out) {
+				file_out.close();
+				std::remove(tmpFilename.c_str());
+				return false;
+			}
+		}
+		return CacheFile::replaceFile(tmpFilename, filename);
+	}
+
+	void CacheIndex::touch(const std::string& key)
+	{
+		filesystem::path file(fileName(key));
+		if (!file.exists()) {
+			_entries.erase(key);
+			return;
+		}
+		Entry& entry = _entries[key];
+		entry.size = file.file_size();
+		entry.lastUse = ++_tick;
+	}
+
+	void CacheIndex::evict(uint64_t maxBytes, const std::string& keep)
+	{
+		uint64_t totalSize = 0;
+		std::vector<std::pair<uint64_t, std::string>> byAge;
+		for (const auto& entry : _entries) {
+			totalSize += entry.second.size;
+			if (entry.first != keep) byAge.emplace_back(entry.second.lastUse, entry.first);
+		}
+		std::sort(byAge.begin(), byAge.end());
+
+		for (const auto& old : byAge) {
+			if (totalSize <= maxBytes) break;
+			filesystem::path file(fileName(old.second));
+			if (file.exists() && !file.remove_file()) {
+				LOG("WARNING could not delete old cache file " << file.str());
+				continue;
+			}
+			LOG("Evicted cache file " << old.second << _extension);
+			totalSize -= _entries[old.second].size;
+			_entries.erase(old.second);
+		}
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "MapData.h"
+
+namespace BWTA
+{
+	/** 64-bit FNV-1a hash, values are fed as little-endian bytes so keys match across platforms */
+	class Fnv1a
+	{
+	public:
+		Fnv1a() : _hash(14695981039346656037ULL) {}
+
+		void addBytes(const void* bytes, size_t size);
+		void add(int32_t value);
+		void add(uint64_t value);
+		void add(double value);
+		void add(const RectangleArray<bool>& grid);
+
+		uint64_t value() const { return _hash; }
+
+	private:
+		uint64_t _hash;
+	};
+
+	/**
+	 * Name of the cache file of the current map (without extension). It is a hash of the terrain
+	 * (walkability, buildability, resources, neutral buildings and start locations), the analysis
+	 * parameters, the options that add sections and the file version, so remakes that only change
+	 * text or triggers share it.
+	 */
+	std::string computeCacheKey();
+
+	// Upper bound of the total size of the cache files tracked by the index
+	size_t getCacheSizeLimit();
+
+	/**
+	 * Index of the cache files (<key><extension>) in a directory, stored as text in <directory>cache.index:
+	 *   tick <current tick>
+	 *   <key> <file size> <last use tick>
+	 * When the total size goes over the limit the least recently used files are deleted.
+	 * The index is shared by the processes: hold a ProcessLock on <directory>cache.index from load()
+	 * to save().
+	 */
+	class CacheIndex
+	{
+	public:
+		explicit CacheIndex(const std::string& directory, const std::string& extension = ".bwta")
+			: _directory(directory), _extension(extension), _tick(0) {}
+
+		bool load();
+		bool save() const;
+
+		std::string fileName(const std::string& key) const { return _directory + key + _extension; }
+		// marks key as the most recently used, drops it from the index if its file does not exist
+		void touch(const std::string& key);
+		// deletes least recently used files (never keep) until the total size is at most maxBytes
+		void evict(uint64_t maxBytes, const std::string& keep);
+
+	private:
+		struct Entry {
+			uint64_t size;
+			uint64_t lastUse;
+		};
+
+		std::string _directory;
+		std::string _extension;
+		std::map<std::string, Entry> _entries;
+		uint64_t _tick;
+	};
+}
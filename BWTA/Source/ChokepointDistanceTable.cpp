@@ -0,0 +1,199 @@
+#include "ChokepointDistanceTable.h"
+
+#include "BWTA_Result.h"
+#include "GridSearch.h"
+#include "TaskScheduler.h"
+
+namespace BWTA
+{
+	static const int UNREACHABLE = std::numeric_limits<int>::max();
+
+	void ChokepointDistanceTable::build()
+	{
+		clear();
+		const int width = MapData::mapWidthTileRes;
+		const int height = MapData::mapHeightTileRes;
+		const RectangleArray<bool>& walkable = MapData::lowResWalkability;
+
+		std::map<Chokepoint*, int> chokepointIds;
+		for (const auto& chokepoint : BWTA_Result::chokepoints) {
+			chokepointIds.insert(std::make_pair(chokepoint, (int)_chokepoints.size()));
+			_chokepoints.push_back(chokepoint);
+		}
+		std::map<Region*, int> regionIds;
+		for (const auto& region : BWTA_Result::regions) regionIds.insert(std::make_pair(region, (int)regionIds.size()));
+
+		// number the tiles of each region
+		_regions.resize(BWTA_Result::regions.size());
+		for (size_t i = 0; i < _regions.size(); ++i) {
+			for (const auto& chokepoint : BWTA_Result::regions[i]->getChokepoints()) {
+				_regions[i].chokepoints.push_back(chokepointIds[chokepoint]);
+			}
+			_regions[i].tileCount = 0;
+		}
+		_tileRegion.resize(width, height);
+		_tileLocal.resize(width, height);
+		for (int x = 0; x < width; ++x) {
+			for (int y = 0; y < height; ++y) {
+				auto it = regionIds.find(BWTA::getRegion(BWAPI::TilePosition(x, y)));
+				_tileRegion[x][y] = (it == regionIds.end()) ? -1 : it->second;
+				_tileLocal[x][y] = (it == regionIds.end()) ? -1 : _regions[it->second].tileCount++;
+			}
+		}
+		for (auto& fields : _regions) fields.distances.assign(fields.chokepoints.size() * fields.tileCount, -1);
+
+		// one Dijkstra from the center of each chokepoint fills its column in the fields of its two
+		// regions and its row of direct links
+		const int chokepointCount = (int)_chokepoints.size();
+		std::vector<int> links(chokepointCount * chokepointCount, UNREACHABLE);
+		auto isInside = [&](BWAPI::TilePosition p) { return p.x >= 0 && p.y >= 0 && p.x < width && p.y < height; };
+		auto fillFields = [&](int id) {
+			Chokepoint* chokepoint = _chokepoints[id];
+			BWAPI::TilePosition start(chokepoint->getCenter());
+			if (!isInside(start)) return;
+			GridSearchLease context;
+			NoGoal goal;
+			gridSearch<CostOnly>(*context, start, goal, ZeroHeuristic());
+
+			for (Region* region : { chokepoint->getRegions().first, chokepoint->getRegions().second }) {
+				auto regionIt = regionIds.find(region);
+				if (regionIt == regionIds.end()) continue;
+				const int regionId = regionIt->second;
+				RegionFields& fields = _regions[regionId];
+				const int slot = (int)(std::find(fields.chokepoints.begin(), fields.chokepoints.end(), id) - fields.chokepoints.begin());
+				int* distances = fields.distances.data() + slot * fields.tileCount;
+				for (int x = 0; x < width; ++x) {
+					for (int y = 0; y < height; ++y) {
+						if (_tileRegion[x][y] != regionId) continue;
+						int node = context->index(x, y);
+						if (context->isSeen(node)) {
+							distances[_tileLocal[x][y]] = context->getCost(node);
+							continue;
+						}
+						// a search starting on an unwalkable tile takes one step to a walkable neighbor
+						int best = UNREACHABLE;
+						for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, width - 1); ++nx) {
+							for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, height - 1); ++ny) {
+								if (!walkable[nx][ny] || !context->isSeen(context->index(nx, ny))) continue;
+								bool diagonal = (nx != x && ny != y);
+								if (diagonal && !walkable[x][ny] && !walkable[nx][y]) continue;
+								best = std::min(best, context->getCost(context->index(nx, ny)) + (diagonal ? 14 : 10));
+							}
+						}
+						if (best != UNREACHABLE) distances[_tileLocal[x][y]] = best;
+					}
+				}
+
+				for (int other : fields.chokepoints) {
+					if (other == id) continue;
+					BWAPI::TilePosition center(_chokepoints[other]->getCenter());
+					if (!isInside(center) || !walkable[center.x][center.y]) continue;
+					int node = context->index(center.x, center.y);
+					if (context->isSeen(node)) links[id * chokepointCount + other] = context->getCost(node);
+				}
+			}
+		};
+		TaskScheduler scheduler(getAnalysisThreadCount());
+		TaskGraph graph;
+		graph.addParallelFor([&]() { return chokepointCount; }, fillFields, 4 * scheduler.getThreadCount());
+		scheduler.run(graph);
+
+		// Floyd-Warshall over the chokepoint graph, keeping the first hop of each route
+		std::vector<int> distances(chokepointCount * chokepointCount, UNREACHABLE);
+		_nextHop.assign(chokepointCount * chokepointCount, -1);
+		for (int i = 0; i < chokepointCount; ++i) {
+			for (int j = 0; j < chokepointCount; ++j) {
+				// computed from both ends, only one of them is set when the other center is unwalkable
+				int link = std::min(links[i * chokepointCount + j], links[j * chokepointCount + i]);
+				if (i == j) link = 0;
+				if (link == UNREACHABLE) continue;
+				distances[i * chokepointCount + j] = link;
+				_nextHop[i * chokepointCount + j] = j;
+			}
+		}
+		for (int k = 0; k < chokepointCount; ++k) {
+			for (int i = 0; i < chokepointCount; ++i) {
+				const int toK = distances[i * chokepointCount + k];
+				if (toK == UNREACHABLE) continue;
+				for (int j = 0; j < chokepointCount; ++j) {
+					const int fromK = distances[k * chokepointCount + j];
+					if (fromK == UNREACHABLE || toK + fromK >= distances[i * chokepointCount + j]) continue;
+					distances[i * chokepointCount + j] = toK + fromK;
+					_nextHop[i * chokepointCount + j] = _nextHop[i * chokepointCount + k];
+				}
+			}
+		}
+		for (auto& distance : distances) {
+			if (distance == UNREACHABLE) distance = -1;
+		}
+		_distances.swap(distances);
+	}
+
+	void ChokepointDistanceTable::clear()
+	{
+		_chokepoints.clear();
+		_distances.clear();
+		_nextHop.clear();
+		_tileRegion.resize(0, 0);
+		_tileLocal.resize(0, 0);
+		_regions.clear();
+	}
+
+	int ChokepointDistanceTable::getRegionIndex(BWAPI::TilePosition tile) const
+	{
+		if (tile.x < 0 || tile.y < 0 || tile.x >= (int)_tileRegion.getWidth() || tile.y >= (int)_tileRegion.getHeight()) return -1;
+		return _tileRegion[tile.x][tile.y];
+	}
+
+	bool ChokepointDistanceTable::findRoute(BWAPI::TilePosition start, BWAPI::TilePosition target,
+		int& distance, int& entry, int& exit) const
+	{
+		const int startRegion = getRegionIndex(start);
+		const int targetRegion = getRegionIndex(target);
+		if (startRegion == -1 || targetRegion == -1) return false;
+
+		const RegionFields& from = _regions[startRegion];
+		const RegionFields& to = _regions[targetRegion];
+		const int startLocal = _tileLocal[start.x][start.y];
+		const int targetLocal = _tileLocal[target.x][target.y];
+		distance = UNREACHABLE;
+		for (size_t i = 0; i < from.chokepoints.size(); ++i) {
+			const int toEntry = from.distances[i * from.tileCount + startLocal];
+			if (toEntry == -1) continue;
+			for (size_t j = 0; j < to.chokepoints.size(); ++j) {
+				const int toTarget = to.distances[j * to.tileCount + targetLocal];
+				const int between = getChokepointDistance(from.chokepoints[i], to.chokepoints[j]);
+				if (toTarget == -1 || between == -1) continue;
+				if (toEntry + between + toTarget < distance) {
+					distance = toEntry + between + toTarget;
+					entry = from.chokepoints[i];
+					exit = to.chokepoints[j];
+				}
+			}
+		}
+		return distance != UNREACHABLE;
+	}
+
+	int ChokepointDistanceTable::getDistance(BWAPI::TilePosition start, BWAPI::TilePosition target,
+		Chokepoint** entry, Chokepoint** exit) const
+	{
+		int distance, entryId, exitId;
+		if (!findRoute(start, target, distance, entryId, exitId)) return -1;
+		if (entry != nullptr) *entry = _chokepoints[entryId];
+		if (exit != nullptr) *exit = _chokepoints[exitId];
+		return distance;
+	}
+
+	ChokePath ChokepointDistanceTable::getPath(BWAPI::TilePosition start, BWAPI::TilePosition target) const
+	{
+		ChokePath path;
+		int distance, current, exit;
+		if (!findRoute(start, target, distance, current, exit)) return path;
+		path.push_back(_chokepoints[current]);
+		while (current != exit) {
+			current = _nextHop[current * _chokepoints.size() + exit];
+			path.push_back(_chokepoints[current]);
+		}
+		return path;
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "MapData.h"
+
+namespace BWTA
+{
+	/**
+	 * Tables of the HPA* queries (getGroundDistance2, getShortestPath2), built once by buildChokeNodes():
+	 * - all-pairs distances between chokepoints over the chokepoint graph (two chokepoints are linked
+	 *   when they border the same region) and the next hop of each shortest route;
+	 * - for each region, the ground distance from each of its tiles to each of its chokepoints.
+	 * A query is then a min over the chokepoints of the start region times those of the target region,
+	 * without any grid search. Distances are in the 10/14 units of the grid search.
+	 */
+	class ChokepointDistanceTable
+	{
+	public:
+		void build();
+		void clear();
+		bool empty() const { return _regions.empty(); }
+
+		/**
+		 * Shortest distance from start to target leaving the start region through one of its
+		 * chokepoints and entering the target region through one of its chokepoints, -1 if there is
+		 * none. entry and exit (if not null) receive those chokepoints.
+		 */
+		int getDistance(BWAPI::TilePosition start, BWAPI::TilePosition target,
+			Chokepoint** entry = nullptr, Chokepoint** exit = nullptr) const;
+		// the chokepoints of that route, from entry to exit (empty if there is none)
+		ChokePath getPath(BWAPI::TilePosition start, BWAPI::TilePosition target) const;
+		// index of the region of tile in BWTA_Result::regions, -1 if none
+		int getRegionIndex(BWAPI::TilePosition tile) const;
+
+	private:
+		struct RegionFields {
+			std::vector<int> chokepoints;	// ids of the chokepoints of the region
+			int tileCount;
+			std::vector<int> distances;		// [slot * tileCount + local tile index], -1 if unreachable
+		};
+
+		int getChokepointDistance(int from, int to) const { return _distances[from * _chokepoints.size() + to]; }
+		bool findRoute(BWAPI::TilePosition start, BWAPI::TilePosition target, int& distance, int& entry, int& exit) const;
+
+		std::vector<Chokepoint*> _chokepoints;
+		std::vector<int> _distances;	// all pairs, -1 if not connected
+		std::vector<int> _nextHop;		// chokepoint after from on the way to to
+		RectangleArray<int> _tileRegion;	// region index, -1 if none
+		RectangleArray<int> _tileLocal;		// index of the tile inside its region
+		std::vector<RegionFields> _regions;
+	};
+}
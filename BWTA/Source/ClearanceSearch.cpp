@@ -0,0 +1,53 @@
+#include "ClearanceSearch.h"
+
+#include "DistanceTransform.h"
+
+namespace BWTA
+{
+	int clearanceSearch(BWAPI::WalkPosition start, BWAPI::WalkPosition target, int clearance,
+		std::vector<BWAPI::WalkPosition>* path)
+	{
+		requireDistanceTransform();
+		const int width = MapData::mapWidthWalkRes;
+		const int height = MapData::mapHeightWalkRes;
+		if (start.x < 0 || start.y < 0 || start.x >= width || start.y >= height) return -1;
+		if (target.x < 0 || target.y < 0 || target.x >= width || target.y >= height) return -1;
+		if (MapData::distanceTransform[target.x][target.y] < clearance) return -1;
+
+		// tile resolution pre-pass: every walk path maps to a path over the tiles of TileClearanceGrid,
+		// so no path there means no path at all
+		const BWAPI::TilePosition startTile(start.x / 4, start.y / 4);
+		const BWAPI::TilePosition targetTile(target.x / 4, target.y / 4);
+		const int tileWidth = MapData::mapWidthTileRes;
+		const int tileHeight = MapData::mapHeightTileRes;
+		std::vector<char> corridor(tileWidth * tileHeight, 0);
+		{
+			GridSearchLease context;
+			SingleGoal goal(targetTile);
+			int node = gridSearch<RecordPath>(*context, TileClearanceGrid(clearance), startTile, goal, OctileHeuristic(targetTile));
+			if (node == -1) return -1;
+			for (const auto& tile : context->getPath(node)) {
+				for (int x = std::max(tile.x - 1, 0); x <= std::min(tile.x + 1, tileWidth - 1); ++x) {
+					for (int y = std::max(tile.y - 1, 0); y <= std::min(tile.y + 1, tileHeight - 1); ++y) {
+						corridor[x * tileHeight + y] = 1;
+					}
+				}
+			}
+		}
+
+		const BWAPI::TilePosition walkStart(start.x, start.y);
+		const BWAPI::TilePosition walkTarget(target.x, target.y);
+		GridSearchLease context;
+		SingleGoal goal(walkTarget);
+		OctileHeuristic heuristic(walkTarget);
+		int node = gridSearch<RecordPath>(*context, ClearanceGrid(clearance, &corridor), walkStart, goal, heuristic);
+		if (node == -1) node = gridSearch<RecordPath>(*context, ClearanceGrid(clearance, nullptr), walkStart, goal, heuristic);
+		if (node == -1) return -1;
+
+		if (path != nullptr) {
+			path->clear();
+			for (const auto& p : context->getPath(node)) path->push_back(BWAPI::WalkPosition(p.x, p.y));
+		}
+		return context->getCost(node);
+	}
+}
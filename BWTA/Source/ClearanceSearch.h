@@ -0,0 +1,67 @@
+#pragma once
+
+#include "GridSearch.h"
+
+namespace BWTA
+{
+	/**
+	 * Walk resolution pathfinding for a given unit size. lowResWalkability only keeps the tiles whose
+	 * 16 walk tiles are all walkable, too strict for small units and too loose for big ones. Here a
+	 * walk tile can be crossed if its distance transform (distance in walk tiles to the closest
+	 * unwalkable one) is at least the clearance of the unit.
+	 * A tile resolution search over MapData::tileClearance first picks a corridor (the tiles of its
+	 * path and their neighbors) and the walk resolution A* only expands the walk tiles inside it, so
+	 * the path can be slightly longer than the shortest one. If the corridor turns out to be a dead
+	 * end the walk resolution search runs again on the whole map.
+	 */
+
+	// smallest distance transform value that fits a unit whose largest dimension is unitSize pixels:
+	// a value of d leaves a free square of 2d-1 walk tiles (8 pixels each) around the walk tile
+	inline int getRequiredClearance(int unitSize)
+	{
+		return std::max(1, (unitSize + 8 + 15) / 16);
+	}
+
+	// walk tiles with enough clearance, optionally restricted to the tiles set in corridor
+	class ClearanceGrid
+	{
+	public:
+		ClearanceGrid(int clearance, const std::vector<char>* corridor)
+			: _clearance(clearance), _corridor(corridor), _tileHeight(MapData::mapHeightTileRes) {}
+
+		int getWidth() const { return MapData::mapWidthWalkRes; }
+		int getHeight() const { return MapData::mapHeightWalkRes; }
+		bool isWalkable(int x, int y) const
+		{
+			if (MapData::distanceTransform[x][y] < _clearance) return false;
+			return _corridor == nullptr || (*_corridor)[(x / 4) * _tileHeight + y / 4] != 0;
+		}
+
+	private:
+		int _clearance;
+		const std::vector<char>* _corridor;
+		int _tileHeight;
+	};
+
+	// tiles holding at least one walk tile with enough clearance
+	class TileClearanceGrid
+	{
+	public:
+		explicit TileClearanceGrid(int clearance) : _clearance(clearance) {}
+
+		int getWidth() const { return MapData::mapWidthTileRes; }
+		int getHeight() const { return MapData::mapHeightTileRes; }
+		bool isWalkable(int x, int y) const { return MapData::tileClearance[x][y] >= _clearance; }
+
+	private:
+		int _clearance;
+	};
+
+	/**
+	 * Cost (10 per straight walk tile, 14 per diagonal one) of a path from start to target for a unit
+	 * needing clearance, -1 if there is none (the target itself must have enough clearance, the start
+	 * does not). The path is stored in path if not null. Computes the distance transform on first use.
+	 */
+	int clearanceSearch(BWAPI::WalkPosition start, BWAPI::WalkPosition target, int clearance,
+		std::vector<BWAPI::WalkPosition>* path);
+}
@@ -50,13 +50,11 @@ namespace BWTA
 		}
 	}
 
-	void computeAllClosestObjectMaps()
+	void computeClosestObstacleLabelMap()
 	{
 		Timer timer;
 		timer.start();
 
-		// compute closest unwalkable polygon map
-		// ===========================================================================
 		BWTA_Result::closestObstacleLabelMap.resize(MapData::mapWidthWalkRes, MapData::mapHeightWalkRes);
 		std::queue<labelDistance_t> seedLabels;
 		for (const auto& pol : BWTA_Result::unwalkablePolygons) {
@@ -67,10 +65,12 @@ namespace BWTA
 //		BWTA_Result::closestObstacleLabelMap.saveToFile(std::string(BWTA_PATH)+"closestObstacleMap.txt");
 		
 		LOG(" - Closest UnwalkablePolygonMap computed in " << timer.stopAndGetTime() << " seconds");
+	}
+
+	void computeClosestBaseLocationMap()
+	{
+		Timer timer;
 		timer.start();
-		
-		// compute closest BaseLocation map
-		// ===========================================================================
 
 		std::queue<baseDistance_t> seedPositions;
 		for (const auto& baseLocation : BWTA_Result::baselocations) {
@@ -81,10 +81,12 @@ namespace BWTA
 		walkResMapToTileResMap(BWTA_Result::getBaseLocationW, BWTA_Result::getBaseLocation);
 
 		LOG(" - Closest BaseLocation Map computed in " << timer.stopAndGetTime() << " seconds");
-		timer.start();
+	}
 
-		// compute closest Chokepoint map
-		// ===========================================================================
+	void computeClosestChokepointMap()
+	{
+		Timer timer;
+		timer.start();
 
 		std::queue<chokeDistance_t> seedPositions2;
 		for (const auto& chokepoint : BWTA_Result::chokepoints) {
@@ -19,5 +19,8 @@ namespace BWTA
 	using chokeDistance_t = objectDistance_t<Chokepoint*> ;
 	using labelDistance_t = objectDistance_t<int> ;
 
-	void computeAllClosestObjectMaps();
+	// independent of each other, they can run in parallel
+	void computeClosestObstacleLabelMap(); // only needs the polygons
+	void computeClosestBaseLocationMap();
+	void computeClosestChokepointMap();
 }
\ No newline at end of file
@@ -0,0 +1,297 @@
+#include "ContractionHierarchy.h"
+
+namespace BWTA
+{
+	static bool groundDistanceOracle = false;
+
+	void setGroundDistanceOracle(bool enabled)
+	{
+		groundDistanceOracle = enabled;
+	}
+
+	bool isGroundDistanceOracleEnabled()
+	{
+		return groundDistanceOracle;
+	}
+
+	namespace
+	{
+		// a witness search gives up after settling this many tiles, the shortcut is then added even if
+		// it was not needed (the distances stay exact, the hierarchy is only a bit larger)
+		const int WITNESS_SETTLE_LIMIT = 256;
+
+		struct Arc {
+			int node;
+			int cost;
+			Arc(int n, int c) : node(n), cost(c) {}
+		};
+
+		struct Shortcut {
+			int from;
+			int to;
+			int cost;
+			Shortcut(int f, int t, int c) : from(f), to(t), cost(c) {}
+		};
+
+		class Contractor
+		{
+		public:
+			Contractor(const RectangleArray<bool>& walkable)
+				: _width((int)walkable.getWidth()), _height((int)walkable.getHeight()),
+				_graph(static_cast<size_t>(_width) * _height), _contractedNeighbors(_graph.size(), 0)
+			{
+				for (int x = 0; x < _width; ++x) {
+					for (int y = 0; y < _height; ++y) {
+						if (!walkable[x][y]) continue;
+						const int node = x * _height + y;
+						for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, _width - 1); ++nx) {
+							for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, _height - 1); ++ny) {
+								if ((nx == x && ny == y) || !walkable[nx][ny]) continue;
+								const bool diagonal = (nx != x && ny != y);
+								if (diagonal && !walkable[x][ny] && !walkable[nx][y]) continue;
+								_graph[node].push_back(Arc(nx * _height + ny, diagonal ? 14 : 10));
+							}
+						}
+					}
+				}
+			}
+
+			int size() const { return (int)_graph.size(); }
+
+			// also keeps the shortcuts of node for contract()
+			int priority(int node)
+			{
+				_shortcuts.clear();
+				findShortcuts(node, _shortcuts);
+				// edge difference, and spread the contraction over the map
+				return 2 * ((int)_shortcuts.size() - (int)_graph[node].size()) + _contractedNeighbors[node];
+			}
+
+			// removes node from the graph, its arcs become its upward edges (priority(node) must have
+			// been the last call)
+			void contract(int node, std::vector<Arc>& upward)
+			{
+				upward.swap(_graph[node]);
+				for (const auto& arc : upward) {
+					std::vector<Arc>& arcs = _graph[arc.node];
+					for (size_t i = 0; i < arcs.size(); ++i) {
+						if (arcs[i].node != node) continue;
+						arcs[i] = arcs.back();
+						arcs.pop_back();
+						break;
+					}
+					++_contractedNeighbors[arc.node];
+				}
+				for (const auto& shortcut : _shortcuts) {
+					addArc(shortcut.from, shortcut.to, shortcut.cost);
+					addArc(shortcut.to, shortcut.from, shortcut.cost);
+				}
+			}
+
+		private:
+			// shortcuts needed between the neighbors of node if it is contracted
+			void findShortcuts(int node, std::vector<Shortcut>& shortcuts)
+			{
+				const std::vector<Arc>& arcs = _graph[node];
+				for (size_t i = 0; i + 1 < arcs.size(); ++i) {
+					// witnesses toward the neighbors after i, the pairs before were done from the other end
+					const Arc& from = arcs[i];
+					_witness.begin(_width, _height);
+					int maxCost = 0;
+					for (size_t j = i + 1; j < arcs.size(); ++j) {
+						maxCost = std::max(maxCost, from.cost + arcs[j].cost);
+						_witness.mark(arcs[j].node);
+					}
+					witnessSearch(from.node, node, maxCost, (int)(arcs.size() - i - 1));
+					for (size_t j = i + 1; j < arcs.size(); ++j) {
+						const Arc& to = arcs[j];
+						const int via = from.cost + to.cost;
+						if (_witness.isSeen(to.node) && _witness.getCost(to.node) <= via) continue;
+						shortcuts.push_back(Shortcut(from.node, to.node, via));
+					}
+				}
+			}
+
+			// Dijkstra from start without going through excluded, up to maxCost or until the marked
+			// targets are settled (the context is begun by the caller)
+			void witnessSearch(int start, int excluded, int maxCost, int targets)
+			{
+				IndexedHeap4& open = _witness.open();
+				_witness.setCost(start, 0);
+				open.push(start, 0);
+				int settled = 0;
+				while (!open.empty() && open.topKey() <= maxCost && settled < WITNESS_SETTLE_LIMIT) {
+					const int current = open.topNode();
+					const int cost = open.topKey();
+					open.pop();
+					_witness.close(current);
+					++settled;
+					if (_witness.isMarked(current) && --targets == 0) return;
+					for (const auto& arc : _graph[current]) {
+						if (arc.node == excluded || _witness.isClosed(arc.node)) continue;
+						const int g = cost + arc.cost;
+						if (g > maxCost) continue;
+						if (!_witness.isSeen(arc.node)) {
+							_witness.setCost(arc.node, g);
+							open.push(arc.node, g);
+						} else if (g < _witness.getCost(arc.node)) {
+							_witness.setCost(arc.node, g);
+							open.decreaseKey(arc.node, g);
+						}
+					}
+				}
+			}
+
+			void addArc(int from, int to, int cost)
+			{
+				for (auto& arc : _graph[from]) {
+					if (arc.node != to) continue;
+					arc.cost = std::min(arc.cost, cost);
+					return;
+				}
+				_graph[from].push_back(Arc(to, cost));
+			}
+
+			int _width;
+			int _height;
+			std::vector<std::vector<Arc>> _graph; // arcs between the nodes not contracted yet
+			std::vector<int> _contractedNeighbors;
+			std::vector<Shortcut> _shortcuts;
+			GridSearchContext _witness;
+		};
+	}
+
+	void ContractionHierarchy::build(const RectangleArray<bool>& walkable)
+	{
+		Contractor contractor(walkable);
+		_width = (int)walkable.getWidth();
+		_height = (int)walkable.getHeight();
+		const int size = contractor.size();
+
+		IndexedHeap4 queue;
+		queue.resize(size);
+		for (int node = 0; node < size; ++node) {
+			if (walkable[node / _height][node % _height]) queue.push(node, contractor.priority(node));
+		}
+
+		// lazy updates: the priority of the top node is computed again and, if it went up since it
+		// was queued, the node goes back in the queue (updating the neighbors of each contracted
+		// node as well doubles the build time for the same hierarchy size on our maps)
+		std::vector<std::vector<Arc>> upward(size);
+		while (!queue.empty()) {
+			const int node = queue.topNode();
+			const int priority = contractor.priority(node);
+			queue.pop();
+			if (!queue.empty() && priority > queue.topKey()) {
+				queue.push(node, priority);
+				continue;
+			}
+			contractor.contract(node, upward[node]);
+		}
+
+		_firstEdge.assign(size + 1, 0);
+		_edgeTarget.clear();
+		_edgeCost.clear();
+		for (int node = 0; node < size; ++node) {
+			_firstEdge[node] = (int)_edgeTarget.size();
+			for (const auto& arc : upward[node]) {
+				_edgeTarget.push_back(arc.node);
+				_edgeCost.push_back(arc.cost);
+			}
+		}
+		_firstEdge[size] = (int)_edgeTarget.size();
+	}
+
+	void ContractionHierarchy::assign(int width, int height, std::vector<int>& firstEdge, std::vector<int>& edgeTarget, std::vector<int>& edgeCost)
+	{
+		_width = width;
+		_height = height;
+		_firstEdge.swap(firstEdge);
+		_edgeTarget.swap(edgeTarget);
+		_edgeCost.swap(edgeCost);
+	}
+
+	void ContractionHierarchy::clear()
+	{
+		_width = 0;
+		_height = 0;
+		_firstEdge.clear();
+		_edgeTarget.clear();
+		_edgeCost.clear();
+	}
+
+	void ContractionHierarchy::settle(GridSearchContext& side, int node) const
+	{
+		const int cost = side.getCost(node);
+		// stall on demand: a node reached shorter through a higher one is not on a shortest up-down path
+		for (int edge = _firstEdge[node]; edge < _firstEdge[node + 1]; ++edge) {
+			const int next = _edgeTarget[edge];
+			if (side.isSeen(next) && side.getCost(next) + _edgeCost[edge] < cost) return;
+		}
+		IndexedHeap4& open = side.open();
+		for (int edge = _firstEdge[node]; edge < _firstEdge[node + 1]; ++edge) {
+			const int next = _edgeTarget[edge];
+			const int g = cost + _edgeCost[edge];
+			if (!side.isSeen(next)) {
+				side.setCost(next, g);
+				open.push(next, g);
+			} else if (g < side.getCost(next) && !side.isClosed(next)) {
+				side.setCost(next, g);
+				open.decreaseKey(next, g);
+			}
+		}
+	}
+
+	int ContractionHierarchy::getDistance(ContractionHierarchyQuery& query, const RectangleArray<bool>& walkable, BWAPI::TilePosition start, BWAPI::TilePosition end) const
+	{
+		if (empty()) return -1;
+		if (start.x < 0 || start.y < 0 || start.x >= _width || start.y >= _height) return -1;
+		if (end.x < 0 || end.y < 0 || end.x >= _width || end.y >= _height) return -1;
+		if (start == end) return 0;
+		if (!walkable[end.x][end.y]) return -1;
+
+		GridSearchContext& forward = query.forward;
+		GridSearchContext& backward = query.backward;
+		forward.begin(_width, _height);
+		backward.begin(_width, _height);
+
+		if (walkable[start.x][start.y]) {
+			const int node = forward.index(start.x, start.y);
+			forward.setCost(node, 0);
+			forward.open().push(node, 0);
+		} else {
+			// the first step of gridSearch out of an unwalkable tile
+			for (int x = std::max(start.x - 1, 0); x <= std::min(start.x + 1, _width - 1); ++x) {
+				for (int y = std::max(start.y - 1, 0); y <= std::min(start.y + 1, _height - 1); ++y) {
+					if (!walkable[x][y]) continue;
+					const bool diagonal = (x != start.x && y != start.y);
+					if (diagonal && !walkable[start.x][y] && !walkable[x][start.y]) continue;
+					const int node = forward.index(x, y);
+					forward.setCost(node, diagonal ? 14 : 10);
+					forward.open().push(node, diagonal ? 14 : 10);
+				}
+			}
+		}
+		const int endNode = backward.index(end.x, end.y);
+		backward.setCost(endNode, 0);
+		backward.open().push(endNode, 0);
+
+		// both searches only go up, the shortest path is the best sum at a node seen by both; a side
+		// stops once its smallest cost reaches the best sum
+		int best = std::numeric_limits<int>::max();
+		while (true) {
+			const int forwardKey = forward.open().empty() ? std::numeric_limits<int>::max() : forward.open().topKey();
+			const int backwardKey = backward.open().empty() ? std::numeric_limits<int>::max() : backward.open().topKey();
+			if (std::min(forwardKey, backwardKey) >= best) break;
+
+			GridSearchContext& side = (forwardKey <= backwardKey) ? forward : backward;
+			const GridSearchContext& other = (forwardKey <= backwardKey) ? backward : forward;
+			const int node = side.open().topNode();
+			side.open().pop();
+			side.close(node);
+			if (other.isSeen(node)) best = std::min(best, side.getCost(node) + other.getCost(node));
+			settle(side, node);
+		}
+		return (best == std::numeric_limits<int>::max()) ? -1 : best;
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "GridSearch.h"
+
+namespace BWTA
+{
+	// build the hierarchy during the analysis (see setGroundDistanceOracle), part of the cache key
+	bool isGroundDistanceOracleEnabled();
+
+	// scratch memory of the ContractionHierarchy queries, one per thread
+	struct ContractionHierarchyQuery {
+		GridSearchContext forward;
+		GridSearchContext backward;
+	};
+
+	/**
+	 * Contraction hierarchy of the tile graph of gridSearch (8-connected, 10/14 costs, same corner
+	 * rule). The walkable tiles are contracted one by one, least important first (edge difference),
+	 * adding a shortcut between two neighbors of the contracted tile when no other path of the same
+	 * cost exists. Only the edges toward tiles contracted later ("upward") are kept, so an exact
+	 * distance is found by two small Dijkstra searches that only go up, one from each end.
+	 * Built by the analysis and stored in the cache file. It does not know about blocked tiles.
+	 */
+	class ContractionHierarchy
+	{
+	public:
+		ContractionHierarchy() : _width(0), _height(0) {}
+
+		void build(const RectangleArray<bool>& walkable);
+		// CSR upward graph: the edges of node are [firstEdge[node], firstEdge[node + 1])
+		void assign(int width, int height, std::vector<int>& firstEdge, std::vector<int>& edgeTarget, std::vector<int>& edgeCost);
+		void clear();
+
+		bool empty() const { return _firstEdge.empty(); }
+		int getWidth() const { return _width; }
+		int getHeight() const { return _height; }
+		const std::vector<int>& getFirstEdge() const { return _firstEdge; }
+		const std::vector<int>& getEdgeTarget() const { return _edgeTarget; }
+		const std::vector<int>& getEdgeCost() const { return _edgeCost; }
+
+		// cost (10/14 units) from start to end, -1 if unreachable; same as gridSearch on walkable,
+		// start can be unwalkable (its walkable neighbors are the first step)
+		int getDistance(ContractionHierarchyQuery& query, const RectangleArray<bool>& walkable, BWAPI::TilePosition start, BWAPI::TilePosition end) const;
+
+	private:
+		// relaxes the upward edges of a node just popped, unless it is stalled (reached shorter from above)
+		void settle(GridSearchContext& side, int node) const;
+
+		int _width;
+		int _height;
+		std::vector<int> _firstEdge;
+		std::vector<int> _edgeTarget;
+		std::vector<int> _edgeCost;
+	};
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "MapData.h"
+
+namespace BWTA
+{
+	// steps of getGroundDistanceMap, in pixels
+	const int DIAL_STRAIGHT_COST = 32;
+	const int DIAL_DIAGONAL_COST = 45;
+	// a node is at most DIAL_DIAGONAL_COST ahead of the bucket being scanned, so that many buckets
+	// plus one never wrap onto a live one
+	const int DIAL_BUCKET_COUNT = DIAL_DIAGONAL_COST + 1;
+
+	/**
+	 * Single source ground distances over MapData::lowResWalkability with Dial's algorithm: the step
+	 * costs are small integers, so the open list is a ring of buckets indexed by distance instead of
+	 * a heap and each node is settled in O(1). The distances are written straight into distances
+	 * (resized to the map), which also serves as the distance array of the search: tiles that are
+	 * not reached, or only farther than maxDistance, keep unreached. The start tile is 0 even if it
+	 * is unwalkable; a diagonal step only needs the tile it lands on.
+	 */
+	template <class Type>
+	void dialSearch(BWAPI::TilePosition start, RectangleArray<Type>& distances, Type unreached, int maxDistance)
+	{
+		const RectangleArray<bool>& walkable = MapData::lowResWalkability;
+		const int width = MapData::mapWidthTileRes;
+		const int height = MapData::mapHeightTileRes;
+		distances.resize(width, height);
+		distances.setTo(unreached);
+		if (start.x < 0 || start.y < 0 || start.x >= width || start.y >= height) return;
+
+		std::vector<int> buckets[DIAL_BUCKET_COUNT];
+		distances[start.x][start.y] = 0;
+		buckets[0].push_back(start.x * height + start.y);
+		size_t pending = 1; // nodes in the buckets, stale ones included
+
+		for (int distance = 0; pending > 0; ++distance) {
+			std::vector<int>& bucket = buckets[distance % DIAL_BUCKET_COUNT];
+			// the steps are shorter than the ring, nothing is pushed to this bucket while it is scanned
+			for (size_t i = 0; i < bucket.size(); ++i) {
+				--pending;
+				const int x = bucket[i] / height;
+				const int y = bucket[i] % height;
+				if (distances[x][y] != (Type)distance) continue; // improved after it was pushed
+
+				const int minX = std::max(x - 1, 0);
+				const int maxX = std::min(x + 1, width - 1);
+				const int minY = std::max(y - 1, 0);
+				const int maxY = std::min(y + 1, height - 1);
+				for (int nx = minX; nx <= maxX; ++nx) {
+					for (int ny = minY; ny <= maxY; ++ny) {
+						if (!walkable[nx][ny]) continue;
+						const int next = distance + ((nx != x && ny != y) ? DIAL_DIAGONAL_COST : DIAL_STRAIGHT_COST);
+						if (next > maxDistance) continue;
+						Type& current = distances[nx][ny];
+						if (current != unreached && current <= (Type)next) continue;
+						current = (Type)next;
+						buckets[next % DIAL_BUCKET_COUNT].push_back(nx * height + ny);
+						++pending;
+					}
+				}
+			}
+			bucket.clear();
+		}
+	}
+}
@@ -12,6 +12,8 @@
 namespace BWTA
 {
 	void	computeDistanceTransform();
+	// computes the distance transform once per map (loadMap() only sets the placeholders), thread safe
+	void	requireDistanceTransform();
 
 	void	distanceTransform();
 	int		getMaxTransformDistance(int x, int y);
@@ -0,0 +1,50 @@
+#include <BWTA/DynamicPath.h>
+
+#include "LpaSearch.h"
+
+namespace BWTA
+{
+	DynamicPath::DynamicPath(BWAPI::TilePosition start, BWAPI::TilePosition end)
+		: _search(new LpaSearch(start, end)), _start(start), _end(end)
+	{
+	}
+
+	DynamicPath::~DynamicPath()
+	{
+		delete _search;
+	}
+
+	std::vector<BWAPI::TilePosition> DynamicPath::getPath()
+	{
+		return _search->getPath(_end);
+	}
+
+	double DynamicPath::getDistance()
+	{
+		int cost = _search->getCost(_end);
+		if (cost == -1) return -1;
+		return cost * 32.0 / 10.0;
+	}
+
+	DynamicDistanceMap::DynamicDistanceMap(BWAPI::TilePosition start)
+		: _search(new LpaSearch(start, BWAPI::TilePositions::None)), _start(start)
+	{
+	}
+
+	DynamicDistanceMap::~DynamicDistanceMap()
+	{
+		delete _search;
+	}
+
+	double DynamicDistanceMap::getDistance(BWAPI::TilePosition tile)
+	{
+		int cost = _search->getCost(tile);
+		if (cost == -1) return -1;
+		return cost * 32.0 / 10.0;
+	}
+
+	std::vector<BWAPI::TilePosition> DynamicDistanceMap::getPath(BWAPI::TilePosition tile)
+	{
+		return _search->getPath(tile);
+	}
+}
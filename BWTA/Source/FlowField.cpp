@@ -0,0 +1,54 @@
+#include <BWTA/FlowField.h>
+#include <BWTA.h>
+
+#include "FlowFieldCache.h"
+#include "JumpPointSearch.h"
+
+namespace BWTA
+{
+	FlowField getFlowField(BWAPI::TilePosition target)
+	{
+		return getFlowFieldCache().get(target);
+	}
+
+	void setFlowFieldCacheSize(size_t fields)
+	{
+		getFlowFieldCache().setCapacity(fields);
+	}
+
+	BWAPI::TilePosition FlowField::getTarget() const
+	{
+		if (!_data) return BWAPI::TilePositions::None;
+		return _data->target;
+	}
+
+	BWAPI::TilePosition FlowField::getNextTile(BWAPI::TilePosition tile) const
+	{
+		if (!_data || tile.x < 0 || tile.y < 0 || tile.x >= _data->width || tile.y >= _data->height) return BWAPI::TilePositions::None;
+		const uint8_t step = _data->steps[tile.x * _data->height + tile.y];
+		if (step == FlowFieldData::UNREACHABLE) return BWAPI::TilePositions::None;
+		if (step == FlowFieldData::TARGET) return tile;
+		return BWAPI::TilePosition(tile.x + JUMP_DX[step], tile.y + JUMP_DY[step]);
+	}
+
+	double FlowField::getDistance(BWAPI::TilePosition tile) const
+	{
+		if (!_data || tile.x < 0 || tile.y < 0 || tile.x >= _data->width || tile.y >= _data->height) return -1;
+		const int cost = _data->costs[tile.x * _data->height + tile.y];
+		if (cost == -1) return -1;
+		return cost * 32.0 / 10.0;
+	}
+
+	std::vector<BWAPI::TilePosition> FlowField::getPath(BWAPI::TilePosition tile) const
+	{
+		std::vector<BWAPI::TilePosition> path;
+		if (getNextTile(tile) == BWAPI::TilePositions::None) return path;
+		path.push_back(tile);
+		while (true) {
+			BWAPI::TilePosition next = getNextTile(path.back());
+			if (next == path.back()) break;
+			path.push_back(next);
+		}
+		return path;
+	}
+}
@@ -0,0 +1,141 @@
+#include "FlowFieldCache.h"
+
+#include "GridSearch.h"
+#include "JumpPointSearch.h"
+
+namespace BWTA
+{
+	const uint8_t FlowFieldData::TARGET;
+	const uint8_t FlowFieldData::UNREACHABLE;
+
+	std::shared_ptr<FlowFieldData> buildFlowField(BWAPI::TilePosition target)
+	{
+		const RectangleArray<bool>& walkable = MapData::lowResWalkability;
+		std::shared_ptr<FlowFieldData> field = std::make_shared<FlowFieldData>();
+		field->width = (int)walkable.getWidth();
+		field->height = (int)walkable.getHeight();
+		field->target = target;
+		const int size = field->width * field->height;
+		field->steps.assign(size, FlowFieldData::UNREACHABLE);
+		field->costs.assign(size, -1);
+
+		if (target.x < 0 || target.y < 0 || target.x >= field->width || target.y >= field->height) return field;
+
+		// the moves are symmetric, so the parent of a tile in a search out of the target is its next
+		// tile on a shortest path toward it
+		GridSearchLease context;
+		NoGoal goal;
+		gridSearch<RecordPath>(*context, target, goal, ZeroHeuristic());
+		for (int node = 0; node < size; ++node) {
+			if (!context->isSeen(node)) continue;
+			field->costs[node] = context->getCost(node);
+			const int parent = context->getParent(node);
+			if (parent == node) {
+				field->steps[node] = FlowFieldData::TARGET;
+			} else {
+				field->steps[node] = static_cast<uint8_t>(jumpDirection(parent / field->height - node / field->height,
+					parent % field->height - node % field->height));
+			}
+		}
+
+		// the other unwalkable tiles take the first step of a search out of them
+		for (int x = 0; x < field->width; ++x) {
+			for (int y = 0; y < field->height; ++y) {
+				const int node = x * field->height + y;
+				if (walkable[x][y] || context->isSeen(node)) continue;
+				int best = -1;
+				for (int direction = 0; direction < JUMP_DIRECTION_COUNT; ++direction) {
+					const int nx = x + JUMP_DX[direction];
+					const int ny = y + JUMP_DY[direction];
+					if (nx < 0 || ny < 0 || nx >= field->width || ny >= field->height || !walkable[nx][ny]) continue;
+					const bool diagonal = (nx != x && ny != y);
+					if (diagonal && !walkable[x][ny] && !walkable[nx][y]) continue;
+					const int next = nx * field->height + ny;
+					if (field->costs[next] == -1) continue;
+					const int cost = field->costs[next] + (diagonal ? 14 : 10);
+					if (best == -1 || cost < best) {
+						best = cost;
+						field->steps[node] = static_cast<uint8_t>(direction);
+					}
+				}
+				field->costs[node] = best;
+			}
+		}
+		return field;
+	}
+
+	FlowFieldCache& getFlowFieldCache()
+	{
+		static FlowFieldCache cache;
+		return cache;
+	}
+
+	FlowFieldCache::FlowFieldCache()
+		: _capacity(16), _tick(0), _generation(0)
+	{
+		getObstacleOverlay().addListener(this);
+	}
+
+	FlowFieldCache::~FlowFieldCache()
+	{
+		getObstacleOverlay().removeListener(this);
+	}
+
+	FlowField FlowFieldCache::get(BWAPI::TilePosition target)
+	{
+		uint64_t generation;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			for (auto& entry : _entries) {
+				if (entry.target != target) continue;
+				entry.lastUse = ++_tick;
+				return FlowField(entry.data);
+			}
+			generation = _generation;
+		}
+
+		// computed without the lock, two threads asking for the same target at once both compute it
+		std::shared_ptr<const FlowFieldData> data = buildFlowField(target);
+		std::lock_guard<std::mutex> lock(_mutex);
+		// not kept if the tiles changed in the meantime
+		if (generation == _generation && _capacity > 0) {
+			Entry entry;
+			entry.target = target;
+			entry.lastUse = ++_tick;
+			entry.data = data;
+			_entries.push_back(entry);
+			evict();
+		}
+		return FlowField(data);
+	}
+
+	void FlowFieldCache::setCapacity(size_t fields)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_capacity = fields;
+		evict();
+	}
+
+	void FlowFieldCache::clear()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_entries.clear();
+		++_generation;
+	}
+
+	void FlowFieldCache::onTilesChanged(const std::vector<BWAPI::TilePosition>&)
+	{
+		clear();
+	}
+
+	void FlowFieldCache::evict()
+	{
+		while (_entries.size() > _capacity) {
+			auto oldest = _entries.begin();
+			for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+				if (it->lastUse < oldest->lastUse) oldest = it;
+			}
+			_entries.erase(oldest);
+		}
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <BWTA/FlowField.h>
+
+#include "ObstacleOverlay.h"
+
+#include <mutex>
+
+namespace BWTA
+{
+	struct FlowFieldData
+	{
+		static const uint8_t TARGET = 8;		// step of the target tile
+		static const uint8_t UNREACHABLE = 0xFF;
+
+		int width;
+		int height;
+		BWAPI::TilePosition target;
+		std::vector<uint8_t> steps;	// JumpDirection of the next tile, indexed like GridSearchContext::index
+		std::vector<int> costs;		// 10/14 units to the target
+	};
+
+	// one Dijkstra from target over MapData::lowResWalkability
+	std::shared_ptr<FlowFieldData> buildFlowField(BWAPI::TilePosition target);
+
+	/**
+	 * Flow fields of the last targets, the least recently used one is dropped when there are more
+	 * than the capacity. Blocking or unblocking tiles drops all of them (the handles already given
+	 * keep their field). Safe to use from several threads.
+	 */
+	class FlowFieldCache : public ObstacleListener
+	{
+	public:
+		FlowFieldCache();
+		~FlowFieldCache();
+
+		FlowField get(BWAPI::TilePosition target);
+		void setCapacity(size_t fields);
+		void clear();
+
+		void onTilesChanged(const std::vector<BWAPI::TilePosition>& tiles);
+
+	private:
+		struct Entry {
+			BWAPI::TilePosition target;
+			uint64_t lastUse;
+			std::shared_ptr<const FlowFieldData> data;
+		};
+
+		void evict();
+
+		std::mutex _mutex;
+		std::vector<Entry> _entries;
+		size_t _capacity;
+		uint64_t _tick;
+		uint64_t _generation;	// incremented by clear()
+	};
+
+	FlowFieldCache& getFlowFieldCache();
+}
@@ -0,0 +1,28 @@
+#include "GridSearch.h"
+
+#include <memory>
+#include <mutex>
+
+namespace BWTA
+{
+	// idle contexts, searches can run from several threads (e.g. the analysis tasks)
+	static std::mutex contextPoolMutex;
+	static std::vector<std::unique_ptr<GridSearchContext>> contextPool;
+
+	GridSearchLease::GridSearchLease()
+	{
+		std::lock_guard<std::mutex> lock(contextPoolMutex);
+		if (contextPool.empty()) {
+			_context = new GridSearchContext();
+		} else {
+			_context = contextPool.back().release();
+			contextPool.pop_back();
+		}
+	}
+
+	GridSearchLease::~GridSearchLease()
+	{
+		std::lock_guard<std::mutex> lock(contextPoolMutex);
+		contextPool.emplace_back(_context);
+	}
+}
@@ -0,0 +1,504 @@
+#pragma once
+
+#include "MapData.h"
+
+namespace BWTA
+{
+	/**
+	 * Indexed 4-ary min-heap of grid nodes (node = index in a width*height grid).
+	 * The position of each node in the heap is kept in a flat array, so decreaseKey is O(log n)
+	 * without any lookup structure. Whether a node is in the heap is tracked by the caller.
+	 */
+	template <class Key>
+	class BasicIndexedHeap4
+	{
+	public:
+		void resize(size_t nodeCount) { _position.resize(nodeCount); }
+		void clear() { _items.clear(); }
+
+		bool empty() const { return _items.empty(); }
+		int topNode() const { return _items[0].node; }
+		Key topKey() const { return _items[0].key; }
+
+		void push(int node, Key key)
+		{
+			_items.push_back(Item(node, key));
+			siftUp(_items.size() - 1);
+		}
+		// the node must be in the heap and key must not be greater than its current key
+		void decreaseKey(int node, Key key)
+		{
+			size_t i = _position[node];
+			_items[i].key = key;
+			siftUp(i);
+		}
+		// the node must be in the heap, key can go either way
+		void update(int node, Key key)
+		{
+			size_t i = _position[node];
+			const Key oldKey = _items[i].key;
+			_items[i].key = key;
+			if (key < oldKey) siftUp(i);
+			else siftDown(i);
+		}
+		// the node must be in the heap
+		void remove(int node)
+		{
+			size_t i = _position[node];
+			Item last = _items.back();
+			_items.pop_back();
+			if (i == _items.size()) return;
+			_items[i] = last;
+			if (i > 0 && _items[(i - 1) / 4].key > last.key) siftUp(i);
+			else siftDown(i);
+		}
+		void pop()
+		{
+			Item last = _items.back();
+			_items.pop_back();
+			if (_items.empty()) return;
+			_items[0] = last;
+			siftDown(0);
+		}
+
+	private:
+		struct Item {
+			int node;
+			Key key;
+			Item(int n, Key k) : node(n), key(k) {}
+		};
+
+		void place(size_t i, const Item& item)
+		{
+			_items[i] = item;
+			_position[item.node] = static_cast<uint32_t>(i);
+		}
+		void siftUp(size_t i)
+		{
+			Item item = _items[i];
+			while (i > 0) {
+				size_t parent = (i - 1) / 4;
+				if (_items[parent].key <= item.key) break;
+				place(i, _items[parent]);
+				i = parent;
+			}
+			place(i, item);
+		}
+		void siftDown(size_t i)
+		{
+			Item item = _items[i];
+			const size_t size = _items.size();
+			while (true) {
+				size_t first = 4 * i + 1;
+				if (first >= size) break;
+				size_t best = first;
+				size_t last = std::min(first + 4, size);
+				for (size_t child = first + 1; child < last; ++child) {
+					if (_items[child].key < _items[best].key) best = child;
+				}
+				if (_items[best].key >= item.key) break;
+				place(i, _items[best]);
+				i = best;
+			}
+			place(i, item);
+		}
+
+		std::vector<Item> _items;
+		std::vector<uint32_t> _position;
+	};
+	typedef BasicIndexedHeap4<int> IndexedHeap4;
+
+	/**
+	 * Scratch memory of a grid search: flat cost/parent arrays and an open list, reused between
+	 * searches. Instead of clearing the arrays, each search gets a new generation number and a node
+	 * is only valid if its stamp matches it, so starting a search is O(1).
+	 */
+	class GridSearchContext
+	{
+	public:
+		GridSearchContext() : _width(0), _height(0), _generation(0) {}
+
+		// starts a new search on a width x height grid
+		void begin(int width, int height)
+		{
+			_open.clear();
+			if (width != _width || height != _height) {
+				_width = width;
+				_height = height;
+				size_t size = static_cast<size_t>(width) * height;
+				_cost.resize(size);
+				_parent.resize(size);
+				_open.resize(size);
+				_seen.assign(size, 0);
+				_closed.assign(size, 0);
+				_marked.assign(size, 0);
+				_generation = 0;
+			}
+			if (++_generation == 0) { // wrapped around, old stamps could match again
+				std::fill(_seen.begin(), _seen.end(), 0);
+				std::fill(_closed.begin(), _closed.end(), 0);
+				std::fill(_marked.begin(), _marked.end(), 0);
+				_generation = 1;
+			}
+		}
+
+		int getWidth() const { return _width; }
+		int getHeight() const { return _height; }
+		// same column-major order as RectangleArray
+		int index(int x, int y) const { return x * _height + y; }
+		BWAPI::TilePosition position(int index) const { return BWAPI::TilePosition(index / _height, index % _height); }
+
+		bool isSeen(int node) const { return _seen[node] == _generation; }
+		bool isClosed(int node) const { return _closed[node] == _generation; }
+		bool isMarked(int node) const { return _marked[node] == _generation; }
+		void close(int node) { _closed[node] = _generation; }
+		void mark(int node) { _marked[node] = _generation; }
+		void unmark(int node) { _marked[node] = 0; }
+
+		int getCost(int node) const { return _cost[node]; }
+		int getParent(int node) const { return _parent[node]; }
+		void setCost(int node, int cost) { _seen[node] = _generation; _cost[node] = cost; }
+		void setParent(int node, int parent) { _parent[node] = parent; }
+
+		IndexedHeap4& open() { return _open; }
+
+		// path from the start of the search to node (parents must have been recorded)
+		std::vector<BWAPI::TilePosition> getPath(int node) const
+		{
+			std::vector<BWAPI::TilePosition> path;
+			while (true) {
+				path.push_back(position(node));
+				if (_parent[node] == node) break;
+				node = _parent[node];
+			}
+			std::reverse(path.begin(), path.end());
+			return path;
+		}
+
+	private:
+		int _width;
+		int _height;
+		uint32_t _generation;
+		std::vector<int> _cost;
+		std::vector<int> _parent;
+		std::vector<uint32_t> _seen;	// cost (and parent) valid
+		std::vector<uint32_t> _closed;
+		std::vector<uint32_t> _marked;	// goal nodes of a multi-target search
+		IndexedHeap4 _open;
+	};
+
+	/**
+	 * Borrows a GridSearchContext from a shared pool for the lifetime of the object. Contexts are
+	 * kept after use, so once the pool is warm a search does not allocate.
+	 */
+	class GridSearchLease
+	{
+	public:
+		GridSearchLease();
+		~GridSearchLease();
+
+		GridSearchContext& operator*() { return *_context; }
+		GridSearchContext* operator->() { return _context; }
+
+	private:
+		// non-copyable
+		GridSearchLease(const GridSearchLease&);
+		GridSearchLease& operator=(const GridSearchLease&);
+
+		GridSearchContext* _context;
+	};
+
+	// ---------------------------------------------- POLICIES ----------------------------------------------
+	// Goal: prepare(context) is called once the context is ready, reached(context, node) when node is
+	// popped from the open list and returns true to stop the search. isGoal(context, node) tells if
+	// node is a target without side effects (jump point search stops its jumps there).
+	// Heuristic: operator()(x, y) lower bound of the cost to the goal.
+	// Path: RECORD_PARENTS says if the parent of each node must be kept to rebuild the path.
+
+	struct SingleGoal {
+		BWAPI::TilePosition target;
+		int targetNode;
+		explicit SingleGoal(BWAPI::TilePosition t) : target(t), targetNode(-1) {}
+		void prepare(GridSearchContext& context)
+		{
+			bool inside = target.x >= 0 && target.y >= 0 && target.x < context.getWidth() && target.y < context.getHeight();
+			targetNode = inside ? context.index(target.x, target.y) : -1;
+		}
+		bool isGoal(const GridSearchContext&, int node) const { return node == targetNode; }
+		bool reached(GridSearchContext& context, int node) { return isGoal(context, node); }
+	};
+
+	// never stops: the search visits every reachable tile (Dijkstra with ZeroHeuristic)
+	struct NoGoal {
+		void prepare(GridSearchContext&) {}
+		bool isGoal(const GridSearchContext&, int) const { return false; }
+		bool reached(GridSearchContext&, int) { return false; }
+	};
+
+	// stops once every node of nodes was reached, their costs are then final
+	struct NodeSetGoal {
+		const std::vector<int>& nodes;
+		size_t remaining;
+		explicit NodeSetGoal(const std::vector<int>& n) : nodes(n), remaining(0) {}
+		void prepare(GridSearchContext& context)
+		{
+			remaining = 0;
+			for (int node : nodes) {
+				if (context.isMarked(node)) continue;
+				context.mark(node);
+				++remaining;
+			}
+		}
+		bool isGoal(const GridSearchContext& context, int node) const { return context.isMarked(node); }
+		bool reached(GridSearchContext& context, int node)
+		{
+			if (!context.isMarked(node)) return false;
+			context.unmark(node);
+			return --remaining == 0;
+		}
+	};
+
+	// marks the targets inside the grid, returns how many
+	inline size_t markTargets(GridSearchContext& context, const std::set<BWAPI::TilePosition>& targets)
+	{
+		size_t marked = 0;
+		for (const auto& t : targets) {
+			if (t.x < 0 || t.y < 0 || t.x >= context.getWidth() || t.y >= context.getHeight()) continue;
+			context.mark(context.index(t.x, t.y));
+			++marked;
+		}
+		return marked;
+	}
+
+	// stops at the first target reached
+	struct AnyGoal {
+		const std::set<BWAPI::TilePosition>& targets;
+		explicit AnyGoal(const std::set<BWAPI::TilePosition>& t) : targets(t) {}
+		void prepare(GridSearchContext& context) { markTargets(context, targets); }
+		bool isGoal(const GridSearchContext& context, int node) const { return context.isMarked(node); }
+		bool reached(GridSearchContext& context, int node) { return context.isMarked(node); }
+	};
+
+	// stops once every target was reached, their costs are stored in distances
+	struct AllGoals {
+		const std::set<BWAPI::TilePosition>& targets;
+		std::map<BWAPI::TilePosition, double>& distances;
+		size_t remaining;
+		AllGoals(const std::set<BWAPI::TilePosition>& t, std::map<BWAPI::TilePosition, double>& d)
+			: targets(t), distances(d), remaining(0) {}
+		void prepare(GridSearchContext& context) { remaining = markTargets(context, targets); }
+		bool isGoal(const GridSearchContext& context, int node) const { return context.isMarked(node); }
+		bool reached(GridSearchContext& context, int node)
+		{
+			if (!context.isMarked(node)) return false;
+			context.unmark(node);
+			distances[context.position(node)] = context.getCost(node) * 32.0 / 10.0;
+			return --remaining == 0;
+		}
+	};
+
+	// octile distance with the 10/14 costs of the search
+	inline int octileDistance(int dx, int dy)
+	{
+		dx = std::abs(dx);
+		dy = std::abs(dy);
+		return std::abs(dx - dy) * 10 + std::min(dx, dy) * 14;
+	}
+
+	struct OctileHeuristic {
+		BWAPI::TilePosition target;
+		explicit OctileHeuristic(BWAPI::TilePosition t) : target(t) {}
+		int operator()(int x, int y) const { return octileDistance(x - target.x, y - target.y); }
+	};
+
+	// distance to the closest target
+	struct MultiOctileHeuristic {
+		const std::set<BWAPI::TilePosition>& targets;
+		explicit MultiOctileHeuristic(const std::set<BWAPI::TilePosition>& t) : targets(t) {}
+		int operator()(int x, int y) const
+		{
+			int h = std::numeric_limits<int>::max();
+			for (const auto& t : targets) h = std::min(h, octileDistance(x - t.x, y - t.y));
+			return h;
+		}
+	};
+
+	struct ZeroHeuristic {
+		int operator()(int, int) const { return 0; }
+	};
+
+	struct CostOnly { static const bool RECORD_PARENTS = false; };
+	struct RecordPath { static const bool RECORD_PARENTS = true; };
+
+	// Grid: getWidth(), getHeight() and isWalkable(x, y) for (x, y) inside the grid.
+	struct WalkableGrid {
+		const RectangleArray<bool>& walkable;
+		explicit WalkableGrid(const RectangleArray<bool>& w) : walkable(w) {}
+		int getWidth() const { return (int)walkable.getWidth(); }
+		int getHeight() const { return (int)walkable.getHeight(); }
+		bool isWalkable(int x, int y) const { return walkable[x][y]; }
+	};
+
+	// returned by gridSearchResume when it stopped after maxExpansions nodes
+	const int GRID_SEARCH_PENDING = -2;
+
+	// starts a gridSearch that is run by gridSearchResume, false if start is outside the grid
+	template <class Path, class Goal, class Grid>
+	bool gridSearchBegin(GridSearchContext& context, const Grid& grid, BWAPI::TilePosition start, Goal& goal)
+	{
+		const int width = grid.getWidth();
+		const int height = grid.getHeight();
+		if (start.x < 0 || start.y < 0 || start.x >= width || start.y >= height) return false;
+		context.begin(width, height);
+		goal.prepare(context);
+
+		int startNode = context.index(start.x, start.y);
+		context.setCost(startNode, 0);
+		if (Path::RECORD_PARENTS) context.setParent(startNode, startNode);
+		context.open().push(startNode, 0);
+		return true;
+	}
+
+	/**
+	 * Expands at most maxExpansions nodes of the search started by gridSearchBegin (the grid, goal and
+	 * heuristic must be the same on each call). Returns the node where the goal stopped the search,
+	 * -1 if the open list ran out or GRID_SEARCH_PENDING if it can be resumed.
+	 */
+	template <class Path, class Goal, class Heuristic, class Grid>
+	int gridSearchResume(GridSearchContext& context, const Grid& grid, Goal& goal, const Heuristic& heuristic, int maxExpansions)
+	{
+		const int width = grid.getWidth();
+		const int height = grid.getHeight();
+		IndexedHeap4& open = context.open();
+		while (!open.empty()) {
+			int current = open.topNode();
+			if (goal.reached(context, current)) return current;
+			if (maxExpansions-- <= 0) return GRID_SEARCH_PENDING;
+			open.pop();
+			context.close(current);
+
+			const int px = current / height;
+			const int py = current % height;
+			const int cost = context.getCost(current);
+			const int minX = std::max(px - 1, 0);
+			const int maxX = std::min(px + 1, width - 1);
+			const int minY = std::max(py - 1, 0);
+			const int maxY = std::min(py + 1, height - 1);
+			for (int x = minX; x <= maxX; ++x) {
+				for (int y = minY; y <= maxY; ++y) {
+					if (!grid.isWalkable(x, y)) continue;
+					const bool diagonal = (x != px && y != py);
+					if (diagonal && !grid.isWalkable(px, y) && !grid.isWalkable(x, py)) continue;
+					const int next = context.index(x, y);
+					if (context.isClosed(next)) continue;
+
+					const int g = cost + (diagonal ? 14 : 10);
+					if (!context.isSeen(next)) {
+						context.setCost(next, g);
+						if (Path::RECORD_PARENTS) context.setParent(next, current);
+						open.push(next, g + heuristic(x, y));
+					} else if (g < context.getCost(next)) {
+						context.setCost(next, g);
+						if (Path::RECORD_PARENTS) context.setParent(next, current);
+						open.decreaseKey(next, g + heuristic(x, y));
+					}
+				}
+			}
+		}
+		return -1;
+	}
+
+	/**
+	 * A* over grid, 8-connected (10 straight, 14 diagonal, no corner cutting between two unwalkable
+	 * nodes). Returns the node where the goal stopped the search, or -1 if the open list ran out.
+	 * The costs (and parents) stay in the context until its next search.
+	 */
+	template <class Path, class Goal, class Heuristic, class Grid>
+	int gridSearch(GridSearchContext& context, const Grid& grid, BWAPI::TilePosition start, Goal& goal, const Heuristic& heuristic)
+	{
+		if (!gridSearchBegin<Path>(context, grid, start, goal)) return -1;
+		return gridSearchResume<Path>(context, grid, goal, heuristic, std::numeric_limits<int>::max());
+	}
+
+	/**
+	 * Bidirectional A* for the cost only: one search from start and one from end (the moves are
+	 * symmetric) over the flat buffers of two contexts. Each side uses the average of the two
+	 * heuristics, (toEnd - toStart) / 2 forward and the opposite backward, so the sides are consistent
+	 * with each other and the search stops as soon as the two smallest keys add up to the best cost
+	 * found where the searches meet (keys are doubled to stay integers). Returns the cost from start
+	 * to end, -1 if there is no path; same cost as gridSearch.
+	 */
+	template <class Grid, class ToEnd, class ToStart>
+	int bidirectionalGridSearch(GridSearchContext& forward, GridSearchContext& backward, const Grid& grid,
+		BWAPI::TilePosition start, BWAPI::TilePosition end, const ToEnd& toEnd, const ToStart& toStart)
+	{
+		const int width = grid.getWidth();
+		const int height = grid.getHeight();
+		if (start.x < 0 || start.y < 0 || start.x >= width || start.y >= height) return -1;
+		if (end.x < 0 || end.y < 0 || end.x >= width || end.y >= height) return -1;
+		if (start == end) return 0;
+		// a search never steps into an unwalkable tile, but it can start on one
+		if (!grid.isWalkable(end.x, end.y)) return -1;
+
+		forward.begin(width, height);
+		backward.begin(width, height);
+		const int startNode = forward.index(start.x, start.y);
+		const int endNode = backward.index(end.x, end.y);
+		forward.setCost(startNode, 0);
+		forward.open().push(startNode, toEnd(start.x, start.y) - toStart(start.x, start.y));
+		backward.setCost(endNode, 0);
+		backward.open().push(endNode, toStart(end.x, end.y) - toEnd(end.x, end.y));
+
+		// a side that ran out keeps going through the other one: an unwalkable start is only met
+		// once the forward side has stepped out of it
+		const int exhausted = std::numeric_limits<int>::max() / 4;
+		int best = std::numeric_limits<int>::max();
+		while (!forward.open().empty() || !backward.open().empty()) {
+			const int forwardKey = forward.open().empty() ? exhausted : forward.open().topKey();
+			const int backwardKey = backward.open().empty() ? exhausted : backward.open().topKey();
+			if (best != std::numeric_limits<int>::max() && forwardKey + backwardKey >= 2 * best) break;
+
+			const bool isForward = (forwardKey <= backwardKey);
+			GridSearchContext& side = isForward ? forward : backward;
+			const GridSearchContext& other = isForward ? backward : forward;
+			IndexedHeap4& open = side.open();
+			const int current = open.topNode();
+			open.pop();
+			side.close(current);
+
+			const int px = current / height;
+			const int py = current % height;
+			const int cost = side.getCost(current);
+			for (int x = std::max(px - 1, 0); x <= std::min(px + 1, width - 1); ++x) {
+				for (int y = std::max(py - 1, 0); y <= std::min(py + 1, height - 1); ++y) {
+					if (!grid.isWalkable(x, y)) continue;
+					const bool diagonal = (x != px && y != py);
+					if (diagonal && !grid.isWalkable(px, y) && !grid.isWalkable(x, py)) continue;
+					const int next = side.index(x, y);
+					if (side.isClosed(next)) continue;
+
+					const int g = cost + (diagonal ? 14 : 10);
+					const int potential = isForward ? toEnd(x, y) - toStart(x, y) : toStart(x, y) - toEnd(x, y);
+					if (!side.isSeen(next)) {
+						side.setCost(next, g);
+						open.push(next, 2 * g + potential);
+					} else if (g < side.getCost(next)) {
+						side.setCost(next, g);
+						open.decreaseKey(next, 2 * g + potential);
+					} else {
+						continue;
+					}
+					if (other.isSeen(next)) best = std::min(best, g + other.getCost(next));
+				}
+			}
+		}
+		return (best == std::numeric_limits<int>::max()) ? -1 : best;
+	}
+
+	// gridSearch over MapData::lowResWalkability (tile resolution)
+	template <class Path, class Goal, class Heuristic>
+	int gridSearch(GridSearchContext& context, BWAPI::TilePosition start, Goal& goal, const Heuristic& heuristic)
+	{
+		return gridSearch<Path>(context, WalkableGrid(MapData::lowResWalkability), start, goal, heuristic);
+	}
+}
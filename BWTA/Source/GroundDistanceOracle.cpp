@@ -0,0 +1,35 @@
+#include <BWTA/GroundDistanceOracle.h>
+#include <BWTA.h>
+
+#include "BWTA_Result.h"
+#include "ObstacleOverlay.h"
+
+namespace BWTA
+{
+	GroundDistanceOracle::GroundDistanceOracle()
+		: _query(new ContractionHierarchyQuery())
+	{
+	}
+
+	GroundDistanceOracle::~GroundDistanceOracle()
+	{
+		delete _query;
+	}
+
+	bool GroundDistanceOracle::isAvailable()
+	{
+		// the hierarchy is written by the analysis and does not know about blocked tiles
+		if (getAnalysisStep() != ANALYSIS_DONE || !getObstacleOverlay().empty()) return false;
+		BWTA_Result::require(BWTA_Result::LAZY_CONTRACTION_HIERARCHY);
+		return !BWTA_Result::contractionHierarchy.empty();
+	}
+
+	double GroundDistanceOracle::getDistance(BWAPI::TilePosition start, BWAPI::TilePosition end)
+	{
+		if (!isAvailable()) return getGroundDistance(start, end);
+		if (!isConnected(start, end)) return -1;
+		int cost = BWTA_Result::contractionHierarchy.getDistance(*_query, MapData::lowResWalkability, start, end);
+		if (cost == -1) return -1;
+		return cost * 32.0 / 10.0;
+	}
+}
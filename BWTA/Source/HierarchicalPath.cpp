@@ -0,0 +1,128 @@
+#include <BWTA/HierarchicalPath.h>
+#include <BWTA/Chokepoint.h>
+
+#include "BWTA_Result.h"
+#include "Pathfinding.h"
+
+namespace BWTA
+{
+	namespace
+	{
+		// tile walkability restricted to the regions of a route (tile resolution region of
+		// ChokepointDistanceTable, the same regions as regionLabelMap)
+		class CorridorGrid
+		{
+		public:
+			CorridorGrid(const ChokepointDistanceTable& table, const std::vector<char>& inRoute)
+				: _table(table), _inRoute(inRoute) {}
+
+			int getWidth() const { return MapData::mapWidthTileRes; }
+			int getHeight() const { return MapData::mapHeightTileRes; }
+			bool isWalkable(int x, int y) const
+			{
+				return MapData::lowResWalkability[x][y] && _inRoute[_table.getRegionIndex(BWAPI::TilePosition(x, y)) + 1] != 0;
+			}
+
+		private:
+			const ChokepointDistanceTable& _table;
+			const std::vector<char>& _inRoute;
+		};
+
+		// center of a chokepoint, or the closest walkable tile around it
+		BWAPI::TilePosition getWaypoint(const Chokepoint* chokepoint)
+		{
+			const BWAPI::TilePosition center(chokepoint->getCenter());
+			const RectangleArray<bool>& walkable = MapData::lowResWalkability;
+			for (int radius = 0; radius <= 3; ++radius) {
+				for (int x = center.x - radius; x <= center.x + radius; ++x) {
+					for (int y = center.y - radius; y <= center.y + radius; ++y) {
+						if (std::max(std::abs(x - center.x), std::abs(y - center.y)) != radius) continue;
+						if (x < 0 || y < 0 || x >= (int)walkable.getWidth() || y >= (int)walkable.getHeight()) continue;
+						if (walkable[x][y]) return BWAPI::TilePosition(x, y);
+					}
+				}
+			}
+			return center;
+		}
+	}
+
+	HierarchicalPath::HierarchicalPath(BWAPI::TilePosition start, BWAPI::TilePosition target)
+		: _start(start), _target(target)
+	{
+		const ChokepointDistanceTable& table = getChokepointDistanceTable();
+		const int startRegion = table.getRegionIndex(start);
+		const int targetRegion = table.getRegionIndex(target);
+		if (startRegion == -1 || targetRegion == -1) return;
+		if (startRegion != targetRegion) {
+			ChokePath route = table.getPath(start, target);
+			if (route.empty()) return;
+			_chokepoints.assign(route.begin(), route.end());
+		}
+
+		// the regions crossed, from the start region through the other side of each chokepoint
+		const std::vector<Region*>& regions = BWTA_Result::regions;
+		_inRoute.assign(regions.size() + 1, 0);
+		_inRoute[0] = 1;
+		_waypoints.push_back(start);
+		_segmentRegions.push_back(startRegion);
+		_inRoute[startRegion + 1] = 1;
+		for (const auto& chokepoint : _chokepoints) {
+			const std::pair<Region*, Region*>& sides = chokepoint->getRegions();
+			Region* next = (sides.first == regions[_segmentRegions.back()]) ? sides.second : sides.first;
+			const int nextRegion = (int)(std::find(regions.begin(), regions.end(), next) - regions.begin());
+			if (nextRegion == (int)regions.size()) {
+				_waypoints.clear();
+				return;
+			}
+			_waypoints.push_back(getWaypoint(chokepoint));
+			_segmentRegions.push_back(nextRegion);
+			_inRoute[nextRegion + 1] = 1;
+		}
+		_waypoints.push_back(target);
+
+		_segments.resize(_segmentRegions.size());
+		_refined.assign(_segmentRegions.size(), 0);
+	}
+
+	int HierarchicalPath::getSegmentIndex(BWAPI::TilePosition tile) const
+	{
+		if (!isReachable()) return -1;
+		const int region = getChokepointDistanceTable().getRegionIndex(tile);
+		for (size_t i = 0; i < _segmentRegions.size(); ++i) {
+			if (_segmentRegions[i] == region) return (int)i;
+		}
+		return -1;
+	}
+
+	const std::vector<BWAPI::TilePosition>& HierarchicalPath::getSegment(int index)
+	{
+		static const std::vector<BWAPI::TilePosition> noSegment;
+		if (index < 0 || index >= getSegmentCount()) return noSegment;
+		if (_refined[index]) return _segments[index];
+		_refined[index] = 1;
+
+		const BWAPI::TilePosition from = _waypoints[index];
+		const BWAPI::TilePosition to = _waypoints[index + 1];
+		GridSearchLease context;
+		SingleGoal goal(to);
+		int found = gridSearch<RecordPath>(*context, CorridorGrid(getChokepointDistanceTable(), _inRoute), from, goal, OctileHeuristic(to));
+		if (found == -1) {
+			// the regions do not always hold the whole way around a chokepoint, search the whole map
+			found = gridSearch<RecordPath>(*context, from, goal, OctileHeuristic(to));
+		}
+		if (found != -1) _segments[index] = context->getPath(found);
+		return _segments[index];
+	}
+
+	std::vector<BWAPI::TilePosition> HierarchicalPath::getPath()
+	{
+		std::vector<BWAPI::TilePosition> path;
+		for (int i = 0; i < getSegmentCount(); ++i) {
+			const std::vector<BWAPI::TilePosition>& segment = getSegment(i);
+			if (segment.empty()) return std::vector<BWAPI::TilePosition>();
+			// each segment starts on the last tile of the previous one
+			path.insert(path.end(), path.empty() ? segment.begin() : segment.begin() + 1, segment.end());
+		}
+		return path;
+	}
+}
@@ -0,0 +1,85 @@
+#include "JumpPointSearch.h"
+
+namespace BWTA
+{
+	void JumpTable::build(const RectangleArray<bool>& walkable)
+	{
+		const JumpGrid grid(walkable);
+		_width = grid.getWidth();
+		_height = grid.getHeight();
+		_distances.assign(static_cast<size_t>(_width) * _height * JUMP_DIRECTION_COUNT, 0);
+
+		// the distance of a tile is derived from the next tile in the same direction, so each
+		// direction is swept from the far side; diagonals use the straight distances of the next tile
+		for (int direction = 0; direction < JUMP_DIRECTION_COUNT; ++direction) {
+			const int dx = JUMP_DX[direction];
+			const int dy = JUMP_DY[direction];
+			const bool diagonal = (dx != 0 && dy != 0);
+			for (int i = 0; i < _width; ++i) {
+				const int x = (dx > 0) ? _width - 1 - i : i;
+				for (int j = 0; j < _height; ++j) {
+					const int y = (dy > 0) ? _height - 1 - j : j;
+					if (!grid.isWalkable(x, y) || !grid.canMove(x, y, dx, dy)) continue; // 0: blocked
+					const int nx = x + dx;
+					const int ny = y + dy;
+					const int next = nx * _height + ny;
+					bool jumpPoint = grid.hasForcedNeighbor(nx, ny, dx, dy);
+					if (diagonal && !jumpPoint) {
+						jumpPoint = getDistance(next, jumpDirection(dx, 0)) > 0 || getDistance(next, jumpDirection(0, dy)) > 0;
+					}
+					int distance = 1;
+					if (!jumpPoint) {
+						int nextDistance = getDistance(next, direction);
+						distance = (nextDistance > 0) ? nextDistance + 1 : nextDistance - 1;
+					}
+					_distances[(x * _height + y) * JUMP_DIRECTION_COUNT + direction] = static_cast<int16_t>(distance);
+				}
+			}
+		}
+	}
+
+	void JumpTable::assign(int width, int height, std::vector<int16_t>& distances)
+	{
+		_width = width;
+		_height = height;
+		_distances.swap(distances);
+	}
+
+	void JumpTable::clear()
+	{
+		_width = 0;
+		_height = 0;
+		_distances.clear();
+	}
+
+	int jumpPointSearchPlus(GridSearchContext& context, BWAPI::TilePosition start, BWAPI::TilePosition target, const JumpTable& table)
+	{
+		if (table.getWidth() != MapData::mapWidthTileRes || table.getHeight() != MapData::mapHeightTileRes) return -1;
+		context.begin(table.getWidth(), table.getHeight());
+		SingleGoal goal(target);
+		goal.prepare(context);
+		return jumpSearch(context, start, goal, OctileHeuristic(target), TableJumper(table, context, target));
+	}
+
+	std::vector<BWAPI::TilePosition> getJumpPath(const GridSearchContext& context, int node)
+	{
+		std::vector<BWAPI::TilePosition> jumpPoints = context.getPath(node);
+		std::vector<BWAPI::TilePosition> path;
+		path.reserve(jumpPoints.size());
+		for (const auto& jumpPoint : jumpPoints) {
+			if (path.empty()) {
+				path.push_back(jumpPoint);
+				continue;
+			}
+			BWAPI::TilePosition p = path.back();
+			const int dx = (jumpPoint.x > p.x) - (jumpPoint.x < p.x);
+			const int dy = (jumpPoint.y > p.y) - (jumpPoint.y < p.y);
+			while (p != jumpPoint) {
+				if (p.x != jumpPoint.x) p.x += dx;
+				if (p.y != jumpPoint.y) p.y += dy;
+				path.push_back(p);
+			}
+		}
+		return path;
+	}
+}
@@ -0,0 +1,255 @@
+#pragma once
+
+#include "GridSearch.h"
+
+namespace BWTA
+{
+	/**
+	 * Jump Point Search over the same graph as gridSearch() (MapData::lowResWalkability, 10/14 costs,
+	 * a diagonal step is only blocked when both tiles beside it are unwalkable). Instead of pushing
+	 * every neighbor it follows straight and diagonal lines and only stops at "jump points" (tiles
+	 * with a neighbor that cannot be reached as cheaply without going through them), so on open
+	 * ground it expands a handful of tiles. The distances are the same as gridSearch(), the path can
+	 * be a different one of the same length.
+	 */
+
+	// the 8 directions, straight ones first
+	enum JumpDirection { JUMP_E, JUMP_W, JUMP_S, JUMP_N, JUMP_SE, JUMP_NE, JUMP_SW, JUMP_NW, JUMP_DIRECTION_COUNT };
+	const int JUMP_DX[JUMP_DIRECTION_COUNT] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+	const int JUMP_DY[JUMP_DIRECTION_COUNT] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+
+	inline int jumpDirection(int dx, int dy)
+	{
+		if (dy == 0) return dx > 0 ? JUMP_E : JUMP_W;
+		if (dx == 0) return dy > 0 ? JUMP_S : JUMP_N;
+		if (dx > 0) return dy > 0 ? JUMP_SE : JUMP_NE;
+		return dy > 0 ? JUMP_SW : JUMP_NW;
+	}
+
+	// movement rules of the search and the pruning rules of JPS derived from them
+	class JumpGrid
+	{
+	public:
+		explicit JumpGrid(const RectangleArray<bool>& walkable)
+			: _walkable(walkable), _width(walkable.getWidth()), _height(walkable.getHeight()) {}
+
+		int getWidth() const { return _width; }
+		int getHeight() const { return _height; }
+
+		bool isWalkable(int x, int y) const
+		{
+			return x >= 0 && y >= 0 && x < _width && y < _height && _walkable[x][y];
+		}
+		bool canMove(int x, int y, int dx, int dy) const
+		{
+			if (!isWalkable(x + dx, y + dy)) return false;
+			return dx == 0 || dy == 0 || isWalkable(x + dx, y) || isWalkable(x, y + dy);
+		}
+		// (x,y) reached moving (dx,dy) has a neighbor only reachable at the same cost through it
+		bool hasForcedNeighbor(int x, int y, int dx, int dy) const
+		{
+			if (dx == 0) {
+				return (!isWalkable(x - 1, y) && canMove(x, y, -1, dy)) || (!isWalkable(x + 1, y) && canMove(x, y, 1, dy));
+			}
+			if (dy == 0) {
+				return (!isWalkable(x, y - 1) && canMove(x, y, dx, -1)) || (!isWalkable(x, y + 1) && canMove(x, y, dx, 1));
+			}
+			return (!isWalkable(x - dx, y) && canMove(x, y, -dx, dy)) || (!isWalkable(x, y - dy) && canMove(x, y, dx, -dy));
+		}
+		// bit mask of the directions to search from (x,y) reached moving (dx,dy), (0,0) at the start
+		int getSuccessorDirections(int x, int y, int dx, int dy) const
+		{
+			if (dx == 0 && dy == 0) return (1 << JUMP_DIRECTION_COUNT) - 1;
+			int directions = 1 << jumpDirection(dx, dy);
+			if (dx == 0) {
+				if (!isWalkable(x - 1, y)) directions |= 1 << jumpDirection(-1, dy);
+				if (!isWalkable(x + 1, y)) directions |= 1 << jumpDirection(1, dy);
+			} else if (dy == 0) {
+				if (!isWalkable(x, y - 1)) directions |= 1 << jumpDirection(dx, -1);
+				if (!isWalkable(x, y + 1)) directions |= 1 << jumpDirection(dx, 1);
+			} else {
+				directions |= (1 << jumpDirection(dx, 0)) | (1 << jumpDirection(0, dy));
+				if (!isWalkable(x - dx, y)) directions |= 1 << jumpDirection(-dx, dy);
+				if (!isWalkable(x, y - dy)) directions |= 1 << jumpDirection(dx, -dy);
+			}
+			return directions;
+		}
+
+	private:
+		const RectangleArray<bool>& _walkable;
+		int _width;
+		int _height;
+	};
+
+	/**
+	 * Jump distances for JPS+: for each tile and direction, d > 0 means the next jump point is d
+	 * steps away, d <= 0 means -d steps can be taken before hitting an obstacle without finding one.
+	 * Built by the analysis and stored in the cache file.
+	 */
+	class JumpTable
+	{
+	public:
+		JumpTable() : _width(0), _height(0) {}
+
+		void build(const RectangleArray<bool>& walkable);
+		// distances has width*height*JUMP_DIRECTION_COUNT values, node-major
+		void assign(int width, int height, std::vector<int16_t>& distances);
+		void clear();
+
+		bool empty() const { return _distances.empty(); }
+		int getWidth() const { return _width; }
+		int getHeight() const { return _height; }
+		int getDistance(int node, int direction) const { return _distances[node * JUMP_DIRECTION_COUNT + direction]; }
+		const std::vector<int16_t>& getDistances() const { return _distances; }
+
+	private:
+		int _width;
+		int _height;
+		std::vector<int16_t> _distances;
+	};
+
+	// scans the grid tile by tile, stops at jump points and at the targets of goal
+	template <class Goal>
+	class OnlineJumper
+	{
+	public:
+		OnlineJumper(const JumpGrid& grid, const GridSearchContext& context, const Goal& goal)
+			: _grid(grid), _context(context), _goal(goal) {}
+
+		// jump point reached from (x,y) in direction, -1 if there is none
+		int operator()(int x, int y, int direction) const
+		{
+			const int dx = JUMP_DX[direction];
+			const int dy = JUMP_DY[direction];
+			if (dx == 0 || dy == 0) return jumpStraight(x, y, dx, dy);
+			while (true) {
+				if (!_grid.canMove(x, y, dx, dy)) return -1;
+				x += dx;
+				y += dy;
+				const int node = _context.index(x, y);
+				if (_goal.isGoal(_context, node) || _grid.hasForcedNeighbor(x, y, dx, dy)) return node;
+				if (jumpStraight(x, y, dx, 0) != -1 || jumpStraight(x, y, 0, dy) != -1) return node;
+			}
+		}
+
+	private:
+		int jumpStraight(int x, int y, int dx, int dy) const
+		{
+			while (true) {
+				if (!_grid.isWalkable(x + dx, y + dy)) return -1;
+				x += dx;
+				y += dy;
+				const int node = _context.index(x, y);
+				if (_goal.isGoal(_context, node) || _grid.hasForcedNeighbor(x, y, dx, dy)) return node;
+			}
+		}
+
+		const JumpGrid& _grid;
+		const GridSearchContext& _context;
+		const Goal& _goal;
+	};
+
+	// JPS+: reads the jumps from a JumpTable, only for a single target
+	class TableJumper
+	{
+	public:
+		TableJumper(const JumpTable& table, const GridSearchContext& context, BWAPI::TilePosition target)
+			: _table(table), _context(context), _target(target) {}
+
+		int operator()(int x, int y, int direction) const
+		{
+			const int dx = JUMP_DX[direction];
+			const int dy = JUMP_DY[direction];
+			const int distance = _table.getDistance(_context.index(x, y), direction);
+			const int reach = std::abs(distance);
+			// the target (or the tile of the diagonal in line with it) is before the next jump point
+			const int toTargetX = (_target.x - x) * dx;
+			const int toTargetY = (_target.y - y) * dy;
+			if (dy == 0) {
+				if (_target.y == y && toTargetX > 0 && toTargetX <= reach) return _context.index(_target.x, y);
+			} else if (dx == 0) {
+				if (_target.x == x && toTargetY > 0 && toTargetY <= reach) return _context.index(x, _target.y);
+			} else if (toTargetX > 0 && toTargetY > 0) {
+				const int steps = std::min(toTargetX, toTargetY);
+				if (steps <= reach) return _context.index(x + steps * dx, y + steps * dy);
+			}
+			if (distance <= 0) return -1;
+			return _context.index(x + distance * dx, y + distance * dy);
+		}
+
+	private:
+		const JumpTable& _table;
+		const GridSearchContext& _context;
+		BWAPI::TilePosition _target;
+	};
+
+	/**
+	 * A* over the jump points returned by jumper. Parents are always recorded (they give the
+	 * direction used to prune the successors), use getJumpPath() to get the path tile by tile.
+	 */
+	template <class Goal, class Heuristic, class Jumper>
+	int jumpSearch(GridSearchContext& context, BWAPI::TilePosition start, Goal& goal, const Heuristic& heuristic, const Jumper& jumper)
+	{
+		const JumpGrid grid(MapData::lowResWalkability);
+		const int width = grid.getWidth();
+		const int height = grid.getHeight();
+		if (start.x < 0 || start.y < 0 || start.x >= width || start.y >= height) return -1;
+
+		IndexedHeap4& open = context.open();
+		int startNode = context.index(start.x, start.y);
+		context.setCost(startNode, 0);
+		context.setParent(startNode, startNode);
+		open.push(startNode, 0);
+
+		while (!open.empty()) {
+			int current = open.topNode();
+			if (goal.reached(context, current)) return current;
+			open.pop();
+			context.close(current);
+
+			const int px = current / height;
+			const int py = current % height;
+			const int parent = context.getParent(current);
+			const int dx = (px > parent / height) - (px < parent / height);
+			const int dy = (py > parent % height) - (py < parent % height);
+			const int cost = context.getCost(current);
+			const int directions = grid.getSuccessorDirections(px, py, dx, dy);
+			for (int direction = 0; direction < JUMP_DIRECTION_COUNT; ++direction) {
+				if ((directions & (1 << direction)) == 0) continue;
+				const int next = jumper(px, py, direction);
+				if (next == -1 || context.isClosed(next)) continue;
+
+				const int x = next / height;
+				const int y = next % height;
+				const int g = cost + octileDistance(x - px, y - py);
+				if (!context.isSeen(next)) {
+					context.setCost(next, g);
+					context.setParent(next, current);
+					open.push(next, g + heuristic(x, y));
+				} else if (g < context.getCost(next)) {
+					context.setCost(next, g);
+					context.setParent(next, current);
+					open.decreaseKey(next, g + heuristic(x, y));
+				}
+			}
+		}
+		return -1;
+	}
+
+	// JPS on any goal (see GridSearch.h for the policies)
+	template <class Goal, class Heuristic>
+	int jumpPointSearch(GridSearchContext& context, BWAPI::TilePosition start, Goal& goal, const Heuristic& heuristic)
+	{
+		context.begin(MapData::mapWidthTileRes, MapData::mapHeightTileRes);
+		goal.prepare(context);
+		const JumpGrid grid(MapData::lowResWalkability);
+		return jumpSearch(context, start, goal, heuristic, OnlineJumper<Goal>(grid, context, goal));
+	}
+
+	// JPS+ from start to target using the precomputed jumps of table
+	int jumpPointSearchPlus(GridSearchContext& context, BWAPI::TilePosition start, BWAPI::TilePosition target, const JumpTable& table);
+
+	// path from the start of the search to node, tile by tile (the jump points are joined by straight
+	// or diagonal lines)
+	std::vector<BWAPI::TilePosition> getJumpPath(const GridSearchContext& context, int node);
+}
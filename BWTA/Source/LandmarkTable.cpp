@@ -0,0 +1,109 @@
+#include "LandmarkTable.h"
+
+#include <functional>
+
+namespace BWTA
+{
+	const uint16_t LandmarkTable::UNKNOWN;
+	const int LandmarkTable::MAX_LANDMARKS;
+	const int LandmarkHeuristic::ACTIVE_LANDMARKS;
+
+	std::vector<BWAPI::TilePosition> LandmarkTable::selectLandmarks(const std::vector<BWAPI::TilePosition>& candidates)
+	{
+		std::vector<BWAPI::TilePosition> landmarks;
+		if (candidates.empty()) return landmarks;
+		// start with the candidate farthest from the others, then always add the one farthest from the
+		// landmarks already taken
+		std::vector<int> closest(candidates.size(), std::numeric_limits<int>::max());
+		size_t next = 0;
+		int bestSum = -1;
+		for (size_t i = 0; i < candidates.size(); ++i) {
+			int sum = 0;
+			for (const auto& other : candidates) sum += octileDistance(candidates[i].x - other.x, candidates[i].y - other.y);
+			if (sum > bestSum) {
+				bestSum = sum;
+				next = i;
+			}
+		}
+		while (landmarks.size() < std::min(candidates.size(), static_cast<size_t>(MAX_LANDMARKS))) {
+			landmarks.push_back(candidates[next]);
+			int farthest = -1;
+			for (size_t i = 0; i < candidates.size(); ++i) {
+				const BWAPI::TilePosition& landmark = landmarks.back();
+				closest[i] = std::min(closest[i], octileDistance(candidates[i].x - landmark.x, candidates[i].y - landmark.y));
+				if (closest[i] > farthest) {
+					farthest = closest[i];
+					next = i;
+				}
+			}
+			if (farthest == 0) break; // only duplicates left
+		}
+		return landmarks;
+	}
+
+	void LandmarkTable::resize(int width, int height, int landmarkCount)
+	{
+		_width = width;
+		_height = height;
+		_landmarkCount = landmarkCount;
+		_distances.assign(static_cast<size_t>(landmarkCount) * width * height, UNKNOWN);
+	}
+
+	void LandmarkTable::compute(int landmark, BWAPI::TilePosition tile)
+	{
+		GridSearchLease context;
+		NoGoal goal;
+		gridSearch<CostOnly>(*context, tile, goal, ZeroHeuristic());
+
+		uint16_t* field = _distances.data() + static_cast<size_t>(landmark) * _width * _height;
+		const int size = _width * _height;
+		for (int node = 0; node < size; ++node) {
+			if (!context->isSeen(node)) continue;
+			const int cost = context->getCost(node);
+			field[node] = (cost < UNKNOWN) ? static_cast<uint16_t>(cost) : UNKNOWN;
+		}
+	}
+
+	void LandmarkTable::assign(int width, int height, int landmarkCount, std::vector<uint16_t>& distances)
+	{
+		_width = width;
+		_height = height;
+		_landmarkCount = landmarkCount;
+		_distances.swap(distances);
+	}
+
+	void LandmarkTable::clear()
+	{
+		_width = 0;
+		_height = 0;
+		_landmarkCount = 0;
+		_distances.clear();
+	}
+
+	LandmarkHeuristic::LandmarkHeuristic(const LandmarkTable& table, BWAPI::TilePosition start, BWAPI::TilePosition target)
+		: _target(target), _height(table.getHeight()), _activeCount(0)
+	{
+		const bool inside = start.x >= 0 && start.y >= 0 && start.x < table.getWidth() && start.y < table.getHeight()
+			&& target.x >= 0 && target.y >= 0 && target.x < table.getWidth() && target.y < table.getHeight();
+		if (!inside) return;
+
+		// keep the landmarks with the largest bound between start and target
+		std::vector<std::pair<int, int>> bounds;
+		const int startNode = start.x * _height + start.y;
+		const int targetNode = target.x * _height + target.y;
+		for (int i = 0; i < table.getLandmarkCount(); ++i) {
+			const int toStart = table.getField(i)[startNode];
+			const int toTarget = table.getField(i)[targetNode];
+			if (toTarget == LandmarkTable::UNKNOWN) continue;
+			// an unwalkable start is not in the fields, the landmark can still bound its neighbors
+			bounds.push_back(std::make_pair(toStart == LandmarkTable::UNKNOWN ? 0 : std::abs(toTarget - toStart), i));
+		}
+		std::sort(bounds.begin(), bounds.end(), std::greater<std::pair<int, int>>());
+		for (const auto& bound : bounds) {
+			if (_activeCount == ACTIVE_LANDMARKS) break;
+			_fields[_activeCount] = table.getField(bound.second);
+			_targetDistances[_activeCount] = table.getField(bound.second)[targetNode];
+			++_activeCount;
+		}
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "GridSearch.h"
+
+namespace BWTA
+{
+	/**
+	 * Landmarks of the ALT heuristic: the ground distance from a few base locations to every tile,
+	 * in the 10/14 units of gridSearch, as uint16 (UNKNOWN if unreachable or too far). By the triangle
+	 * inequality |d(L, target) - d(L, n)| is a lower bound of d(n, target) for any landmark L, much
+	 * tighter than the octile distance when the path has to go around obstacles.
+	 * Built by the analysis and stored in the cache file. Blocked tiles (ObstacleOverlay) only make
+	 * the distances longer, so the bound stays admissible.
+	 */
+	class LandmarkTable
+	{
+	public:
+		static const uint16_t UNKNOWN = 0xFFFF;
+		static const int MAX_LANDMARKS = 16;
+
+		LandmarkTable() : _width(0), _height(0), _landmarkCount(0) {}
+
+		// the landmarks spread over the map: greedy farthest point among the candidates
+		static std::vector<BWAPI::TilePosition> selectLandmarks(const std::vector<BWAPI::TilePosition>& candidates);
+
+		void resize(int width, int height, int landmarkCount);
+		// fills the distances of landmark with a Dijkstra from tile (can run in parallel for each landmark)
+		void compute(int landmark, BWAPI::TilePosition tile);
+		// distances has landmarkCount*width*height values, landmark-major
+		void assign(int width, int height, int landmarkCount, std::vector<uint16_t>& distances);
+		void clear();
+
+		bool empty() const { return _landmarkCount == 0; }
+		int getWidth() const { return _width; }
+		int getHeight() const { return _height; }
+		int getLandmarkCount() const { return _landmarkCount; }
+		// the field of landmark, indexed like GridSearchContext::index
+		const uint16_t* getField(int landmark) const { return _distances.data() + static_cast<size_t>(landmark) * _width * _height; }
+		const std::vector<uint16_t>& getDistances() const { return _distances; }
+
+	private:
+		int _width;
+		int _height;
+		int _landmarkCount;
+		std::vector<uint16_t> _distances;
+	};
+
+	// max(octile, landmark bound) toward target, with the landmarks that give the best bound at start
+	class LandmarkHeuristic
+	{
+	public:
+		static const int ACTIVE_LANDMARKS = 4;
+
+		LandmarkHeuristic(const LandmarkTable& table, BWAPI::TilePosition start, BWAPI::TilePosition target);
+
+		int operator()(int x, int y) const
+		{
+			int h = octileDistance(x - _target.x, y - _target.y);
+			const int node = x * _height + y;
+			for (int i = 0; i < _activeCount; ++i) {
+				const int distance = _fields[i][node];
+				if (distance == LandmarkTable::UNKNOWN) continue;
+				h = std::max(h, std::abs(_targetDistances[i] - distance));
+			}
+			return h;
+		}
+
+	private:
+		BWAPI::TilePosition _target;
+		int _height;
+		int _activeCount;
+		const uint16_t* _fields[ACTIVE_LANDMARKS];
+		int _targetDistances[ACTIVE_LANDMARKS];
+	};
+}
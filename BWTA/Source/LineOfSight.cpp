@@ -0,0 +1,111 @@
+#include "LineOfSight.h"
+
+namespace BWTA
+{
+	WalkabilityBits& getWalkabilityBits()
+	{
+		static WalkabilityBits bits;
+		return bits;
+	}
+
+	WalkabilityBits::WalkabilityBits()
+		: _built(false), _width(0), _height(0), _stride(0)
+	{
+		getObstacleOverlay().addListener(this);
+	}
+
+	WalkabilityBits::~WalkabilityBits()
+	{
+		getObstacleOverlay().removeListener(this);
+	}
+
+	void WalkabilityBits::reset()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_built.store(false, std::memory_order_release);
+		_words.clear();
+	}
+
+	void WalkabilityBits::build()
+	{
+		const RectangleArray<bool>& walkable = MapData::lowResWalkability;
+		_width = (int)walkable.getWidth();
+		_height = (int)walkable.getHeight();
+		_stride = (_width + 63) / 64;
+		_words.assign(static_cast<size_t>(_stride) * _height, 0);
+		for (int x = 0; x < _width; ++x) {
+			for (int y = 0; y < _height; ++y) set(x, y, walkable[x][y]);
+		}
+		_built.store(true, std::memory_order_release);
+	}
+
+	void WalkabilityBits::set(int x, int y, bool walkable)
+	{
+		const uint64_t bit = uint64_t(1) << (x & 63);
+		uint64_t& word = _words[y * _stride + (x >> 6)];
+		word = walkable ? (word | bit) : (word & ~bit);
+	}
+
+	void WalkabilityBits::onTilesChanged(const std::vector<BWAPI::TilePosition>& tiles)
+	{
+		if (!_built.load(std::memory_order_acquire)) return;
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (const auto& tile : tiles) set(tile.x, tile.y, MapData::lowResWalkability[tile.x][tile.y]);
+	}
+
+	bool WalkabilityBits::hasLineOfSight(BWAPI::TilePosition a, BWAPI::TilePosition b)
+	{
+		// blockTiles/unblockTiles may update the words from another thread while the line is traced
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (!_built.load(std::memory_order_relaxed)) build();
+		if (a.x < 0 || a.y < 0 || a.x >= _width || a.y >= _height) return false;
+		if (b.x < 0 || b.y < 0 || b.x >= _width || b.y >= _height) return false;
+
+		// supercover line: every tile the segment touches, stepping in x or y depending on which tile
+		// border the segment crosses first (both at once through a corner)
+		const int nx = std::abs(b.x - a.x);
+		const int ny = std::abs(b.y - a.y);
+		const int sx = (b.x > a.x) ? 1 : -1;
+		const int sy = (b.y > a.y) ? 1 : -1;
+		int x = a.x;
+		int y = a.y;
+		for (int ix = 0, iy = 0; ix < nx || iy < ny;) {
+			const int decision = (1 + 2 * ix) * ny - (1 + 2 * iy) * nx;
+			if (decision == 0) {
+				if (!isWalkable(x + sx, y) && !isWalkable(x, y + sy)) return false;
+				x += sx;
+				y += sy;
+				++ix;
+				++iy;
+			} else if (decision < 0) {
+				x += sx;
+				++ix;
+			} else {
+				y += sy;
+				++iy;
+			}
+			if (!isWalkable(x, y)) return false;
+		}
+		return true;
+	}
+
+	std::vector<BWAPI::TilePosition> smoothPath(const std::vector<BWAPI::TilePosition>& path)
+	{
+		if (path.size() <= 2) return path;
+		// the tiles where the path turns, the straight runs between them are always clear
+		std::vector<BWAPI::TilePosition> turns(1, path.front());
+		for (size_t i = 1; i + 1 < path.size(); ++i) {
+			if (path[i] - path[i - 1] != path[i + 1] - path[i]) turns.push_back(path[i]);
+		}
+		turns.push_back(path.back());
+
+		// string pulling: keep a turn only if the next one can not be seen from the last waypoint
+		WalkabilityBits& bits = getWalkabilityBits();
+		std::vector<BWAPI::TilePosition> waypoints(1, turns.front());
+		for (size_t i = 1; i + 1 < turns.size(); ++i) {
+			if (!bits.hasLineOfSight(waypoints.back(), turns[i + 1])) waypoints.push_back(turns[i]);
+		}
+		waypoints.push_back(turns.back());
+		return waypoints;
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "ObstacleOverlay.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace BWTA
+{
+	/**
+	 * MapData::lowResWalkability packed one bit per tile, row by row, for the line of sight tests of
+	 * the any-angle paths (8 KB on the largest maps, so long tests stay in cache). Built on first use
+	 * after each analysis; blocked and unblocked tiles are updated as they change.
+	 */
+	class WalkabilityBits : public ObstacleListener
+	{
+	public:
+		WalkabilityBits();
+		~WalkabilityBits();
+
+		void reset(); // the map changed, built again on next use
+		void onTilesChanged(const std::vector<BWAPI::TilePosition>& tiles);
+
+		/**
+		 * Every tile crossed by the segment between the centers of a and b is walkable (a itself is
+		 * not tested, a unit can stand on an unwalkable tile). Where the segment goes diagonally
+		 * through a corner, one of the two tiles beside it must be walkable, as in the searches.
+		 */
+		bool hasLineOfSight(BWAPI::TilePosition a, BWAPI::TilePosition b);
+
+	private:
+		void build(); // with _mutex held
+		bool isWalkable(int x, int y) const { return ((_words[y * _stride + (x >> 6)] >> (x & 63)) & 1) != 0; }
+		void set(int x, int y, bool walkable);
+
+		std::mutex _mutex;
+		std::atomic<bool> _built;
+		int _width;
+		int _height;
+		int _stride; // words per row
+		std::vector<uint64_t> _words;
+	};
+
+	WalkabilityBits& getWalkabilityBits();
+}
@@ -1,4 +1,7 @@
 #include "LoadData.h"
+#include "ObstacleOverlay.h"
+
+#include <mutex>
 
 using namespace BWAPI;
 namespace BWTA
@@ -82,7 +85,10 @@ namespace BWTA
 
 	void loadMap()
 	{
-		// init distance transform map
+		getObstacleOverlay().reset(); // lowResWalkability is computed again below
+
+		// init distance transform map (computed on demand, see distanceTransform())
+		MapData::maxDistanceTransform = 0;
 		MapData::distanceTransform.resize(MapData::mapWidthWalkRes, MapData::mapHeightWalkRes);
 		for (int x = 0; x < MapData::mapWidthWalkRes; x++) {
 			for (int y = 0; y < MapData::mapHeightWalkRes; y++) {
@@ -243,397 +249,677 @@ namespace BWTA
 	}
 
 
-  void load_data(std::string filename)
+  // keeps the cache file mapped while the label maps point inside it
+  // and while some BWTA_Result members are still pending to be materialized
+  static CacheReader cacheReader;
+  static std::vector<Chokepoint*> cachedChokepoints;
+  static std::vector<BaseLocation*> cachedBaseLocations;
+  static std::mutex lazyMutex;
+
+  template<typename T>
+  static int getId(const std::map<T*, int>& ids, T* object)
   {
-    int version;
-    int unwalkablePolygon_amount;
-    int baselocation_amount;
-    int chokepoint_amount;
-    int region_amount;
-    int map_width;
-    int map_height;
-    std::vector<PolygonImpl*> unwalkablePolygons;
-    std::vector<BaseLocation*> baselocations;
-    std::vector<Chokepoint*> chokepoints;
-    std::vector<Region*> regions;
-    std::ifstream file_in;
-    file_in.open(filename.c_str());
-    file_in >> version;
-    if (version!=BWTA_FILE_VERSION)  {
-      file_in.close();
-      return;
-    }
-    file_in >> unwalkablePolygon_amount;
-    file_in >> baselocation_amount;
-    file_in >> chokepoint_amount;
-    file_in >> region_amount;
-    file_in >> map_width;
-    file_in >> map_height;
-    for(int i=0;i<unwalkablePolygon_amount;i++)
-    {
-      PolygonImpl* p = new PolygonImpl();
-      unwalkablePolygons.push_back(p); // TODO why we need 2 vectors??
-	  BWTA_Result::unwalkablePolygons.push_back(p);
+    auto it = ids.find(object);
+    if (it == ids.end()) return -1;
+    return it->second;
+  }
+
+  template<typename T>
+  static T* getObject(const std::vector<T*>& objects, int id)
+  {
+    if (id < 0 || id >= (int)objects.size()) return nullptr;
+    return objects[id];
+  }
+
+  static void writePolygon(CacheWriter& out, const Polygon& polygon)
+  {
+    out.writeInt(polygon.size());
+    for (const auto& p : polygon) out.writePoint(p);
+    out.writeInt(polygon.getHoles().size());
+    for (const auto& h : polygon.getHoles()) {
+      out.writeInt(h->size());
+      for (const auto& p : *h) out.writePoint(p);
     }
-    for(int i=0;i<baselocation_amount;i++)
-    {
-      BaseLocation* b=new BaseLocationImpl();
-      baselocations.push_back(b);
-      BWTA_Result::baselocations.insert(b);
+  }
+
+  static void readPolygon(SectionCursor& in, PolygonImpl& polygon)
+  {
+    int size = in.readCount(2 * sizeof(int32_t));
+    for (int i = 0; i < size; ++i) polygon.push_back(in.readPoint<BWAPI::Position>());
+    int holeCount = in.readCount();
+    for (int j = 0; j < holeCount && in.ok(); ++j) {
+      PolygonImpl hole;
+      int holeSize = in.readCount(2 * sizeof(int32_t));
+      for (int k = 0; k < holeSize; ++k) hole.push_back(in.readPoint<BWAPI::Position>());
+      polygon.addHole(hole);
     }
-    for(int i=0;i<chokepoint_amount;i++)
-    {
-      Chokepoint* c=new ChokepointImpl();
-      chokepoints.push_back(c);
-      BWTA_Result::chokepoints.insert(c);
+  }
+
+  template<typename T>
+  static void writeIds(CacheWriter& out, const std::set<T*>& objects, const std::map<T*, int>& ids)
+  {
+    out.writeInt(objects.size());
+    for (const auto& object : objects) out.writeInt(getId(ids, object));
+  }
+
+  template<typename T>
+  static void readIds(SectionCursor& in, std::set<T*>& objects, const std::vector<T*>& all)
+  {
+    int count = in.readCount();
+    for (int i = 0; i < count; ++i) {
+      T* object = getObject(all, in.readInt());
+      if (object != nullptr) objects.insert(object);
     }
-    for(int i=0;i<region_amount;i++)
-    {
-      Region* r=new RegionImpl();
-      regions.push_back(r);
-	  BWTA_Result::regions.push_back(r);
+  }
+
+  // REGIONS and CHOKEPOINTS sections, shared by the cache file and the analysis checkpoints
+  // (the readers expect the count already read and the objects already created)
+  static void writeRegions(CacheWriter& out, const std::map<Region*, int>& rid,
+    const std::map<Chokepoint*, int>& cid, const std::map<BaseLocation*, int>& bid)
+  {
+    out.beginSection(CacheFile::REGIONS);
+    out.writeInt(BWTA_Result::regions.size());
+    for (const auto& region : BWTA_Result::regions) {
+      const RegionImpl* r = static_cast<const RegionImpl*>(region);
+      out.writeInt(r->_label);
+      writePolygon(out, r->_polygon);
+      out.writePoint(r->_center);
+      out.writePoint(r->_opennessPoint);
+      out.writeDouble(r->_opennessDistance);
+      out.writeInt(r->_maxDistance);
+      out.writeInt(r->_color);
+      out.writeDouble(r->_hue);
+      writeIds(out, r->_chokepoints, cid);
+      writeIds(out, r->baseLocations, bid);
+      writeIds(out, r->reachableRegions, rid);
+      out.writeInt(r->_coveragePositions.size());
+      for (const auto& pos : r->_coveragePositions) out.writePoint(pos);
     }
-    for(int i=0;i<unwalkablePolygon_amount;i++)
-    {
-      int id, polygon_size;
-      file_in >> id >> polygon_size;
-      for(int j=0;j<polygon_size;j++)
-      {
-        int x,y;
-        file_in >> x >> y;
-        unwalkablePolygons[i]->push_back(BWAPI::Position(x,y));
-      }
-      int hole_count;
-      file_in >> hole_count;
-      for(int j=0;j<hole_count;j++)
-      {
-        file_in >> polygon_size;
-        PolygonImpl h;
-        for(int k=0;k<polygon_size;k++)
-        {
-          int x,y;
-          file_in >> x >> y;
-          h.push_back(BWAPI::Position(x,y));
-        }
-		unwalkablePolygons[i]->addHole(h);
-      }
+    out.endSection();
+  }
+
+  static void writeChokepoints(CacheWriter& out, const std::map<Region*, int>& rid)
+  {
+    out.beginSection(CacheFile::CHOKEPOINTS);
+    out.writeInt(BWTA_Result::chokepoints.size());
+    for (const auto& c : BWTA_Result::chokepoints) {
+      out.writeInt(getId(rid, c->getRegions().first));
+      out.writeInt(getId(rid, c->getRegions().second));
+      out.writePoint(c->getSides().first);
+      out.writePoint(c->getSides().second);
+      out.writePoint(c->getCenter());
+      out.writeDouble(c->getWidth());
     }
-    for(int i=0;i<baselocation_amount;i++)
-    {
-      int id,px,py,tpx,tpy;
-      file_in >> id >> px >> py >> tpx >> tpy;
-      ((BaseLocationImpl*)baselocations[i])->position=BWAPI::Position(px,py);
-      ((BaseLocationImpl*)baselocations[i])->tilePosition=BWAPI::TilePosition(tpx,tpy);
-	  //LOG("Found Base Location at " << baselocations[i]->getTilePosition());
-      int rid;
-      file_in >> rid;
-      ((BaseLocationImpl*)baselocations[i])->region=regions[rid];
-      for(int j=0;j<baselocation_amount;j++)
-      {
-        double g_dist, a_dist;
-        file_in >> g_dist >> a_dist;
-        ((BaseLocationImpl*)baselocations[i])->groundDistances[baselocations[j]]=g_dist;
-        ((BaseLocationImpl*)baselocations[i])->airDistances[baselocations[j]]=a_dist;
+    out.endSection();
+  }
+
+  static void readRegions(SectionCursor& regionsIn, const std::vector<Chokepoint*>& chokepoints,
+    const std::vector<BaseLocation*>& baselocations)
+  {
+    const std::vector<Region*>& regions = BWTA_Result::regions;
+    for (auto region : regions) {
+      RegionImpl* r = static_cast<RegionImpl*>(region);
+      r->_label = regionsIn.readInt();
+      readPolygon(regionsIn, r->_polygon);
+      r->_center = regionsIn.readPoint<BWAPI::Position>();
+      r->_opennessPoint = regionsIn.readPoint<BWAPI::Position>();
+      r->_opennessDistance = regionsIn.readDouble();
+      r->_maxDistance = regionsIn.readInt();
+      r->_color = regionsIn.readInt();
+      r->_hue = regionsIn.readDouble();
+      readIds(regionsIn, r->_chokepoints, chokepoints);
+      readIds(regionsIn, r->baseLocations, baselocations);
+      readIds(regionsIn, r->reachableRegions, regions);
+      int coverage_amount = regionsIn.readCount(2 * sizeof(int32_t));
+      for (int j = 0; j < coverage_amount; ++j) {
+        r->_coveragePositions.push_back(regionsIn.readPoint<BWAPI::WalkPosition>());
       }
-      file_in >> ((BaseLocationImpl*)baselocations[i])->_isIsland;
-      file_in >> ((BaseLocationImpl*)baselocations[i])->_isStartLocation;
-      if (((BaseLocationImpl*)baselocations[i])->_isStartLocation)
-        BWTA::BWTA_Result::startlocations.insert(baselocations[i]);
     }
-    for(int i=0;i<chokepoint_amount;i++)
-    {
-      int id,rid1,rid2,s1x,s1y,s2x,s2y,cx,cy;
-      double width;
-      file_in >> id >> rid1 >> rid2 >> s1x >> s1y >> s2x >> s2y >> cx >> cy >> width;
-      ((ChokepointImpl*)chokepoints[i])->_regions.first=regions[rid1];
-      ((ChokepointImpl*)chokepoints[i])->_regions.second=regions[rid2];
-      ((ChokepointImpl*)chokepoints[i])->_sides.first=BWAPI::Position(s1x,s1y);
-      ((ChokepointImpl*)chokepoints[i])->_sides.second=BWAPI::Position(s2x,s2y);
-      ((ChokepointImpl*)chokepoints[i])->_center=BWAPI::Position(cx,cy);
-      ((ChokepointImpl*)chokepoints[i])->_width=width;
-    }
-    for(int i=0;i<region_amount;i++)
-    {
-      int id, polygon_size;
-      file_in >> id >> polygon_size;
-      for(int j=0;j<polygon_size;j++)
-      {
-        int x,y;
-        file_in >> x >> y;
-        ((RegionImpl*)regions[i])->_polygon.push_back(BWAPI::Position(x,y));
-      }
-      int cx,cy,chokepoints_size;
-      file_in >> cx >> cy >> chokepoints_size;
-      ((RegionImpl*)regions[i])->_center=BWAPI::Position(cx,cy);
-      for(int j=0;j<chokepoints_size;j++)
-      {
-        int cid;
-        file_in >> cid;
-        ((RegionImpl*)regions[i])->_chokepoints.insert(chokepoints[cid]);
-      }
-      int baselocations_size;
-      file_in >> baselocations_size;
-      for(int j=0;j<baselocations_size;j++)
-      {
-        int bid;
-        file_in >> bid;
-        ((RegionImpl*)regions[i])->baseLocations.insert(baselocations[bid]);
-      }
-      for(int j=0;j<region_amount;j++)
-      {
-        int connected=0;
-        file_in >> connected;
-        if (connected==1)
-          ((RegionImpl*)regions[i])->reachableRegions.insert(regions[j]);
-      }
+  }
+
+  static void readChokepoints(SectionCursor& chokepointsIn, const std::vector<Chokepoint*>& chokepoints)
+  {
+    const std::vector<Region*>& regions = BWTA_Result::regions;
+    for (auto chokepoint : chokepoints) {
+      ChokepointImpl* c = static_cast<ChokepointImpl*>(chokepoint);
+      c->_regions.first = getObject(regions, chokepointsIn.readInt());
+      c->_regions.second = getObject(regions, chokepointsIn.readInt());
+      c->_sides.first = chokepointsIn.readPoint<BWAPI::Position>();
+      c->_sides.second = chokepointsIn.readPoint<BWAPI::Position>();
+      c->_center = chokepointsIn.readPoint<BWAPI::Position>();
+      c->_width = chokepointsIn.readDouble();
     }
-    BWTA_Result::getRegion.resize(map_width,map_height);
-    BWTA_Result::getChokepoint.resize(map_width,map_height);
-    BWTA_Result::getBaseLocation.resize(map_width,map_height);
-    BWTA_Result::getUnwalkablePolygon.resize(map_width,map_height);
-    for(int x=0;x<map_width;x++)
-    {
-      for(int y=0;y<map_height;y++)
-      {
-        int rid;
-        file_in >> rid;
-        if (rid==-1)
-          BWTA_Result::getRegion[x][y]=NULL;
-        else
-          BWTA_Result::getRegion[x][y]=regions[rid];
-      }
+  }
+
+  static bool load_base_distances()
+  {
+    SectionCursor distancesIn = cacheReader.section(CacheFile::BASE_DISTANCES);
+    if (distancesIn.readCount(2 * sizeof(uint64_t)) != (int)cachedBaseLocations.size()) return false;
+    for (auto b1 : cachedBaseLocations) {
+      BaseLocationImpl* b = static_cast<BaseLocationImpl*>(b1);
+      for (auto b2 : cachedBaseLocations) b->groundDistances[b2] = distancesIn.readDouble();
+      for (auto b2 : cachedBaseLocations) b->airDistances[b2] = distancesIn.readDouble();
     }
-    for(int x=0;x<map_width;x++)
+    return distancesIn.ok();
+  }
+
+  namespace BWTA_Result
+  {
+    void materialize(LazyMember member)
     {
-      for(int y=0;y<map_height;y++)
-      {
-        int cid;
-        file_in >> cid;
-        if (cid==-1)
-          BWTA_Result::getChokepoint[x][y]=NULL;
-        else
-          BWTA_Result::getChokepoint[x][y]=chokepoints[cid];
+      std::lock_guard<std::mutex> lock(lazyMutex);
+      if (!pendingMembers[member].load(std::memory_order_relaxed)) return; // loaded by another thread
+
+      bool ok = false;
+      switch (member) {
+        case LAZY_CHOKEPOINT_W:
+          ok = cacheReader.readGrid(CacheFile::CHOKEPOINT_MAP_WALK, getChokepointW, cachedChokepoints);
+          break;
+        case LAZY_BASELOCATION_W:
+          ok = cacheReader.readGrid(CacheFile::BASELOCATION_MAP_WALK, getBaseLocationW, cachedBaseLocations);
+          break;
+        case LAZY_UNWALKABLE_POLYGON:
+          ok = cacheReader.readGrid(CacheFile::POLYGON_MAP, getUnwalkablePolygon, unwalkablePolygons);
+          break;
+        case LAZY_BASE_DISTANCES:
+          ok = load_base_distances();
+          break;
+        case LAZY_OBSTACLE_LABEL:
+          compactObstacleLabelMap.decode(obstacleLabelMap);
+          ok = !compactObstacleLabelMap.empty();
+          break;
+        case LAZY_CLOSEST_OBSTACLE_LABEL:
+          compactClosestObstacleLabelMap.decode(closestObstacleLabelMap);
+          ok = !compactClosestObstacleLabelMap.empty();
+          break;
+        case LAZY_SKELETON:
+          ok = load_skeleton(cacheReader);
+          break;
+        case LAZY_JUMP_TABLE:
+          ok = load_jump_table(cacheReader);
+          break;
+        case LAZY_LANDMARKS:
+          ok = load_landmarks(cacheReader);
+          break;
+        case LAZY_CONTRACTION_HIERARCHY:
+          ok = load_contraction_hierarchy(cacheReader);
+          break;
+        case LAZY_NAVMESH:
+          ok = load_navmesh(cacheReader);
+          break;
+        case LAZY_REGION_LABEL:
+          // the runs are kept, getRegion(WalkPosition) may still be reading them from another thread
+          compactRegionLabelMap.decode(regionLabelMap);
+          ok = !compactRegionLabelMap.empty();
+          break;
+        default:
+          break;
       }
+      // on failure the member keeps the empty values set by loadMap()
+      if (!ok) LOG("WARNING could not load section " << member << " from the cache file");
+      pendingMembers[member].store(false, std::memory_order_release);
     }
-    for(int x=0;x<map_width;x++)
+
+    void compressLabelMaps()
     {
-      for(int y=0;y<map_height;y++)
-      {
-        int bid;
-        file_in >> bid;
-        if (bid==-1)
-          BWTA_Result::getBaseLocation[x][y]=NULL;
-        else
-          BWTA_Result::getBaseLocation[x][y]=baselocations[bid];
-      }
+      std::lock_guard<std::mutex> lock(lazyMutex);
+      compactObstacleLabelMap.encode(obstacleLabelMap);
+      compactClosestObstacleLabelMap.encode(closestObstacleLabelMap);
+      compactRegionLabelMap.encode(regionLabelMap);
+      obstacleLabelMap.resize(1, 1);
+      closestObstacleLabelMap.resize(1, 1);
+      regionLabelMap.resize(1, 1);
+      pendingMembers[LAZY_OBSTACLE_LABEL].store(true, std::memory_order_release);
+      pendingMembers[LAZY_CLOSEST_OBSTACLE_LABEL].store(true, std::memory_order_release);
+      pendingMembers[LAZY_REGION_LABEL].store(true, std::memory_order_release);
     }
-    for(int x=0;x<map_width*4;x++)
+  }
+
+  void closeCacheFile()
+  {
     {
-      for(int y=0;y<map_height*4;y++)
-      {
-        int cid;
-        file_in >> cid;
-        if (cid==-1)
-          BWTA_Result::getChokepointW[x][y]=NULL;
-        else
-          BWTA_Result::getChokepointW[x][y]=chokepoints[cid];
-      }
+      std::lock_guard<std::mutex> lock(lazyMutex);
+      for (auto& pending : BWTA_Result::pendingMembers) pending.store(false);
+      cachedChokepoints.clear();
+      cachedBaseLocations.clear();
+      BWTA_Result::compactObstacleLabelMap.clear();
+      BWTA_Result::compactClosestObstacleLabelMap.clear();
+      BWTA_Result::compactRegionLabelMap.clear();
     }
-    for(int x=0;x<map_width*4;x++)
-    {
-      for(int y=0;y<map_height*4;y++)
-      {
-        int bid;
-        file_in >> bid;
-        if (bid==-1)
-          BWTA_Result::getBaseLocationW[x][y]=NULL;
-        else
-          BWTA_Result::getBaseLocationW[x][y]=baselocations[bid];
-      }
+    if (!cacheReader.isOpen()) return;
+    // release the label maps before unmapping the memory they point to
+    if (!BWTA_Result::regionLabelMap.isOwner()) BWTA_Result::regionLabelMap.resize(1, 1);
+    if (!BWTA_Result::obstacleLabelMap.isOwner()) BWTA_Result::obstacleLabelMap.resize(1, 1);
+    if (!BWTA_Result::closestObstacleLabelMap.isOwner()) BWTA_Result::closestObstacleLabelMap.resize(1, 1);
+    cacheReader.close();
+  }
+
+  static bool load_sections()
+  {
+    SectionCursor polygonsIn = cacheReader.section(CacheFile::POLYGONS);
+    SectionCursor regionsIn = cacheReader.section(CacheFile::REGIONS);
+    SectionCursor chokepointsIn = cacheReader.section(CacheFile::CHOKEPOINTS);
+    SectionCursor baselocationsIn = cacheReader.section(CacheFile::BASELOCATIONS);
+
+    // create all the objects first, since they reference each other by id
+    int unwalkablePolygon_amount = polygonsIn.readCount();
+    int region_amount = regionsIn.readCount();
+    int chokepoint_amount = chokepointsIn.readCount();
+    int baselocation_amount = baselocationsIn.readCount();
+    if (!polygonsIn.ok() || !regionsIn.ok() || !chokepointsIn.ok() || !baselocationsIn.ok()) return false;
+
+    std::vector<Chokepoint*>& chokepoints = cachedChokepoints;
+    std::vector<BaseLocation*>& baselocations = cachedBaseLocations;
+    for (int i = 0; i < unwalkablePolygon_amount; ++i) BWTA_Result::unwalkablePolygons.push_back(new PolygonImpl());
+    for (int i = 0; i < region_amount; ++i) BWTA_Result::regions.push_back(new RegionImpl());
+    for (int i = 0; i < chokepoint_amount; ++i) {
+      Chokepoint* c = new ChokepointImpl();
+      chokepoints.push_back(c);
+      BWTA_Result::chokepoints.insert(c);
     }
-    for(int x=0;x<map_width;x++)
-    {
-      for(int y=0;y<map_height;y++)
-      {
-        int pid;
-        file_in >> pid;
-        if (pid==-1)
-          BWTA_Result::getUnwalkablePolygon[x][y]=NULL;
-        else
-          BWTA_Result::getUnwalkablePolygon[x][y]=unwalkablePolygons[pid];
+    for (int i = 0; i < baselocation_amount; ++i) {
+      BaseLocation* b = new BaseLocationImpl();
+      baselocations.push_back(b);
+      BWTA_Result::baselocations.insert(b);
+    }
+    const std::vector<Region*>& regions = BWTA_Result::regions;
+
+    for (auto polygon : BWTA_Result::unwalkablePolygons) {
+      readPolygon(polygonsIn, *static_cast<PolygonImpl*>(polygon));
+    }
+
+    readRegions(regionsIn, chokepoints, baselocations);
+    readChokepoints(chokepointsIn, chokepoints);
+
+    for (auto baselocation : baselocations) {
+      BaseLocationImpl* b = static_cast<BaseLocationImpl*>(baselocation);
+      b->position = baselocationsIn.readPoint<BWAPI::Position>();
+      b->tilePosition = baselocationsIn.readPoint<BWAPI::TilePosition>();
+      b->region = getObject(regions, baselocationsIn.readInt());
+      b->_isIsland = baselocationsIn.readInt() != 0;
+      b->_isStartLocation = baselocationsIn.readInt() != 0;
+      int resource_amount = baselocationsIn.readCount(5 * sizeof(int32_t));
+      for (int j = 0; j < resource_amount; ++j) {
+        BWAPI::UnitType type(baselocationsIn.readInt());
+        BWAPI::TilePosition pos = baselocationsIn.readPoint<BWAPI::TilePosition>();
+        unsigned int amount = baselocationsIn.readInt();
+        b->resources.emplace_back(type, pos, amount);
+        b->resources.back().isBlocking = baselocationsIn.readInt() != 0;
       }
+      if (b->_isStartLocation) BWTA_Result::startlocations.insert(b);
     }
-    file_in.close();
+
+    if (!polygonsIn.ok() || !regionsIn.ok() || !chokepointsIn.ok() || !baselocationsIn.ok()) return false;
+
+    bool ok = cacheReader.readGrid(CacheFile::REGION_MAP, BWTA_Result::getRegion, regions)
+      && cacheReader.readGrid(CacheFile::CHOKEPOINT_MAP, BWTA_Result::getChokepoint, chokepoints)
+      && cacheReader.readGrid(CacheFile::BASELOCATION_MAP, BWTA_Result::getBaseLocation, baselocations);
+    if (!ok) return false;
+
+    if (BWTA_Result::compactLabelMaps) {
+      // keep the label maps as runs, the dense arrays are decoded on first access
+      ok = cacheReader.readCompactGrid(CacheFile::REGION_LABEL_MAP, BWTA_Result::compactRegionLabelMap)
+        && cacheReader.readCompactGrid(CacheFile::OBSTACLE_LABEL_MAP, BWTA_Result::compactObstacleLabelMap)
+        && cacheReader.readCompactGrid(CacheFile::CLOSEST_OBSTACLE_LABEL_MAP, BWTA_Result::compactClosestObstacleLabelMap);
+      if (!ok) return false;
+      BWTA_Result::regionLabelMap.resize(1, 1);
+      BWTA_Result::obstacleLabelMap.resize(1, 1);
+      BWTA_Result::closestObstacleLabelMap.resize(1, 1);
+      BWTA_Result::pendingMembers[BWTA_Result::LAZY_REGION_LABEL].store(true);
+      BWTA_Result::pendingMembers[BWTA_Result::LAZY_OBSTACLE_LABEL].store(true);
+      BWTA_Result::pendingMembers[BWTA_Result::LAZY_CLOSEST_OBSTACLE_LABEL].store(true);
+    } else {
+      ok = cacheReader.attachGrid(CacheFile::REGION_LABEL_MAP, BWTA_Result::regionLabelMap)
+        && cacheReader.attachGrid(CacheFile::OBSTACLE_LABEL_MAP, BWTA_Result::obstacleLabelMap)
+        && cacheReader.attachGrid(CacheFile::CLOSEST_OBSTACLE_LABEL_MAP, BWTA_Result::closestObstacleLabelMap);
+      if (!ok) return false;
+    }
+
+    // walk resolution closest-object maps, the polygon map and the distances between base locations
+    // are rarely needed at startup, they are read from the mapping the first time they are accessed
+    BWTA_Result::pendingMembers[BWTA_Result::LAZY_CHOKEPOINT_W].store(cacheReader.hasSection(CacheFile::CHOKEPOINT_MAP_WALK));
+    BWTA_Result::pendingMembers[BWTA_Result::LAZY_BASELOCATION_W].store(cacheReader.hasSection(CacheFile::BASELOCATION_MAP_WALK));
+    BWTA_Result::pendingMembers[BWTA_Result::LAZY_UNWALKABLE_POLYGON].store(cacheReader.hasSection(CacheFile::POLYGON_MAP));
+    BWTA_Result::pendingMembers[BWTA_Result::LAZY_BASE_DISTANCES].store(cacheReader.hasSection(CacheFile::BASE_DISTANCES));
+    BWTA_Result::pendingMembers[BWTA_Result::LAZY_SKELETON].store(cacheReader.hasSection(CacheFile::SKELETON));
+    BWTA_Result::pendingMembers[BWTA_Result::LAZY_JUMP_TABLE].store(cacheReader.hasSection(CacheFile::JUMP_TABLE));
+    BWTA_Result::pendingMembers[BWTA_Result::LAZY_LANDMARKS].store(cacheReader.hasSection(CacheFile::LANDMARKS));
+    BWTA_Result::pendingMembers[BWTA_Result::LAZY_CONTRACTION_HIERARCHY].store(cacheReader.hasSection(CacheFile::CONTRACTION_HIERARCHY));
+    BWTA_Result::pendingMembers[BWTA_Result::LAZY_NAVMESH].store(cacheReader.hasSection(CacheFile::NAVMESH));
+    return true;
   }
 
-  void save_data(std::string filename)
+  void save_regions(CacheWriter& out)
   {
-    std::map<Polygon*,int> pid;
-    std::map<BaseLocation*,int> bid;
-    std::map<Chokepoint*,int> cid;
-    std::map<Region*,int> rid;
-    int p_id=0;
-    int b_id=0;
-    int c_id=0;
-    int r_id=0;
-    for(auto p=BWTA_Result::unwalkablePolygons.begin();p!=BWTA_Result::unwalkablePolygons.end();p++)
-    {
-      pid[*p]=p_id++;
+    std::map<BaseLocation*, int> bid;
+    std::map<Chokepoint*, int> cid;
+    std::map<Region*, int> rid;
+    for (const auto& c : BWTA_Result::chokepoints) cid.insert(std::make_pair(c, (int)cid.size()));
+    for (const auto& r : BWTA_Result::regions) rid.insert(std::make_pair(r, (int)rid.size()));
+    writeRegions(out, rid, cid, bid);
+    writeChokepoints(out, rid);
+  }
+
+  bool load_regions(const CacheReader& in)
+  {
+    SectionCursor regionsIn = in.section(CacheFile::REGIONS);
+    SectionCursor chokepointsIn = in.section(CacheFile::CHOKEPOINTS);
+    int region_amount = regionsIn.readCount();
+    int chokepoint_amount = chokepointsIn.readCount();
+    if (!regionsIn.ok() || !chokepointsIn.ok()) return false;
+
+    std::vector<Chokepoint*> chokepoints;
+    std::vector<BaseLocation*> baselocations;
+    for (int i = 0; i < region_amount; ++i) BWTA_Result::regions.push_back(new RegionImpl());
+    for (int i = 0; i < chokepoint_amount; ++i) {
+      chokepoints.push_back(new ChokepointImpl());
+      BWTA_Result::chokepoints.insert(chokepoints.back());
     }
-    for(std::set<BaseLocation*>::const_iterator b=BWTA_Result::baselocations.begin();b!=BWTA_Result::baselocations.end();b++)
-    {
-      bid[*b]=b_id++;
+    readRegions(regionsIn, chokepoints, baselocations);
+    readChokepoints(chokepointsIn, chokepoints);
+    if (regionsIn.ok() && chokepointsIn.ok()) return true;
+
+    for (auto r : BWTA_Result::regions) delete r;
+    BWTA_Result::regions.clear();
+    for (auto c : BWTA_Result::chokepoints) delete c;
+    BWTA_Result::chokepoints.clear();
+    return false;
+  }
+
+  void save_skeleton(CacheWriter& out)
+  {
+    const Skeleton& skeleton = BWTA_Result::skeleton;
+    out.beginSection(CacheFile::SKELETON);
+    out.writeInt(skeleton.size());
+    for (int i = 0; i < skeleton.size(); ++i) {
+      out.writePoint(skeleton.getPosition(i));
+      out.writeDouble(skeleton.getClearance(i));
+      out.writeInt(skeleton.getType(i));
     }
-    for(std::set<Chokepoint*>::const_iterator c=BWTA_Result::chokepoints.begin();c!=BWTA_Result::chokepoints.end();c++)
-    {
-      cid[*c]=c_id++;
-    }
-	for (auto& r : BWTA_Result::regions) rid[r] = r_id++;
-    std::ofstream file_out;
-    file_out.open(filename.c_str());
-    int file_version=BWTA_FILE_VERSION;
-    file_out << file_version << "\n";
-    file_out << BWTA_Result::unwalkablePolygons.size() << "\n";
-    file_out << BWTA_Result::baselocations.size() << "\n";
-    file_out << BWTA_Result::chokepoints.size() << "\n";
-    file_out << BWTA_Result::regions.size() << "\n";
-    file_out << BWTA_Result::getRegion.getWidth() << "\n";
-    file_out << BWTA_Result::getRegion.getHeight() << "\n";
-    for(auto p=BWTA_Result::unwalkablePolygons.begin();p!=BWTA_Result::unwalkablePolygons.end();p++)
-    {
-      file_out << pid[*p] << "\n";
-      file_out << (*p)->size() << "\n";
-      for(unsigned int i=0;i<(*p)->size();i++)
-      {
-        file_out << (**p)[i].x << "\n";
-        file_out << (**p)[i].y << "\n";
-      }
-      file_out << (*p)->getHoles().size() << "\n";
-	  for (const auto& h : (*p)->getHoles()) {
-        file_out << h->size() << "\n";
-        for(unsigned int i=0;i<h->size();i++)
-        {
-          file_out << h->at(i).x << "\n";
-          file_out << h->at(i).y << "\n";
-        }
-      }
+    out.writeInt(skeleton.getAdjacency().size());
+    for (const auto& start : skeleton.getAdjacencyStart()) out.writeInt(start);
+    for (const auto& neighbor : skeleton.getAdjacency()) out.writeInt(neighbor);
+    out.endSection();
+  }
+
+  bool load_skeleton(const CacheReader& in)
+  {
+    SectionCursor skeletonIn = in.section(CacheFile::SKELETON);
+    int node_amount = skeletonIn.readCount(3 * sizeof(int32_t) + sizeof(double));
+    std::vector<BWAPI::WalkPosition> positions;
+    std::vector<double> clearances;
+    std::vector<Skeleton::NodeType> types;
+    for (int i = 0; i < node_amount; ++i) {
+      positions.push_back(skeletonIn.readPoint<BWAPI::WalkPosition>());
+      clearances.push_back(skeletonIn.readDouble());
+      int type = skeletonIn.readInt();
+      if (type < Skeleton::NONE || type > Skeleton::CHOKEPOINT) return false;
+      types.push_back(static_cast<Skeleton::NodeType>(type));
     }
-    for(std::set<BaseLocation*>::const_iterator b=BWTA_Result::baselocations.begin();b!=BWTA_Result::baselocations.end();b++)
-    {
-      file_out << bid[*b] << "\n";
-      file_out << (*b)->getPosition().x << "\n";
-      file_out << (*b)->getPosition().y << "\n";
-      file_out << (*b)->getTilePosition().x << "\n";
-      file_out << (*b)->getTilePosition().y << "\n";
-      file_out << rid[(*b)->getRegion()] << "\n";
-      for(std::set<BaseLocation*>::const_iterator b2=BWTA_Result::baselocations.begin();b2!=BWTA_Result::baselocations.end();b2++)
-      {
-        file_out << (*b)->getGroundDistance(*b2) << "\n";
-        file_out << (*b)->getAirDistance(*b2) << "\n";
-      }
-      file_out << (*b)->isIsland() << "\n";
-      file_out << (*b)->isStartLocation() << "\n";
+    int adjacency_amount = skeletonIn.readCount();
+    if (!skeletonIn.ok()) return false;
+    // the node positions are used to bucket them, they must be inside the map
+    for (const auto& pos : positions) {
+      if (pos.x < 0 || pos.y < 0 || pos.x >= MapData::mapWidthWalkRes || pos.y >= MapData::mapHeightWalkRes) return false;
     }
-    for(std::set<Chokepoint*>::const_iterator c=BWTA_Result::chokepoints.begin();c!=BWTA_Result::chokepoints.end();c++)
-    {
-      file_out << cid[*c] << "\n";
-      file_out << rid[(*c)->getRegions().first] << "\n";
-      file_out << rid[(*c)->getRegions().second] << "\n";
-      file_out << (*c)->getSides().first.x << "\n";
-      file_out << (*c)->getSides().first.y << "\n";
-      file_out << (*c)->getSides().second.x << "\n";
-      file_out << (*c)->getSides().second.y << "\n";
-      file_out << (*c)->getCenter().x << "\n";
-      file_out << (*c)->getCenter().y << "\n";
-      file_out << (*c)->getWidth() << "\n";
-    }
-	for (const auto& r : BWTA_Result::regions) {
-      file_out << rid[r] << "\n";
-      PolygonImpl poly = r->getPolygon();
-      file_out << poly.size() << "\n";
-      for(unsigned int i=0;i<poly.size();i++)
-      {
-        file_out << poly[i].x << "\n";
-        file_out << poly[i].y << "\n";
-      }
-      file_out << r->getCenter().x << "\n";
-      file_out << r->getCenter().y << "\n";
-      file_out << r->getChokepoints().size() << "\n";
-      for(std::set<Chokepoint*>::const_iterator c=r->getChokepoints().begin();c!=r->getChokepoints().end();c++)
-      {
-        file_out << cid[*c] << "\n";
-      }
-      file_out << r->getBaseLocations().size() << "\n";
-      for(std::set<BaseLocation*>::const_iterator b=r->getBaseLocations().begin();b!=r->getBaseLocations().end();b++)
-      {
-        file_out << bid[*b] << "\n";
-      }
-	  for (const auto& r2 : BWTA_Result::regions) {
-		  int connected = 0;
-		  if (r->isReachable(r2)) connected = 1;
-		  file_out << connected << "\n";
-      }
+
+    std::vector<int> adjacencyStart(node_amount + 1);
+    std::vector<int> adjacency(adjacency_amount);
+    for (auto& start : adjacencyStart) start = skeletonIn.readInt();
+    for (auto& neighbor : adjacency) {
+      neighbor = skeletonIn.readInt();
+      if (neighbor < 0 || neighbor >= node_amount) return false;
     }
-    for(int x=0;x<(int)BWTA_Result::getRegion.getWidth();x++)
-    {
-      for(int y=0;y<(int)BWTA_Result::getRegion.getHeight();y++)
-      {
-        if (BWTA_Result::getRegion[x][y]==NULL)
-          file_out << "-1\n";
-        else
-          file_out << rid[BWTA_Result::getRegion[x][y]] << "\n";
-      }
+    if (!skeletonIn.ok() || adjacencyStart.front() != 0 || adjacencyStart.back() != adjacency_amount) return false;
+    for (int i = 0; i < node_amount; ++i) {
+      if (adjacencyStart[i] > adjacencyStart[i + 1]) return false;
     }
-    for(int x=0;x<(int)BWTA_Result::getChokepoint.getWidth();x++)
-    {
-      for(int y=0;y<(int)BWTA_Result::getChokepoint.getHeight();y++)
-      {
-        if (BWTA_Result::getChokepoint[x][y]==NULL)
-          file_out << "-1\n";
-        else
-          file_out << cid[BWTA_Result::getChokepoint[x][y]] << "\n";
-      }
+
+    BWTA_Result::skeleton.assign(positions, clearances, types, adjacencyStart, adjacency);
+    return true;
+  }
+
+  void save_jump_table(CacheWriter& out)
+  {
+    const JumpTable& table = BWTA_Result::jumpTable;
+    out.beginSection(CacheFile::JUMP_TABLE);
+    out.writeInt(table.getWidth());
+    out.writeInt(table.getHeight());
+    // little-endian int16 values
+    std::vector<unsigned char> bytes;
+    bytes.reserve(table.getDistances().size() * 2);
+    for (const auto& distance : table.getDistances()) {
+      bytes.push_back(static_cast<unsigned char>(distance & 0xFF));
+      bytes.push_back(static_cast<unsigned char>((distance >> 8) & 0xFF));
     }
-    for(int x=0;x<(int)BWTA_Result::getBaseLocation.getWidth();x++)
-    {
-      for(int y=0;y<(int)BWTA_Result::getBaseLocation.getHeight();y++)
-      {
-        if (BWTA_Result::getBaseLocation[x][y]==NULL)
-          file_out << "-1\n";
-        else
-          file_out << bid[BWTA_Result::getBaseLocation[x][y]] << "\n";
-      }
+    out.writeBytes(bytes.data(), bytes.size());
+    out.endSection();
+  }
+
+  bool load_jump_table(const CacheReader& in)
+  {
+    SectionCursor tableIn = in.section(CacheFile::JUMP_TABLE);
+    int width = tableIn.readInt();
+    int height = tableIn.readInt();
+    if (!tableIn.ok() || width != MapData::mapWidthTileRes || height != MapData::mapHeightTileRes) return false;
+    size_t count = (size_t)width * height * JUMP_DIRECTION_COUNT;
+    const unsigned char* p = tableIn.position();
+    tableIn.skip(count * 2);
+    if (!tableIn.ok()) return false;
+
+    std::vector<int16_t> distances(count);
+    for (size_t i = 0; i < count; ++i) distances[i] = static_cast<int16_t>(p[2 * i] | (p[2 * i + 1] << 8));
+    BWTA_Result::jumpTable.assign(width, height, distances);
+    return true;
+  }
+
+  void save_landmarks(CacheWriter& out)
+  {
+    const LandmarkTable& table = BWTA_Result::landmarks;
+    out.beginSection(CacheFile::LANDMARKS);
+    out.writeInt(table.getWidth());
+    out.writeInt(table.getHeight());
+    out.writeInt(table.getLandmarkCount());
+    // little-endian uint16 values
+    std::vector<unsigned char> bytes;
+    bytes.reserve(table.getDistances().size() * 2);
+    for (const auto& distance : table.getDistances()) {
+      bytes.push_back(static_cast<unsigned char>(distance & 0xFF));
+      bytes.push_back(static_cast<unsigned char>((distance >> 8) & 0xFF));
     }
-    for(int x=0;x<(int)BWTA_Result::getChokepointW.getWidth();x++)
-    {
-      for(int y=0;y<(int)BWTA_Result::getChokepointW.getHeight();y++)
-      {
-        if (BWTA_Result::getChokepointW[x][y]==NULL)
-          file_out << "-1\n";
-        else
-          file_out << cid[BWTA_Result::getChokepointW[x][y]] << "\n";
-      }
+    out.writeBytes(bytes.data(), bytes.size());
+    out.endSection();
+  }
+
+  bool load_landmarks(const CacheReader& in)
+  {
+    SectionCursor tableIn = in.section(CacheFile::LANDMARKS);
+    int width = tableIn.readInt();
+    int height = tableIn.readInt();
+    int landmarkCount = tableIn.readInt();
+    if (!tableIn.ok() || width != MapData::mapWidthTileRes || height != MapData::mapHeightTileRes) return false;
+    if (landmarkCount < 0 || landmarkCount > LandmarkTable::MAX_LANDMARKS) return false;
+    size_t count = (size_t)landmarkCount * width * height;
+    const unsigned char* p = tableIn.position();
+    tableIn.skip(count * 2);
+    if (!tableIn.ok()) return false;
+
+    std::vector<uint16_t> distances(count);
+    for (size_t i = 0; i < count; ++i) distances[i] = static_cast<uint16_t>(p[2 * i] | (p[2 * i + 1] << 8));
+    BWTA_Result::landmarks.assign(width, height, landmarkCount, distances);
+    return true;
+  }
+
+  void save_contraction_hierarchy(CacheWriter& out)
+  {
+    const ContractionHierarchy& hierarchy = BWTA_Result::contractionHierarchy;
+    if (hierarchy.empty()) return; // not enabled for this analysis
+    out.beginSection(CacheFile::CONTRACTION_HIERARCHY);
+    out.writeInt(hierarchy.getWidth());
+    out.writeInt(hierarchy.getHeight());
+    out.writeInt(hierarchy.getEdgeTarget().size());
+    for (const auto& first : hierarchy.getFirstEdge()) out.writeInt(first);
+    for (const auto& target : hierarchy.getEdgeTarget()) out.writeInt(target);
+    for (const auto& cost : hierarchy.getEdgeCost()) out.writeInt(cost);
+    out.endSection();
+  }
+
+  bool load_contraction_hierarchy(const CacheReader& in)
+  {
+    SectionCursor hierarchyIn = in.section(CacheFile::CONTRACTION_HIERARCHY);
+    int width = hierarchyIn.readInt();
+    int height = hierarchyIn.readInt();
+    int edge_amount = hierarchyIn.readCount(2 * sizeof(int32_t));
+    if (!hierarchyIn.ok() || width != MapData::mapWidthTileRes || height != MapData::mapHeightTileRes) return false;
+    const int node_amount = width * height;
+
+    std::vector<int> firstEdge(node_amount + 1);
+    std::vector<int> edgeTarget(edge_amount);
+    std::vector<int> edgeCost(edge_amount);
+    for (auto& first : firstEdge) first = hierarchyIn.readInt();
+    for (auto& target : edgeTarget) {
+      target = hierarchyIn.readInt();
+      if (target < 0 || target >= node_amount) return false;
     }
-    for(int x=0;x<(int)BWTA_Result::getBaseLocationW.getWidth();x++)
-    {
-      for(int y=0;y<(int)BWTA_Result::getBaseLocationW.getHeight();y++)
-      {
-        if (BWTA_Result::getBaseLocationW[x][y]==NULL)
-          file_out << "-1\n";
-        else
-          file_out << bid[BWTA_Result::getBaseLocationW[x][y]] << "\n";
-      }
+    for (auto& cost : edgeCost) {
+      cost = hierarchyIn.readInt();
+      if (cost <= 0) return false;
     }
-    for(int x=0;x<(int)BWTA_Result::getRegion.getWidth();x++)
-    {
-      for(int y=0;y<(int)BWTA_Result::getRegion.getHeight();y++)
-      {
-        if (BWTA_Result::getUnwalkablePolygon[x][y]==NULL)
-          file_out << "-1\n";
-        else
-          file_out << pid[BWTA_Result::getUnwalkablePolygon[x][y]] << "\n";
+    if (!hierarchyIn.ok() || firstEdge.front() != 0 || firstEdge.back() != edge_amount) return false;
+    for (int i = 0; i < node_amount; ++i) {
+      if (firstEdge[i] > firstEdge[i + 1]) return false;
+    }
+
+    BWTA_Result::contractionHierarchy.assign(width, height, firstEdge, edgeTarget, edgeCost);
+    return true;
+  }
+
+  void save_navmesh(CacheWriter& out)
+  {
+    const NavMesh& mesh = BWTA_Result::navMesh;
+    if (mesh.empty()) return;
+    out.beginSection(CacheFile::NAVMESH);
+    out.writeInt(mesh.getTileWidth());
+    out.writeInt(mesh.getTileHeight());
+    out.writeInt(mesh.getVertices().size());
+    for (const auto& vertex : mesh.getVertices()) out.writePoint(vertex);
+    out.writeInt(mesh.getCorners().size());
+    for (const auto& corner : mesh.getCorners()) out.writeInt(corner);
+    out.endSection();
+  }
+
+  bool load_navmesh(const CacheReader& in)
+  {
+    SectionCursor meshIn = in.section(CacheFile::NAVMESH);
+    int width = meshIn.readInt();
+    int height = meshIn.readInt();
+    if (!meshIn.ok() || width != MapData::mapWidthTileRes || height != MapData::mapHeightTileRes) return false;
+    int vertex_amount = meshIn.readCount(2 * sizeof(int32_t));
+    std::vector<BWAPI::Position> vertices(vertex_amount);
+    for (auto& vertex : vertices) vertex = meshIn.readPoint<BWAPI::Position>();
+    int corner_amount = meshIn.readCount();
+    if (!meshIn.ok() || corner_amount % 3 != 0) return false;
+    std::vector<int> corners(corner_amount);
+    for (auto& corner : corners) {
+      corner = meshIn.readInt();
+      if (corner < 0 || corner >= vertex_amount) return false;
+    }
+    if (!meshIn.ok()) return false;
+
+    BWTA_Result::navMesh.assign(width, height, vertices, corners);
+    return true;
+  }
+
+  bool load_data(std::string filename)
+  {
+    closeCacheFile();
+    if (!cacheReader.open(filename, BWTA_FILE_VERSION)) return false;
+
+    if (cacheReader.getWidth() != MapData::mapWidthTileRes || cacheReader.getHeight() != MapData::mapHeightTileRes) {
+      LOG("WARNING cache file " << filename << " has a different map size");
+      closeCacheFile();
+      return false;
+    }
+
+    if (!load_sections()) {
+      LOG("WARNING cache file " << filename << " is corrupted");
+      clearResults();
+      closeCacheFile();
+      loadMap(); // restore the default (empty) result maps
+      return false;
+    }
+    return true;
+  }
+
+  bool save_data(std::string filename)
+  {
+    for (int member = 0; member < BWTA_Result::LAZY_MEMBER_COUNT; ++member) {
+      BWTA_Result::require(static_cast<BWTA_Result::LazyMember>(member));
+    }
+
+    std::map<Polygon*, int> pid;
+    std::map<BaseLocation*, int> bid;
+    std::map<Chokepoint*, int> cid;
+    std::map<Region*, int> rid;
+    for (const auto& p : BWTA_Result::unwalkablePolygons) pid.insert(std::make_pair(p, (int)pid.size()));
+    for (const auto& b : BWTA_Result::baselocations) bid.insert(std::make_pair(b, (int)bid.size()));
+    for (const auto& c : BWTA_Result::chokepoints) cid.insert(std::make_pair(c, (int)cid.size()));
+    for (const auto& r : BWTA_Result::regions) rid.insert(std::make_pair(r, (int)rid.size()));
+
+    CacheWriter out;
+
+    out.beginSection(CacheFile::POLYGONS);
+    out.writeInt(BWTA_Result::unwalkablePolygons.size());
+    for (const auto& p : BWTA_Result::unwalkablePolygons) writePolygon(out, *p);
+    out.endSection();
+
+    writeRegions(out, rid, cid, bid);
+    writeChokepoints(out, rid);
+    save_skeleton(out);
+    save_jump_table(out);
+    save_landmarks(out);
+    save_contraction_hierarchy(out);
+    save_navmesh(out);
+
+    out.beginSection(CacheFile::BASELOCATIONS);
+    out.writeInt(BWTA_Result::baselocations.size());
+    for (const auto& base : BWTA_Result::baselocations) {
+      const BaseLocationImpl* b = static_cast<const BaseLocationImpl*>(base);
+      out.writePoint(b->position);
+      out.writePoint(b->tilePosition);
+      out.writeInt(getId(rid, b->region));
+      out.writeInt(b->_isIsland ? 1 : 0);
+      out.writeInt(b->_isStartLocation ? 1 : 0);
+      out.writeInt(b->resources.size());
+      for (const auto& resource : b->resources) {
+        out.writeInt(resource.type.getID());
+        out.writePoint(resource.pos);
+        out.writeInt(resource.amount);
+        out.writeInt(resource.isBlocking ? 1 : 0);
       }
     }
-    file_out.close();
+    out.endSection();
+
+    out.beginSection(CacheFile::BASE_DISTANCES);
+    out.writeInt(BWTA_Result::baselocations.size());
+    for (const auto& b1 : BWTA_Result::baselocations) {
+      for (const auto& b2 : BWTA_Result::baselocations) out.writeDouble(b1->getGroundDistance(b2));
+      for (const auto& b2 : BWTA_Result::baselocations) out.writeDouble(b1->getAirDistance(b2));
+    }
+    out.endSection();
+
+    // grids are run-length encoded whenever that is smaller than the raw values, except the label
+    // maps: kept raw they are attached to the file mapping on load, only the compact mode wants runs
+    out.writeGridSection(CacheFile::REGION_MAP, BWTA_Result::getRegion, rid);
+    out.writeGridSection(CacheFile::CHOKEPOINT_MAP, BWTA_Result::getChokepoint, cid);
+    out.writeGridSection(CacheFile::BASELOCATION_MAP, BWTA_Result::getBaseLocation, bid);
+    out.writeGridSection(CacheFile::CHOKEPOINT_MAP_WALK, BWTA_Result::getChokepointW, cid);
+    out.writeGridSection(CacheFile::BASELOCATION_MAP_WALK, BWTA_Result::getBaseLocationW, bid);
+    out.writeGridSection(CacheFile::POLYGON_MAP, BWTA_Result::getUnwalkablePolygon, pid);
+    out.writeGridSection(CacheFile::REGION_LABEL_MAP, BWTA_Result::regionLabelMap, BWTA_Result::compactLabelMaps);
+    out.writeGridSection(CacheFile::OBSTACLE_LABEL_MAP, BWTA_Result::obstacleLabelMap, BWTA_Result::compactLabelMaps);
+    out.writeGridSection(CacheFile::CLOSEST_OBSTACLE_LABEL_MAP, BWTA_Result::closestObstacleLabelMap, BWTA_Result::compactLabelMaps);
+
+    return out.save(filename, BWTA_FILE_VERSION, MapData::mapWidthTileRes, MapData::mapHeightTileRes);
   }
-}
\ No newline at end of file
+}
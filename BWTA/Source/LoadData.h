@@ -7,11 +7,29 @@
 #include "ChokepointImpl.h"
 #include "RegionImpl.h"
 #include "PolygonImpl.h"
+#include "CacheFile.h"
 
 namespace BWTA
 {
   void loadMapFromBWAPI();
   void loadMap();
-  void load_data(std::string filename);
-  void save_data(std::string filename);
+  // binary cache (see CacheFile.h), load_data returns false if the file is missing or invalid
+  bool load_data(std::string filename);
+  bool save_data(std::string filename);
+  void closeCacheFile();
+  // cleanMemory() without waiting for the analysis, for the analysis itself (it may run on the worker)
+  void clearResults();
+  // only the regions and chokepoints, used by the analysis checkpoints (see StageCache.h)
+  void save_regions(CacheWriter& out);
+  bool load_regions(const CacheReader& in);
+  void save_skeleton(CacheWriter& out);
+  bool load_skeleton(const CacheReader& in);
+  void save_jump_table(CacheWriter& out);
+  bool load_jump_table(const CacheReader& in);
+  void save_landmarks(CacheWriter& out);
+  bool load_landmarks(const CacheReader& in);
+  void save_contraction_hierarchy(CacheWriter& out);
+  bool load_contraction_hierarchy(const CacheReader& in);
+  void save_navmesh(CacheWriter& out);
+  bool load_navmesh(const CacheReader& in);
 }
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "LpaSearch.h"
+
+namespace BWTA
+{
+	static const int INFINITE_COST = std::numeric_limits<int>::max() / 2;
+
+	LpaSearch::LpaSearch(BWAPI::TilePosition start, BWAPI::TilePosition target)
+		: _width(MapData::mapWidthTileRes), _height(MapData::mapHeightTileRes), _start(-1), _target(-1)
+	{
+		const size_t size = static_cast<size_t>(_width) * _height;
+		_g.assign(size, INFINITE_COST);
+		_rhs.assign(size, INFINITE_COST);
+		_inOpen.assign(size, 0);
+		_open.resize(size);
+		_inside = isInside(start) && (target == BWAPI::TilePositions::None || isInside(target));
+		if (_inside) {
+			_start = start.x * _height + start.y;
+			if (target != BWAPI::TilePositions::None) _target = target.x * _height + target.y;
+			_rhs[_start] = 0;
+			_open.push(_start, calculateKey(_start));
+			_inOpen[_start] = 1;
+		}
+		getObstacleOverlay().addListener(this);
+	}
+
+	LpaSearch::~LpaSearch()
+	{
+		getObstacleOverlay().removeListener(this);
+	}
+
+	bool LpaSearch::isInside(BWAPI::TilePosition tile) const
+	{
+		return tile.x >= 0 && tile.y >= 0 && tile.x < _width && tile.y < _height;
+	}
+
+	// cost of the move, INFINITE_COST if gridSearch would not take it
+	int LpaSearch::edgeCost(int fromX, int fromY, int toX, int toY) const
+	{
+		const RectangleArray<bool>& walkable = MapData::lowResWalkability;
+		if (!walkable[toX][toY]) return INFINITE_COST;
+		// only the start is expanded while unwalkable
+		if (!walkable[fromX][fromY] && fromX * _height + fromY != _start) return INFINITE_COST;
+		if (fromX == toX || fromY == toY) return 10;
+		if (!walkable[fromX][toY] && !walkable[toX][fromY]) return INFINITE_COST;
+		return 14;
+	}
+
+	// [min(g, rhs) + h, min(g, rhs)] compared lexicographically
+	int64_t LpaSearch::calculateKey(int node) const
+	{
+		const int cost = std::min(_g[node], _rhs[node]);
+		int heuristic = 0;
+		if (_target != -1) heuristic = octileDistance(node / _height - _target / _height, node % _height - _target % _height);
+		return (static_cast<int64_t>(cost + heuristic) << 32) | cost;
+	}
+
+	void LpaSearch::updateVertex(int node)
+	{
+		const int x = node / _height;
+		const int y = node % _height;
+		if (node != _start) {
+			int rhs = INFINITE_COST;
+			for (int px = std::max(x - 1, 0); px <= std::min(x + 1, _width - 1); ++px) {
+				for (int py = std::max(y - 1, 0); py <= std::min(y + 1, _height - 1); ++py) {
+					const int g = _g[px * _height + py];
+					if (g == INFINITE_COST || (px == x && py == y)) continue;
+					rhs = std::min(rhs, g + edgeCost(px, py, x, y));
+				}
+			}
+			_rhs[node] = std::min(rhs, INFINITE_COST);
+		}
+		updateOpen(node);
+	}
+
+	// in the open list while locally inconsistent
+	void LpaSearch::updateOpen(int node)
+	{
+		if (_g[node] != _rhs[node]) {
+			if (_inOpen[node]) {
+				_open.update(node, calculateKey(node));
+			} else {
+				_open.push(node, calculateKey(node));
+				_inOpen[node] = 1;
+			}
+		} else if (_inOpen[node]) {
+			_open.remove(node);
+			_inOpen[node] = 0;
+		}
+	}
+
+	void LpaSearch::computeShortestPath()
+	{
+		while (!_open.empty()) {
+			if (_target != -1 && _rhs[_target] == _g[_target] && _open.topKey() >= calculateKey(_target)) break;
+			const int node = _open.topNode();
+			const int x = node / _height;
+			const int y = node % _height;
+			const int minX = std::max(x - 1, 0);
+			const int maxX = std::min(x + 1, _width - 1);
+			const int minY = std::max(y - 1, 0);
+			const int maxY = std::min(y + 1, _height - 1);
+			if (_g[node] > _rhs[node]) {
+				// overconsistent: settle it and relax its neighbors
+				_g[node] = _rhs[node];
+				_open.pop();
+				_inOpen[node] = 0;
+				for (int nx = minX; nx <= maxX; ++nx) {
+					for (int ny = minY; ny <= maxY; ++ny) {
+						const int next = nx * _height + ny;
+						if (next == node || next == _start) continue;
+						const int cost = _g[node] + edgeCost(x, y, nx, ny);
+						if (cost >= _rhs[next]) continue;
+						_rhs[next] = cost;
+						updateOpen(next);
+					}
+				}
+			} else {
+				// underconsistent: its cost went up, so do the costs that went through it
+				_g[node] = INFINITE_COST;
+				for (int nx = minX; nx <= maxX; ++nx) {
+					for (int ny = minY; ny <= maxY; ++ny) updateVertex(nx * _height + ny);
+				}
+			}
+		}
+	}
+
+	void LpaSearch::onTilesChanged(const std::vector<BWAPI::TilePosition>& tiles)
+	{
+		if (!_inside || _width != MapData::mapWidthTileRes || _height != MapData::mapHeightTileRes) return;
+		// the moves into, out of and around (diagonals) a tile all end on it or on one of its neighbors
+		for (const auto& tile : tiles) {
+			for (int x = std::max(tile.x - 1, 0); x <= std::min(tile.x + 1, _width - 1); ++x) {
+				for (int y = std::max(tile.y - 1, 0); y <= std::min(tile.y + 1, _height - 1); ++y) updateVertex(x * _height + y);
+			}
+		}
+	}
+
+	int LpaSearch::getCost(BWAPI::TilePosition tile)
+	{
+		if (!_inside || !isInside(tile) || _width != MapData::mapWidthTileRes || _height != MapData::mapHeightTileRes) return -1;
+		computeShortestPath();
+		const int cost = _g[tile.x * _height + tile.y];
+		return cost == INFINITE_COST ? -1 : cost;
+	}
+
+	std::vector<BWAPI::TilePosition> LpaSearch::getPath(BWAPI::TilePosition tile)
+	{
+		std::vector<BWAPI::TilePosition> path;
+		if (getCost(tile) == -1) return path;
+
+		// back from tile, each time to the neighbor the cost came from
+		int node = tile.x * _height + tile.y;
+		path.push_back(tile);
+		while (node != _start && path.size() <= _g.size()) {
+			const int x = node / _height;
+			const int y = node % _height;
+			int best = -1;
+			int bestCost = INFINITE_COST;
+			for (int px = std::max(x - 1, 0); px <= std::min(x + 1, _width - 1); ++px) {
+				for (int py = std::max(y - 1, 0); py <= std::min(y + 1, _height - 1); ++py) {
+					const int previous = px * _height + py;
+					if (previous == node || _g[previous] == INFINITE_COST) continue;
+					const int cost = _g[previous] + edgeCost(px, py, x, y);
+					if (cost < bestCost) {
+						bestCost = cost;
+						best = previous;
+					}
+				}
+			}
+			if (best == -1) return std::vector<BWAPI::TilePosition>();
+			node = best;
+			path.push_back(BWAPI::TilePosition(node / _height, node % _height));
+		}
+		std::reverse(path.begin(), path.end());
+		return path;
+	}
+}
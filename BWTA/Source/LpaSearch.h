@@ -0,0 +1,51 @@
+#pragma once
+
+#include "GridSearch.h"
+#include "ObstacleOverlay.h"
+
+namespace BWTA
+{
+	/**
+	 * Lifelong Planning A* on MapData::lowResWalkability, with the moves and costs of gridSearch. The
+	 * costs from start are kept between queries; when the ObstacleOverlay changes tiles only their
+	 * nodes and neighbors are put back in the open list, so the next query repairs the part of the
+	 * search that depends on them instead of starting over.
+	 * With a target the search stops as A* would once the target cost is known (octile heuristic),
+	 * without one (TilePositions::None) it keeps the costs of every reachable tile.
+	 */
+	class LpaSearch : public ObstacleListener
+	{
+	public:
+		LpaSearch(BWAPI::TilePosition start, BWAPI::TilePosition target);
+		~LpaSearch();
+
+		void onTilesChanged(const std::vector<BWAPI::TilePosition>& tiles);
+
+		// cost (10/14 units) from start, -1 if unreachable; with a target only valid for the target
+		int getCost(BWAPI::TilePosition tile);
+		// path from start to tile, empty if unreachable; with a target only valid for the target
+		std::vector<BWAPI::TilePosition> getPath(BWAPI::TilePosition tile);
+
+	private:
+		// non-copyable
+		LpaSearch(const LpaSearch&);
+		LpaSearch& operator=(const LpaSearch&);
+
+		bool isInside(BWAPI::TilePosition tile) const;
+		int edgeCost(int fromX, int fromY, int toX, int toY) const;
+		int64_t calculateKey(int node) const;
+		void updateVertex(int node);
+		void updateOpen(int node);
+		void computeShortestPath();
+
+		int _width;
+		int _height;
+		int _start;
+		int _target;	// -1 to keep every cost
+		bool _inside;	// start inside the map
+		std::vector<int> _g;
+		std::vector<int> _rhs;
+		std::vector<char> _inOpen;
+		BasicIndexedHeap4<int64_t> _open;
+	};
+}
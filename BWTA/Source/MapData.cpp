@@ -9,6 +9,7 @@ namespace BWTA
 		RectangleArray<bool> lowResWalkability;
 		RectangleArray<bool> buildability;
 		RectangleArray<int> distanceTransform;
+		RectangleArray<int> tileClearance;
 		BWAPI::TilePosition::list startLocations;
 		std::string hash;
 		std::string mapFileName;
@@ -21,8 +22,6 @@ namespace BWTA
 		uint16_t mapHeightTileRes;
 
 		uint16_t maxDistanceTransform;
-		// data for HPA*
-		ChokepointGraph chokeNodes;
 		
 		// offline map data
 		RectangleArray<bool> isWalkable;
@@ -8,8 +8,6 @@ using TileID = uint16_t;
 namespace BWTA
 {
 	typedef std::list<Chokepoint*> ChokePath;
-	typedef std::set< std::pair<Chokepoint*, int> > ChokeCost;
-	typedef std::map<Chokepoint*, ChokeCost> ChokepointGraph;
 
 	typedef std::pair<BWAPI::UnitType, BWAPI::Position> UnitTypePosition;
 //	typedef std::pair<BWAPI::UnitType, BWAPI::WalkPosition> UnitTypeWalkPosition;
@@ -31,6 +29,7 @@ namespace BWTA
 		extern RectangleArray<bool> lowResWalkability;
 		extern RectangleArray<bool> buildability;
 		extern RectangleArray<int> distanceTransform;
+		extern RectangleArray<int> tileClearance; // max distanceTransform of the walk tiles of each tile
 		extern BWAPI::TilePosition::list startLocations;
 		extern std::string hash;
 		extern std::string mapFileName;
@@ -43,8 +42,6 @@ namespace BWTA
 		extern uint16_t mapHeightTileRes;
 
 		extern uint16_t maxDistanceTransform;
-		// data for HPA*
-		extern ChokepointGraph chokeNodes;
 		
 		// offline map data
 		extern TileID   *TileArray;
@@ -0,0 +1,103 @@
+#include "MappedFile.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace BWTA
+{
+#ifdef _WIN32
+	MappedFile::MappedFile()
+		: _data(nullptr), _size(0), _fileHandle(INVALID_HANDLE_VALUE), _mappingHandle(nullptr)
+	{}
+#else
+	MappedFile::MappedFile()
+		: _data(nullptr), _size(0), _fd(-1)
+	{}
+#endif
+
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+#ifdef _WIN32
+	bool MappedFile::open(const std::string& filename)
+	{
+		close();
+
+		// FILE_SHARE_DELETE: another bot can still evict the file or rename a new one over it while it is
+		// mapped here (the view keeps the old contents until it is closed), as unlink/rename do on POSIX
+		_fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+		if (_fileHandle == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(_fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+			close();
+			return false;
+		}
+		_size = static_cast<size_t>(fileSize.QuadPart);
+
+		// PAGE_WRITECOPY + FILE_MAP_COPY gives a private copy-on-write view
+		_mappingHandle = CreateFileMappingA(_fileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		if (_mappingHandle == nullptr) {
+			close();
+			return false;
+		}
+
+		_data = static_cast<unsigned char*>(MapViewOfFile(_mappingHandle, FILE_MAP_COPY, 0, 0, 0));
+		if (_data == nullptr) {
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (_data != nullptr) UnmapViewOfFile(_data);
+		if (_mappingHandle != nullptr) CloseHandle(_mappingHandle);
+		if (_fileHandle != INVALID_HANDLE_VALUE) CloseHandle(_fileHandle);
+		_data = nullptr;
+		_size = 0;
+		_mappingHandle = nullptr;
+		_fileHandle = INVALID_HANDLE_VALUE;
+	}
+#else
+	bool MappedFile::open(const std::string& filename)
+	{
+		close();
+
+		_fd = ::open(filename.c_str(), O_RDONLY);
+		if (_fd < 0) return false;
+
+		struct stat fileStat;
+		if (fstat(_fd, &fileStat) != 0 || fileStat.st_size == 0) {
+			close();
+			return false;
+		}
+		_size = static_cast<size_t>(fileStat.st_size);
+
+		void* view = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE, _fd, 0);
+		if (view == MAP_FAILED) {
+			close();
+			return false;
+		}
+		_data = static_cast<unsigned char*>(view);
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (_data != nullptr) munmap(_data, _size);
+		if (_fd >= 0) ::close(_fd);
+		_data = nullptr;
+		_size = 0;
+		_fd = -1;
+	}
+#endif
+}
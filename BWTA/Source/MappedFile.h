@@ -0,0 +1,38 @@
+#pragma once
+
+namespace BWTA
+{
+	/**
+	 * Read-only memory mapping of a file.
+	 * The view is mapped copy-on-write, so arrays that point inside the mapping can be modified
+	 * by the analysis without touching the file on disk.
+	 */
+	class MappedFile
+	{
+	public:
+		MappedFile();
+		~MappedFile();
+
+		bool open(const std::string& filename);
+		void close();
+
+		bool isOpen() const { return _data != nullptr; }
+		const unsigned char* data() const { return _data; }
+		unsigned char* mutableData() { return _data; }
+		size_t size() const { return _size; }
+
+	private:
+		// non-copyable
+		MappedFile(const MappedFile&);
+		MappedFile& operator=(const MappedFile&);
+
+		unsigned char* _data;
+		size_t _size;
+#ifdef _WIN32
+		void* _fileHandle;
+		void* _mappingHandle;
+#else
+		int _fd;
+#endif
+	};
+}
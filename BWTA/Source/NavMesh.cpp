@@ -0,0 +1,755 @@
+#include "NavMesh.h"
+
+#include "GridSearch.h"
+
+namespace BWTA
+{
+	namespace
+	{
+		// twice the signed area of abc, positive for the triangles of the mesh
+		double cross(const BWAPI::Position& a, const BWAPI::Position& b, const BWAPI::Position& c)
+		{
+			return double(b.x - a.x) * (c.y - a.y) - double(b.y - a.y) * (c.x - a.x);
+		}
+
+		double distance(const BWAPI::Position& a, const BWAPI::Position& b)
+		{
+			return std::sqrt(double(b.x - a.x) * (b.x - a.x) + double(b.y - a.y) * (b.y - a.y));
+		}
+
+		double squaredSegmentDistance(const BWAPI::Position& p, const BWAPI::Position& a, const BWAPI::Position& b)
+		{
+			const double dx = b.x - a.x;
+			const double dy = b.y - a.y;
+			const double length = dx * dx + dy * dy;
+			double t = (length == 0) ? 0 : ((p.x - a.x) * dx + (p.y - a.y) * dy) / length;
+			t = std::max(0.0, std::min(1.0, t));
+			const double ex = a.x + t * dx - p.x;
+			const double ey = a.y + t * dy - p.y;
+			return ex * ex + ey * ey;
+		}
+
+		/**
+		 * Ear clipping of a polygon with holes, following the earcut library: each hole is joined to
+		 * the outer ring by a bridge from its leftmost vertex, then the ears (convex corners without a
+		 * reflex vertex inside) are cut one by one. When no ear is left (collinear or touching
+		 * vertices) the ring is cleaned, then its local self-intersections cut, then it is split in
+		 * two along a valid diagonal.
+		 */
+		class EarClipper
+		{
+		public:
+			EarClipper(const std::vector<BWAPI::Position>& vertices, std::vector<int>& corners)
+				: _vertices(vertices), _corners(corners) {}
+
+			// rings of vertex indices, the outer one first, any winding
+			void triangulate(const std::vector<std::vector<int>>& rings)
+			{
+				size_t size = 0;
+				for (const auto& ring : rings) size += ring.size();
+				_nodes.reserve(3 * size + 16);
+
+				int outer = linkedList(rings[0], true);
+				if (outer == -1 || next(outer) == prev(outer)) return;
+				if (rings.size() > 1) outer = eliminateHoles(rings, outer);
+				earcutLinked(outer, 0);
+			}
+
+		private:
+			struct Node {
+				int vertex;
+				double x, y;
+				int prev, next;
+			};
+
+			int prev(int p) const { return _nodes[p].prev; }
+			int next(int p) const { return _nodes[p].next; }
+			bool equals(int a, int b) const { return _nodes[a].x == _nodes[b].x && _nodes[a].y == _nodes[b].y; }
+			// earcut convention: negative at the convex corners of the outer ring
+			double area(int p, int q, int r) const
+			{
+				const Node& a = _nodes[p];
+				const Node& b = _nodes[q];
+				const Node& c = _nodes[r];
+				return (b.y - a.y) * (c.x - b.x) - (b.x - a.x) * (c.y - b.y);
+			}
+			static bool pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py)
+			{
+				return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+					(ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+					(bx - px) * (cy - py) >= (cx - px) * (by - py);
+			}
+
+			void emit(int a, int b, int c)
+			{
+				_corners.push_back(_nodes[a].vertex);
+				_corners.push_back(_nodes[b].vertex);
+				_corners.push_back(_nodes[c].vertex);
+			}
+
+			int newNode(int vertex)
+			{
+				Node node;
+				node.vertex = vertex;
+				node.x = _vertices[vertex].x;
+				node.y = _vertices[vertex].y;
+				node.prev = node.next = (int)_nodes.size();
+				_nodes.push_back(node);
+				return node.next;
+			}
+
+			int insertNode(int vertex, int last)
+			{
+				const int p = newNode(vertex);
+				if (last != -1) {
+					_nodes[p].next = next(last);
+					_nodes[p].prev = last;
+					_nodes[next(last)].prev = p;
+					_nodes[last].next = p;
+				}
+				return p;
+			}
+
+			void removeNode(int p)
+			{
+				_nodes[next(p)].prev = prev(p);
+				_nodes[prev(p)].next = next(p);
+			}
+
+			// circular list of the ring, the outer ring turning one way and the holes the other
+			int linkedList(const std::vector<int>& ring, bool outer)
+			{
+				double sum = 0;
+				for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+					const BWAPI::Position& a = _vertices[ring[i]];
+					const BWAPI::Position& b = _vertices[ring[j]];
+					sum += double(b.x - a.x) * (a.y + b.y);
+				}
+				int last = -1;
+				if (outer == (sum > 0)) {
+					for (size_t i = 0; i < ring.size(); ++i) last = insertNode(ring[i], last);
+				} else {
+					for (size_t i = ring.size(); i-- > 0;) last = insertNode(ring[i], last);
+				}
+				if (last != -1 && equals(last, next(last))) {
+					removeNode(last);
+					last = next(last);
+				}
+				return last;
+			}
+
+			// removes the duplicated and collinear vertices
+			int filterPoints(int start, int end)
+			{
+				if (start == -1) return start;
+				if (end == -1) end = start;
+				int p = start;
+				bool again;
+				do {
+					again = false;
+					if (equals(p, next(p)) || area(prev(p), p, next(p)) == 0) {
+						removeNode(p);
+						p = end = prev(p);
+						if (p == next(p)) break;
+						again = true;
+					} else {
+						p = next(p);
+					}
+				} while (again || p != end);
+				return end;
+			}
+
+			void earcutLinked(int ear, int pass)
+			{
+				if (ear == -1) return;
+				int stop = ear;
+				while (prev(ear) != next(ear)) {
+					const int p = prev(ear);
+					const int n = next(ear);
+					if (isEar(ear)) {
+						emit(p, ear, n);
+						removeNode(ear);
+						ear = stop = next(n);
+						continue;
+					}
+					ear = n;
+					if (ear == stop) {
+						if (pass == 0) {
+							earcutLinked(filterPoints(ear, -1), 1);
+						} else if (pass == 1) {
+							earcutLinked(cureLocalIntersections(filterPoints(ear, -1)), 2);
+						} else {
+							splitEarcut(ear);
+						}
+						break;
+					}
+				}
+			}
+
+			bool isEar(int ear) const
+			{
+				const int a = prev(ear);
+				const int c = next(ear);
+				if (area(a, ear, c) >= 0) return false; // reflex
+				const Node& na = _nodes[a];
+				const Node& nb = _nodes[ear];
+				const Node& nc = _nodes[c];
+				const double minX = std::min(na.x, std::min(nb.x, nc.x));
+				const double minY = std::min(na.y, std::min(nb.y, nc.y));
+				const double maxX = std::max(na.x, std::max(nb.x, nc.x));
+				const double maxY = std::max(na.y, std::max(nb.y, nc.y));
+				for (int p = next(c); p != a; p = next(p)) {
+					const Node& np = _nodes[p];
+					if (np.x >= minX && np.x <= maxX && np.y >= minY && np.y <= maxY &&
+						pointInTriangle(na.x, na.y, nb.x, nb.y, nc.x, nc.y, np.x, np.y) &&
+						area(prev(p), p, next(p)) >= 0) return false;
+				}
+				return true;
+			}
+
+			int cureLocalIntersections(int start)
+			{
+				int p = start;
+				do {
+					const int a = prev(p);
+					const int b = next(next(p));
+					if (!equals(a, b) && intersects(a, p, next(p), b) && locallyInside(a, b) && locallyInside(b, a)) {
+						emit(a, p, b);
+						removeNode(p);
+						removeNode(next(p));
+						p = start = b;
+					}
+					p = next(p);
+				} while (p != start);
+				return filterPoints(p, -1);
+			}
+
+			void splitEarcut(int start)
+			{
+				int a = start;
+				do {
+					for (int b = next(next(a)); b != prev(a); b = next(b)) {
+						if (_nodes[a].vertex != _nodes[b].vertex && isValidDiagonal(a, b)) {
+							int c = splitPolygon(a, b);
+							a = filterPoints(a, next(a));
+							c = filterPoints(c, next(c));
+							earcutLinked(a, 0);
+							earcutLinked(c, 0);
+							return;
+						}
+					}
+					a = next(a);
+				} while (a != start);
+			}
+
+			int eliminateHoles(const std::vector<std::vector<int>>& rings, int outer)
+			{
+				std::vector<int> leftmost;
+				for (size_t i = 1; i < rings.size(); ++i) {
+					const int list = linkedList(rings[i], false);
+					if (list != -1 && list != next(list)) leftmost.push_back(getLeftmost(list));
+				}
+				std::sort(leftmost.begin(), leftmost.end(), [this](int a, int b) { return _nodes[a].x < _nodes[b].x; });
+				for (const auto& hole : leftmost) outer = eliminateHole(hole, outer);
+				return outer;
+			}
+
+			int eliminateHole(int hole, int outer)
+			{
+				const int bridge = findHoleBridge(hole, outer);
+				if (bridge == -1) return outer;
+				const int bridgeReverse = splitPolygon(bridge, hole);
+				filterPoints(bridgeReverse, next(bridgeReverse));
+				return filterPoints(bridge, next(bridge));
+			}
+
+			// vertex of the outer ring visible from the leftmost vertex of the hole
+			int findHoleBridge(int hole, int outer) const
+			{
+				const double hx = _nodes[hole].x;
+				const double hy = _nodes[hole].y;
+				double qx = -std::numeric_limits<double>::infinity();
+				int m = -1;
+				// closest segment crossed by a ray from the hole to the left
+				int p = outer;
+				do {
+					const Node& np = _nodes[p];
+					const Node& nn = _nodes[next(p)];
+					if (hy <= np.y && hy >= nn.y && nn.y != np.y) {
+						const double x = np.x + (hy - np.y) * (nn.x - np.x) / (nn.y - np.y);
+						if (x <= hx && x > qx) {
+							qx = x;
+							m = (np.x < nn.x) ? p : next(p);
+							if (x == hx) return m; // the hole touches the segment
+						}
+					}
+					p = next(p);
+				} while (p != outer);
+				if (m == -1) return -1;
+
+				// a reflex vertex inside the triangle of the hole, the crossing and the segment end can
+				// hide it, take the one of smallest angle with the ray then
+				const int stop = m;
+				const double mx = _nodes[m].x;
+				const double my = _nodes[m].y;
+				double tanMin = std::numeric_limits<double>::infinity();
+				p = m;
+				do {
+					const Node& np = _nodes[p];
+					if (hx >= np.x && np.x >= mx && hx != np.x &&
+						pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, np.x, np.y)) {
+						const double tan = std::abs(hy - np.y) / (hx - np.x);
+						if (locallyInside(p, hole) && (tan < tanMin || (tan == tanMin &&
+							(np.x > _nodes[m].x || (np.x == _nodes[m].x && sectorContainsSector(m, p)))))) {
+							m = p;
+							tanMin = tan;
+						}
+					}
+					p = next(p);
+				} while (p != stop);
+				return m;
+			}
+
+			bool sectorContainsSector(int m, int p) const
+			{
+				return area(prev(m), m, prev(p)) < 0 && area(next(p), m, next(m)) < 0;
+			}
+
+			int getLeftmost(int start) const
+			{
+				int leftmost = start;
+				int p = start;
+				do {
+					if (_nodes[p].x < _nodes[leftmost].x || (_nodes[p].x == _nodes[leftmost].x && _nodes[p].y < _nodes[leftmost].y)) leftmost = p;
+					p = next(p);
+				} while (p != start);
+				return leftmost;
+			}
+
+			bool isValidDiagonal(int a, int b) const
+			{
+				const int bv = _nodes[b].vertex;
+				if (_nodes[next(a)].vertex == bv || _nodes[prev(a)].vertex == bv || intersectsPolygon(a, b)) return false;
+				if (locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b) &&
+					(area(prev(a), a, prev(b)) != 0 || area(a, prev(b), b) != 0)) return true;
+				return equals(a, b) && area(prev(a), a, next(a)) > 0 && area(prev(b), b, next(b)) > 0;
+			}
+
+			static int sign(double value) { return (value > 0) - (value < 0); }
+
+			bool onSegment(int p, int q, int r) const
+			{
+				const Node& np = _nodes[p];
+				const Node& nq = _nodes[q];
+				const Node& nr = _nodes[r];
+				return nq.x <= std::max(np.x, nr.x) && nq.x >= std::min(np.x, nr.x) &&
+					nq.y <= std::max(np.y, nr.y) && nq.y >= std::min(np.y, nr.y);
+			}
+
+			bool intersects(int p1, int q1, int p2, int q2) const
+			{
+				const int o1 = sign(area(p1, q1, p2));
+				const int o2 = sign(area(p1, q1, q2));
+				const int o3 = sign(area(p2, q2, p1));
+				const int o4 = sign(area(p2, q2, q1));
+				if (o1 != o2 && o3 != o4) return true;
+				if (o1 == 0 && onSegment(p1, p2, q1)) return true;
+				if (o2 == 0 && onSegment(p1, q2, q1)) return true;
+				if (o3 == 0 && onSegment(p2, p1, q2)) return true;
+				if (o4 == 0 && onSegment(p2, q1, q2)) return true;
+				return false;
+			}
+
+			bool intersectsPolygon(int a, int b) const
+			{
+				const int av = _nodes[a].vertex;
+				const int bv = _nodes[b].vertex;
+				int p = a;
+				do {
+					const int pv = _nodes[p].vertex;
+					const int nv = _nodes[next(p)].vertex;
+					if (pv != av && nv != av && pv != bv && nv != bv && intersects(p, next(p), a, b)) return true;
+					p = next(p);
+				} while (p != a);
+				return false;
+			}
+
+			// the diagonal ab leaves a inside the polygon
+			bool locallyInside(int a, int b) const
+			{
+				return area(prev(a), a, next(a)) < 0 ?
+					area(a, b, next(a)) >= 0 && area(a, prev(a), b) >= 0 :
+					area(a, b, prev(a)) < 0 || area(a, next(a), b) < 0;
+			}
+
+			bool middleInside(int a, int b) const
+			{
+				const double px = (_nodes[a].x + _nodes[b].x) / 2;
+				const double py = (_nodes[a].y + _nodes[b].y) / 2;
+				bool inside = false;
+				int p = a;
+				do {
+					const Node& np = _nodes[p];
+					const Node& nn = _nodes[next(p)];
+					if (((np.y > py) != (nn.y > py)) && nn.y != np.y && (px < (nn.x - np.x) * (py - np.y) / (nn.y - np.y) + np.x)) {
+						inside = !inside;
+					}
+					p = next(p);
+				} while (p != a);
+				return inside;
+			}
+
+			// links a to b in two rings sharing the diagonal, returns the copy of b
+			int splitPolygon(int a, int b)
+			{
+				const int a2 = newNode(_nodes[a].vertex);
+				const int b2 = newNode(_nodes[b].vertex);
+				const int an = next(a);
+				const int bp = prev(b);
+				_nodes[a].next = b;
+				_nodes[b].prev = a;
+				_nodes[a2].next = an;
+				_nodes[an].prev = a2;
+				_nodes[b2].next = a2;
+				_nodes[a2].prev = b2;
+				_nodes[bp].next = b2;
+				_nodes[b2].prev = bp;
+				return b2;
+			}
+
+			const std::vector<BWAPI::Position>& _vertices;
+			std::vector<int>& _corners;
+			std::vector<Node> _nodes;
+		};
+
+		// vertices of a closed Boost ring (walk resolution) in pixels, without repeated points
+		std::vector<int> addRing(const boost::geometry::model::ring<BoostPoint>& ring, std::vector<BWAPI::Position>& vertices)
+		{
+			std::vector<int> indices;
+			for (const auto& point : ring) {
+				BWAPI::Position position((int)std::floor(point.x() * 8 + 0.5), (int)std::floor(point.y() * 8 + 0.5));
+				if (!indices.empty() && vertices[indices.back()] == position) continue;
+				vertices.push_back(position);
+				indices.push_back((int)vertices.size() - 1);
+			}
+			while (indices.size() > 1 && vertices[indices.back()] == vertices[indices.front()]) indices.pop_back();
+			return indices;
+		}
+
+		int64_t edgeKey(int a, int b)
+		{
+			return (int64_t(a) << 32) | uint32_t(b);
+		}
+
+		// Neighbor triangles must share whole edges: the flat triangles are dropped and a triangle with
+		// a vertex inside one of its unshared edges (left by a flat triangle or a collinear vertex the
+		// clipping filtered out) is split there, until every edge is shared or a wall
+		void splitTJunctions(const std::vector<BWAPI::Position>& vertices, std::vector<int>& corners)
+		{
+			std::vector<int> kept;
+			kept.reserve(corners.size());
+			for (size_t t = 0; t < corners.size(); t += 3) {
+				if (cross(vertices[corners[t]], vertices[corners[t + 1]], vertices[corners[t + 2]]) <= 0) continue;
+				kept.insert(kept.end(), corners.begin() + t, corners.begin() + t + 3);
+			}
+			corners.swap(kept);
+
+			for (bool split = true; split;) {
+				split = false;
+				std::vector<int64_t> edges;
+				edges.reserve(corners.size());
+				for (size_t e = 0; e < corners.size(); ++e) edges.push_back(edgeKey(corners[e], corners[e - e % 3 + (e + 1) % 3]));
+				std::sort(edges.begin(), edges.end());
+
+				// vertices of the unshared edges, by x
+				std::vector<int> open;
+				std::vector<int> candidates;
+				for (size_t e = 0; e < corners.size(); ++e) {
+					const int a = corners[e];
+					const int b = corners[e - e % 3 + (e + 1) % 3];
+					if (std::binary_search(edges.begin(), edges.end(), edgeKey(b, a))) continue;
+					open.push_back((int)e);
+					candidates.push_back(a);
+				}
+				std::sort(candidates.begin(), candidates.end(), [&vertices](int a, int b) { return vertices[a].x < vertices[b].x; });
+
+				const size_t triangleCount = corners.size() / 3;
+				std::vector<char> changed(triangleCount, 0);
+				for (const auto& e : open) {
+					const size_t t = e / 3;
+					if (changed[t]) continue;
+					const int a = corners[e];
+					const int b = corners[3 * t + (e + 1) % 3];
+					const int c = corners[3 * t + (e + 2) % 3];
+					const BWAPI::Position& pa = vertices[a];
+					const BWAPI::Position& pb = vertices[b];
+					auto first = std::lower_bound(candidates.begin(), candidates.end(), std::min(pa.x, pb.x),
+						[&vertices](int v, int x) { return vertices[v].x < x; });
+					for (auto it = first; it != candidates.end() && vertices[*it].x <= std::max(pa.x, pb.x); ++it) {
+						const BWAPI::Position& pv = vertices[*it];
+						if (pv == pa || pv == pb || cross(pa, pb, pv) != 0) continue;
+						const double along = double(pv.x - pa.x) * (pb.x - pa.x) + double(pv.y - pa.y) * (pb.y - pa.y);
+						const double length = double(pb.x - pa.x) * (pb.x - pa.x) + double(pb.y - pa.y) * (pb.y - pa.y);
+						if (along <= 0 || along >= length) continue;
+						// abc becomes avc and vbc
+						corners[3 * t] = a;
+						corners[3 * t + 1] = *it;
+						corners[3 * t + 2] = c;
+						corners.push_back(*it);
+						corners.push_back(b);
+						corners.push_back(c);
+						changed[t] = 1;
+						split = true;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	void NavMesh::build(const std::vector<BoostPolygon>& obstacles, int walkWidth, int walkHeight)
+	{
+		typedef boost::geometry::model::multi_polygon<BoostPolygon> BoostMultiPoly;
+
+		// the walkable area of createRegionsFromGraph: the map box minus the obstacles
+		BoostPolygon mapBorder;
+		std::vector<BoostPoint> points = { BoostPoint(0, 0), BoostPoint(walkWidth - 1, 0),
+			BoostPoint(walkWidth - 1, walkHeight - 1), BoostPoint(0, walkHeight - 1), BoostPoint(0, 0) };
+		boost::geometry::assign_points(mapBorder, points);
+		boost::geometry::correct(mapBorder);
+		// the simplified obstacles can touch along an edge, merged first so that the holes of the
+		// walkable area do not (the clipping needs the holes apart)
+		// (by pairs, each union stays small)
+		std::vector<BoostMultiPoly> parts(obstacles.size());
+		for (size_t i = 0; i < obstacles.size(); ++i) parts[i].push_back(obstacles[i]);
+		while (parts.size() > 1) {
+			std::vector<BoostMultiPoly> merged((parts.size() + 1) / 2);
+			for (size_t i = 0; i + 1 < parts.size(); i += 2) boost::geometry::union_(parts[i], parts[i + 1], merged[i / 2]);
+			if (parts.size() % 2 == 1) merged.back().swap(parts.back());
+			parts.swap(merged);
+		}
+		BoostMultiPoly walkable;
+		if (parts.empty()) walkable.push_back(mapBorder);
+		else boost::geometry::difference(mapBorder, parts[0], walkable);
+
+		std::vector<BWAPI::Position> vertices;
+		std::vector<int> corners;
+		for (const auto& polygon : walkable) {
+			std::vector<std::vector<int>> rings;
+			rings.push_back(addRing(polygon.outer(), vertices));
+			if (rings.back().size() < 3) continue;
+			for (const auto& inner : polygon.inners()) {
+				rings.push_back(addRing(inner, vertices));
+				if (rings.back().size() < 3) rings.pop_back();
+			}
+			EarClipper(vertices, corners).triangulate(rings);
+		}
+		splitTJunctions(vertices, corners);
+		assign(walkWidth / 4, walkHeight / 4, vertices, corners);
+	}
+
+	void NavMesh::assign(int tileWidth, int tileHeight, std::vector<BWAPI::Position>& vertices, std::vector<int>& corners)
+	{
+		_tileWidth = tileWidth;
+		_tileHeight = tileHeight;
+		_vertices.swap(vertices);
+		_corners.swap(corners);
+		const int triangleCount = getTriangleCount();
+
+		// the neighbor shares the edge the other way around
+		std::vector<std::pair<int64_t, int>> edges;
+		edges.reserve(_corners.size());
+		for (int e = 0; e < 3 * triangleCount; ++e) {
+			edges.push_back(std::make_pair(edgeKey(_corners[e], _corners[e - e % 3 + (e + 1) % 3]), e));
+		}
+		std::sort(edges.begin(), edges.end());
+		_neighbors.assign(_corners.size(), -1);
+		for (int e = 0; e < 3 * triangleCount; ++e) {
+			const int64_t twin = edgeKey(_corners[e - e % 3 + (e + 1) % 3], _corners[e]);
+			auto it = std::lower_bound(edges.begin(), edges.end(), std::make_pair(twin, -1));
+			if (it != edges.end() && it->first == twin) _neighbors[e] = it->second / 3;
+		}
+
+		// triangles overlapping each tile: their bounding boxes overlap and no edge has the whole
+		// tile on its outer side
+		std::vector<std::pair<int, int>> tileTriangles;
+		for (int t = 0; t < triangleCount; ++t) {
+			const BWAPI::Position& a = _vertices[_corners[3 * t]];
+			const BWAPI::Position& b = _vertices[_corners[3 * t + 1]];
+			const BWAPI::Position& c = _vertices[_corners[3 * t + 2]];
+			const int minX = std::max(0, std::min(a.x, std::min(b.x, c.x)) / 32);
+			const int minY = std::max(0, std::min(a.y, std::min(b.y, c.y)) / 32);
+			const int maxX = std::min(_tileWidth - 1, std::max(a.x, std::max(b.x, c.x)) / 32);
+			const int maxY = std::min(_tileHeight - 1, std::max(a.y, std::max(b.y, c.y)) / 32);
+			for (int x = minX; x <= maxX; ++x) {
+				for (int y = minY; y <= maxY; ++y) {
+					const BWAPI::Position tile[4] = { BWAPI::Position(x * 32, y * 32), BWAPI::Position(x * 32 + 32, y * 32),
+						BWAPI::Position(x * 32, y * 32 + 32), BWAPI::Position(x * 32 + 32, y * 32 + 32) };
+					bool separated = false;
+					for (int i = 0; i < 3 && !separated; ++i) {
+						const BWAPI::Position& from = _vertices[_corners[3 * t + i]];
+						const BWAPI::Position& to = _vertices[_corners[3 * t + (i + 1) % 3]];
+						separated = cross(from, to, tile[0]) < 0 && cross(from, to, tile[1]) < 0
+							&& cross(from, to, tile[2]) < 0 && cross(from, to, tile[3]) < 0;
+					}
+					if (!separated) tileTriangles.push_back(std::make_pair(x * _tileHeight + y, t));
+				}
+			}
+		}
+		std::sort(tileTriangles.begin(), tileTriangles.end());
+		_firstTileTriangle.assign(_tileWidth * _tileHeight + 1, 0);
+		_tileTriangles.resize(tileTriangles.size());
+		for (size_t i = 0; i < tileTriangles.size(); ++i) {
+			_firstTileTriangle[tileTriangles[i].first + 1]++;
+			_tileTriangles[i] = tileTriangles[i].second;
+		}
+		for (int tile = 0; tile < _tileWidth * _tileHeight; ++tile) _firstTileTriangle[tile + 1] += _firstTileTriangle[tile];
+	}
+
+	void NavMesh::clear()
+	{
+		_tileWidth = _tileHeight = 0;
+		std::vector<BWAPI::Position>().swap(_vertices);
+		std::vector<int>().swap(_corners);
+		std::vector<int>().swap(_neighbors);
+		std::vector<int>().swap(_firstTileTriangle);
+		std::vector<int>().swap(_tileTriangles);
+	}
+
+	int NavMesh::getTriangle(BWAPI::Position p) const
+	{
+		const int tx = p.x / 32;
+		const int ty = p.y / 32;
+		if (empty() || p.x < 0 || p.y < 0 || tx >= _tileWidth || ty >= _tileHeight) return -1;
+		const int tile = tx * _tileHeight + ty;
+		for (int i = _firstTileTriangle[tile]; i < _firstTileTriangle[tile + 1]; ++i) {
+			const int t = _tileTriangles[i];
+			const BWAPI::Position& a = _vertices[_corners[3 * t]];
+			const BWAPI::Position& b = _vertices[_corners[3 * t + 1]];
+			const BWAPI::Position& c = _vertices[_corners[3 * t + 2]];
+			if (cross(a, b, p) >= 0 && cross(b, c, p) >= 0 && cross(c, a, p) >= 0) return t;
+		}
+
+		int best = -1;
+		double bestDistance = 0;
+		for (int x = std::max(0, tx - 1); x <= std::min(_tileWidth - 1, tx + 1); ++x) {
+			for (int y = std::max(0, ty - 1); y <= std::min(_tileHeight - 1, ty + 1); ++y) {
+				const int around = x * _tileHeight + y;
+				for (int i = _firstTileTriangle[around]; i < _firstTileTriangle[around + 1]; ++i) {
+					const int t = _tileTriangles[i];
+					double d = -1;
+					for (int k = 0; k < 3; ++k) {
+						const double edge = squaredSegmentDistance(p, _vertices[_corners[3 * t + k]], _vertices[_corners[3 * t + (k + 1) % 3]]);
+						if (d == -1 || edge < d) d = edge;
+					}
+					if (best == -1 || d < bestDistance) {
+						best = t;
+						bestDistance = d;
+					}
+				}
+			}
+		}
+		return best;
+	}
+
+	std::vector<BWAPI::Position> NavMesh::getPath(BWAPI::Position start, BWAPI::Position end) const
+	{
+		std::vector<BWAPI::Position> path;
+		const int first = getTriangle(start);
+		const int last = getTriangle(end);
+		if (first == -1 || last == -1) return path;
+
+		// A* over the triangles, each one entered at the middle of an edge
+		std::vector<int> corridor;
+		if (first == last) {
+			corridor.push_back(first);
+		} else {
+			const int triangleCount = getTriangleCount();
+			std::vector<double> cost(triangleCount, -1);
+			std::vector<int> parent(triangleCount, -1);
+			std::vector<BWAPI::Position> entry(triangleCount);
+			std::vector<char> closed(triangleCount, 0);
+			BasicIndexedHeap4<double> open;
+			open.resize(triangleCount);
+			cost[first] = 0;
+			entry[first] = start;
+			open.push(first, distance(start, end));
+			while (!open.empty()) {
+				const int t = open.topNode();
+				open.pop();
+				if (t == last) break;
+				closed[t] = 1;
+				for (int i = 0; i < 3; ++i) {
+					const int neighbor = _neighbors[3 * t + i];
+					if (neighbor == -1 || closed[neighbor]) continue;
+					const BWAPI::Position& a = _vertices[_corners[3 * t + i]];
+					const BWAPI::Position& b = _vertices[_corners[3 * t + (i + 1) % 3]];
+					const BWAPI::Position middle((a.x + b.x) / 2, (a.y + b.y) / 2);
+					const double g = cost[t] + distance(entry[t], middle);
+					if (cost[neighbor] != -1 && g >= cost[neighbor]) continue;
+					const bool seen = (cost[neighbor] != -1);
+					cost[neighbor] = g;
+					parent[neighbor] = t;
+					entry[neighbor] = middle;
+					if (seen) open.decreaseKey(neighbor, g + distance(middle, end));
+					else open.push(neighbor, g + distance(middle, end));
+				}
+			}
+			if (parent[last] == -1) return path;
+			for (int t = last; t != first; t = parent[t]) corridor.push_back(t);
+			corridor.push_back(first);
+			std::reverse(corridor.begin(), corridor.end());
+		}
+
+		// the edges crossed, seen from the start: going out of a triangle through the edge from
+		// corner i to corner i + 1, corner i is on the right
+		std::vector<BWAPI::Position> lefts(1, start);
+		std::vector<BWAPI::Position> rights(1, start);
+		for (size_t k = 0; k + 1 < corridor.size(); ++k) {
+			const int t = corridor[k];
+			for (int i = 0; i < 3; ++i) {
+				if (_neighbors[3 * t + i] != corridor[k + 1]) continue;
+				rights.push_back(_vertices[_corners[3 * t + i]]);
+				lefts.push_back(_vertices[_corners[3 * t + (i + 1) % 3]]);
+				break;
+			}
+		}
+		lefts.push_back(end);
+		rights.push_back(end);
+
+		// funnel: the apex and the two sides narrow edge after edge, when a side crosses the other
+		// the corner on that side is a turn of the path and becomes the new apex
+		path.push_back(start);
+		BWAPI::Position apex = start;
+		BWAPI::Position left = lefts[0];
+		BWAPI::Position right = rights[0];
+		size_t leftIndex = 0;
+		size_t rightIndex = 0;
+		for (size_t i = 1; i < lefts.size(); ++i) {
+			if (cross(apex, right, rights[i]) >= 0) {
+				if (apex == right || cross(apex, left, rights[i]) < 0) {
+					right = rights[i];
+					rightIndex = i;
+				} else {
+					path.push_back(left);
+					apex = right = left;
+					i = rightIndex = leftIndex;
+					continue;
+				}
+			}
+			if (cross(apex, left, lefts[i]) <= 0) {
+				if (apex == left || cross(apex, right, lefts[i]) > 0) {
+					left = lefts[i];
+					leftIndex = i;
+				} else {
+					path.push_back(right);
+					apex = left = right;
+					i = leftIndex = rightIndex;
+					continue;
+				}
+			}
+		}
+		if (path.back() != end) path.push_back(end);
+		return path;
+	}
+}
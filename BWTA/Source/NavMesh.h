@@ -0,0 +1,50 @@
+#pragma once
+
+namespace BWTA
+{
+	/**
+	 * Navigation mesh of the walkable area: the map minus the unwalkable polygons (with the holes they
+	 * leave) cut in triangles by ear clipping, each hole joined to the outer ring by a bridge first.
+	 * A path is an A* over the triangles (from edge midpoint to edge midpoint) pulled tight through
+	 * the triangles crossed with the funnel algorithm, so a long path costs a few hundred triangles
+	 * instead of tens of thousands of tiles. Positions are in pixels; the polygons are simplified and
+	 * the units have no size here, the path grazes the corners of the obstacles.
+	 * Built by the analysis and stored in the cache file. It does not know about blocked tiles.
+	 */
+	class NavMesh
+	{
+	public:
+		NavMesh() : _tileWidth(0), _tileHeight(0) {}
+
+		// obstacles in walk resolution, as given to createRegionsFromGraph
+		void build(const std::vector<BoostPolygon>& obstacles, int walkWidth, int walkHeight);
+		// vertices in pixels and three corners per triangle, all turning the same way
+		void assign(int tileWidth, int tileHeight, std::vector<BWAPI::Position>& vertices, std::vector<int>& corners);
+		void clear();
+
+		bool empty() const { return _corners.empty(); }
+		int getTileWidth() const { return _tileWidth; }
+		int getTileHeight() const { return _tileHeight; }
+		int getTriangleCount() const { return (int)_corners.size() / 3; }
+		const std::vector<BWAPI::Position>& getVertices() const { return _vertices; }
+		const std::vector<int>& getCorners() const { return _corners; }
+		// triangle across the edge from corner i to corner i + 1 of triangle t, -1 for a wall
+		int getNeighbor(int t, int i) const { return _neighbors[3 * t + i]; }
+
+		// triangle containing p, else the closest one in the tiles around it (p inside a simplified
+		// obstacle), -1 if none
+		int getTriangle(BWAPI::Position p) const;
+		// corners where the path turns from start to end (both included), empty if no path
+		std::vector<BWAPI::Position> getPath(BWAPI::Position start, BWAPI::Position end) const;
+
+	private:
+		int _tileWidth;
+		int _tileHeight;
+		std::vector<BWAPI::Position> _vertices;
+		std::vector<int> _corners;
+		std::vector<int> _neighbors;
+		// CSR by tile (x * height + y): the triangles overlapping each tile
+		std::vector<int> _firstTileTriangle;
+		std::vector<int> _tileTriangles;
+	};
+}
@@ -0,0 +1,213 @@
+#include "ObstacleOverlay.h"
+
+namespace BWTA
+{
+	ObstacleOverlay& getObstacleOverlay()
+	{
+		static ObstacleOverlay overlay;
+		return overlay;
+	}
+
+	void ObstacleOverlay::reset()
+	{
+		_blocked.resize(0, 0);
+		_staticWalkable.resize(0, 0);
+		_component.resize(0, 0);
+		_blockedCount = 0;
+		_nextLabel = 0;
+		++_revision;
+	}
+
+	bool ObstacleOverlay::isInside(BWAPI::TilePosition tile) const
+	{
+		return tile.x >= 0 && tile.y >= 0 && tile.x < (int)_blocked.getWidth() && tile.y < (int)_blocked.getHeight();
+	}
+
+	void ObstacleOverlay::init()
+	{
+		const int width = MapData::mapWidthTileRes;
+		const int height = MapData::mapHeightTileRes;
+		if ((int)_blocked.getWidth() == width && (int)_blocked.getHeight() == height) return;
+		_blocked.resize(width, height);
+		_blocked.setTo(false);
+		_staticWalkable = MapData::lowResWalkability;
+		_component.resize(width, height);
+		_component.setTo(-1);
+		_blockedCount = 0;
+		_nextLabel = 0;
+		for (int x = 0; x < width; ++x) {
+			for (int y = 0; y < height; ++y) {
+				if (MapData::lowResWalkability[x][y] && _component[x][y] == -1) label(x, y, _nextLabel++);
+			}
+		}
+	}
+
+	// flood fill from (x,y) with the moves of gridSearch
+	void ObstacleOverlay::label(int x, int y, int label)
+	{
+		const RectangleArray<bool>& walkable = MapData::lowResWalkability;
+		const int width = (int)_component.getWidth();
+		const int height = (int)_component.getHeight();
+		std::vector<BWAPI::TilePosition> stack(1, BWAPI::TilePosition(x, y));
+		_component[x][y] = label;
+		while (!stack.empty()) {
+			BWAPI::TilePosition p = stack.back();
+			stack.pop_back();
+			for (int nx = std::max(p.x - 1, 0); nx <= std::min(p.x + 1, width - 1); ++nx) {
+				for (int ny = std::max(p.y - 1, 0); ny <= std::min(p.y + 1, height - 1); ++ny) {
+					if (!walkable[nx][ny] || _component[nx][ny] == label) continue;
+					if (nx != p.x && ny != p.y && !walkable[p.x][ny] && !walkable[nx][p.y]) continue;
+					_component[nx][ny] = label;
+					stack.push_back(BWAPI::TilePosition(nx, ny));
+				}
+			}
+		}
+	}
+
+	void ObstacleOverlay::beginDeferral()
+	{
+		_deferred = true;
+		_queue.clear();
+	}
+
+	void ObstacleOverlay::endDeferral()
+	{
+		_deferred = false;
+		std::vector<QueuedChange> queue;
+		queue.swap(_queue);
+		for (const auto& change : queue) {
+			if (change.block) block(change.tiles);
+			else if (change.tiles.empty()) unblockAll();
+			else unblock(change.tiles);
+		}
+	}
+
+	void ObstacleOverlay::block(const std::vector<BWAPI::TilePosition>& tiles)
+	{
+		if (_deferred) {
+			QueuedChange change = { true, tiles };
+			_queue.push_back(change);
+			return;
+		}
+		init();
+		std::vector<BWAPI::TilePosition> changed;
+		for (const auto& tile : tiles) {
+			if (!isInside(tile) || _blocked[tile.x][tile.y]) continue;
+			_blocked[tile.x][tile.y] = true;
+			++_blockedCount;
+			if (!MapData::lowResWalkability[tile.x][tile.y]) continue;
+			MapData::lowResWalkability[tile.x][tile.y] = false;
+			_component[tile.x][tile.y] = -1;
+			changed.push_back(tile);
+		}
+		if (changed.empty()) return;
+
+		// the components around the blocked tiles may be split, label them again from each side
+		const int firstLabel = _nextLabel;
+		const int width = (int)_component.getWidth();
+		const int height = (int)_component.getHeight();
+		for (const auto& tile : changed) {
+			for (int x = std::max(tile.x - 1, 0); x <= std::min(tile.x + 1, width - 1); ++x) {
+				for (int y = std::max(tile.y - 1, 0); y <= std::min(tile.y + 1, height - 1); ++y) {
+					if (MapData::lowResWalkability[x][y] && _component[x][y] < firstLabel) label(x, y, _nextLabel++);
+				}
+			}
+		}
+		notify(changed);
+	}
+
+	void ObstacleOverlay::unblock(const std::vector<BWAPI::TilePosition>& tiles)
+	{
+		if (_deferred) {
+			if (tiles.empty()) return;
+			QueuedChange change = { false, tiles };
+			_queue.push_back(change);
+			return;
+		}
+		std::vector<BWAPI::TilePosition> changed;
+		for (const auto& tile : tiles) {
+			if (!isInside(tile) || !_blocked[tile.x][tile.y]) continue;
+			_blocked[tile.x][tile.y] = false;
+			--_blockedCount;
+			if (!_staticWalkable[tile.x][tile.y]) continue;
+			MapData::lowResWalkability[tile.x][tile.y] = true;
+			changed.push_back(tile);
+		}
+		if (changed.empty()) return;
+
+		// each unblocked tile joins the components around it under a new label
+		const int firstLabel = _nextLabel;
+		for (const auto& tile : changed) {
+			if (_component[tile.x][tile.y] < firstLabel) label(tile.x, tile.y, _nextLabel++);
+		}
+		notify(changed);
+	}
+
+	void ObstacleOverlay::unblockAll()
+	{
+		if (_deferred) {
+			QueuedChange change = { false, std::vector<BWAPI::TilePosition>() };
+			_queue.push_back(change);
+			return;
+		}
+		std::vector<BWAPI::TilePosition> tiles;
+		for (int x = 0; x < (int)_blocked.getWidth(); ++x) {
+			for (int y = 0; y < (int)_blocked.getHeight(); ++y) {
+				if (_blocked[x][y]) tiles.push_back(BWAPI::TilePosition(x, y));
+			}
+		}
+		unblock(tiles);
+	}
+
+	bool ObstacleOverlay::isBlocked(BWAPI::TilePosition tile) const
+	{
+		return isInside(tile) && _blocked[tile.x][tile.y];
+	}
+
+	void ObstacleOverlay::getLabels(BWAPI::TilePosition tile, std::vector<int>& labels) const
+	{
+		const RectangleArray<bool>& walkable = MapData::lowResWalkability;
+		labels.clear();
+		if (!isInside(tile)) return;
+		if (walkable[tile.x][tile.y]) {
+			labels.push_back(_component[tile.x][tile.y]);
+			return;
+		}
+		const int width = (int)_component.getWidth();
+		const int height = (int)_component.getHeight();
+		for (int x = std::max(tile.x - 1, 0); x <= std::min(tile.x + 1, width - 1); ++x) {
+			for (int y = std::max(tile.y - 1, 0); y <= std::min(tile.y + 1, height - 1); ++y) {
+				if (!walkable[x][y]) continue;
+				if (x != tile.x && y != tile.y && !walkable[tile.x][y] && !walkable[x][tile.y]) continue;
+				labels.push_back(_component[x][y]);
+			}
+		}
+	}
+
+	bool ObstacleOverlay::isConnected(BWAPI::TilePosition a, BWAPI::TilePosition b) const
+	{
+		std::vector<int> labelsA, labelsB;
+		getLabels(a, labelsA);
+		getLabels(b, labelsB);
+		for (int label : labelsA) {
+			if (std::find(labelsB.begin(), labelsB.end(), label) != labelsB.end()) return true;
+		}
+		return false;
+	}
+
+	void ObstacleOverlay::addListener(ObstacleListener* listener)
+	{
+		_listeners.push_back(listener);
+	}
+
+	void ObstacleOverlay::removeListener(ObstacleListener* listener)
+	{
+		_listeners.erase(std::remove(_listeners.begin(), _listeners.end(), listener), _listeners.end());
+	}
+
+	void ObstacleOverlay::notify(const std::vector<BWAPI::TilePosition>& tiles)
+	{
+		++_revision;
+		for (auto listener : _listeners) listener->onTilesChanged(tiles);
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "MapData.h"
+
+namespace BWTA
+{
+	// told about the tiles whose walkability changed (the incremental searches)
+	class ObstacleListener
+	{
+	public:
+		virtual ~ObstacleListener() {}
+		virtual void onTilesChanged(const std::vector<BWAPI::TilePosition>& tiles) = 0;
+	};
+
+	/**
+	 * Dynamic obstacles on top of the static tile walkability. MapData::lowResWalkability stays the
+	 * grid read by every tile search, so it holds the static walkability minus the blocked tiles; the
+	 * static grid is kept to restore the tiles once unblocked.
+	 * The connected components of the walkable tiles (same moves as gridSearch) are kept for
+	 * isConnected: blocking tiles only labels again the components they were part of, unblocking
+	 * only the components they join.
+	 */
+	class ObstacleOverlay
+	{
+	public:
+		ObstacleOverlay() : _blockedCount(0), _nextLabel(0), _revision(0), _deferred(false) {}
+
+		// forgets the blocked tiles without touching lowResWalkability (it was loaded again)
+		void reset();
+		void block(const std::vector<BWAPI::TilePosition>& tiles);
+		void unblock(const std::vector<BWAPI::TilePosition>& tiles);
+		void unblockAll();
+
+		// while an analysis reads lowResWalkability (analyzeAsync) the changes are queued, and made
+		// in the same order by endDeferral() once it is done; both on the game thread
+		void beginDeferral();
+		void endDeferral();
+
+		bool empty() const { return _blockedCount == 0; }
+		// changes each time the walkability of a tile changes, a search begun before is stale
+		unsigned int getRevision() const { return _revision; }
+		bool isBlocked(BWAPI::TilePosition tile) const;
+		// a tile search can go from a to b, an unwalkable tile counts through its walkable neighbors
+		bool isConnected(BWAPI::TilePosition a, BWAPI::TilePosition b) const;
+
+		void addListener(ObstacleListener* listener);
+		void removeListener(ObstacleListener* listener);
+
+	private:
+		bool isInside(BWAPI::TilePosition tile) const;
+		void init();
+		void label(int x, int y, int label);
+		void getLabels(BWAPI::TilePosition tile, std::vector<int>& labels) const;
+		void notify(const std::vector<BWAPI::TilePosition>& tiles);
+
+		RectangleArray<bool> _blocked;
+		RectangleArray<bool> _staticWalkable;
+		RectangleArray<int> _component; // -1 if unwalkable
+		int _blockedCount;
+		int _nextLabel;
+		unsigned int _revision;
+		std::vector<ObstacleListener*> _listeners;
+
+		struct QueuedChange {
+			bool block;
+			std::vector<BWAPI::TilePosition> tiles; // unblockAll if empty and not block
+		};
+		bool _deferred;
+		std::vector<QueuedChange> _queue;
+	};
+
+	ObstacleOverlay& getObstacleOverlay();
+}
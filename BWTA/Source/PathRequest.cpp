@@ -0,0 +1,117 @@
+#include <BWTA/PathRequest.h>
+
+#include "GridSearch.h"
+#include "ObstacleOverlay.h"
+#include "Timer.h"
+
+namespace BWTA
+{
+	// nodes expanded between two looks at the clock
+	static const int EXPANSIONS_PER_SLICE = 256;
+
+	struct PathRequest::Search {
+		GridSearchLease context;
+		SingleGoal goal;
+		OctileHeuristic heuristic;
+		unsigned int revision; // of the obstacle overlay when the search began
+		explicit Search(BWAPI::TilePosition end) : goal(end), heuristic(end), revision(getObstacleOverlay().getRevision()) {}
+	};
+
+	PathRequest::PathRequest(BWAPI::TilePosition start, BWAPI::TilePosition end, int priority)
+		: _search(nullptr), _start(start), _end(end), _priority(priority), _status(PENDING), _distance(-1)
+	{
+	}
+
+	PathRequest::~PathRequest()
+	{
+		delete _search;
+	}
+
+	PathRequest::Status PathRequest::step(double budgetMicroseconds)
+	{
+		if (_status != PENDING) return _status;
+		Timer timer;
+		timer.start();
+
+		const WalkableGrid grid(MapData::lowResWalkability);
+		// tiles were blocked or unblocked since the last step: the open list and the costs found so
+		// far may be wrong, search again from the start
+		if (_search != nullptr && _search->revision != getObstacleOverlay().getRevision()) {
+			delete _search;
+			_search = nullptr;
+		}
+		if (_search == nullptr) {
+			if (!isConnected(_start, _end)) {
+				finish(-1);
+				return _status;
+			}
+			_search = new Search(_end);
+			gridSearchBegin<RecordPath>(*_search->context, grid, _start, _search->goal);
+		}
+		while (true) {
+			int node = gridSearchResume<RecordPath>(*_search->context, grid, _search->goal, _search->heuristic, EXPANSIONS_PER_SLICE);
+			if (node != GRID_SEARCH_PENDING) {
+				finish(node);
+				break;
+			}
+			if (timer.getMicrosecondsSinceStart() >= budgetMicroseconds) break;
+		}
+		return _status;
+	}
+
+	void PathRequest::cancel()
+	{
+		if (_status == PENDING) finish(-1);
+	}
+
+	void PathRequest::finish(int node)
+	{
+		if (node == -1) {
+			_status = NOT_FOUND;
+		} else {
+			_status = FOUND;
+			_path = _search->context->getPath(node);
+			_distance = _search->context->getCost(node) * 32.0 / 10.0;
+		}
+		delete _search;
+		_search = nullptr;
+	}
+
+	PathScheduler::PathScheduler(double frameBudgetMicroseconds)
+		: _frameBudget(frameBudgetMicroseconds)
+	{
+	}
+
+	void PathScheduler::add(PathRequest* request)
+	{
+		if (request->isDone() || std::find(_pending.begin(), _pending.end(), request) != _pending.end()) return;
+		_pending.push_back(request);
+	}
+
+	void PathScheduler::remove(PathRequest* request)
+	{
+		_pending.erase(std::remove(_pending.begin(), _pending.end(), request), _pending.end());
+	}
+
+	int PathScheduler::update()
+	{
+		Timer timer;
+		timer.start();
+		std::stable_sort(_pending.begin(), _pending.end(),
+			[](const PathRequest* a, const PathRequest* b) { return a->getPriority() > b->getPriority(); });
+
+		int finished = 0;
+		size_t i = 0;
+		while (i < _pending.size()) {
+			double remaining = _frameBudget - timer.getMicrosecondsSinceStart();
+			if (remaining <= 0) break;
+			if (_pending[i]->step(remaining) == PathRequest::PENDING) {
+				++i;
+			} else {
+				_pending.erase(_pending.begin() + i);
+				++finished;
+			}
+		}
+		return finished;
+	}
+}
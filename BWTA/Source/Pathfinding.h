@@ -2,6 +2,9 @@
 
 #include "Heap.h"
 #include "MapData.h"
+#include "GridSearch.h"
+#include "JumpPointSearch.h"
+#include "ChokepointDistanceTable.h"
 
 namespace BWTA
 {
@@ -10,4 +13,10 @@ namespace BWTA
 	std::map<BWAPI::TilePosition, double> AstarSearchDistanceAll(BWAPI::TilePosition start, std::set<BWAPI::TilePosition>& end);
 	std::vector<BWAPI::TilePosition> AstarSearchPath(BWAPI::TilePosition start, BWAPI::TilePosition end);
 	std::vector<BWAPI::TilePosition> AstarSearchPath(BWAPI::TilePosition start, std::set<BWAPI::TilePosition> end);
+	// connected[i * targets.size() + j] says if the distance from sources[i] to targets[j] is wanted
+	void DijkstraDistanceMatrix(const std::vector<BWAPI::TilePosition>& sources, const std::vector<BWAPI::TilePosition>& targets,
+		const std::vector<char>& connected, RectangleArray<double>& matrix, bool parallel);
+	void clearDistanceMatrixScheduler(); // stops the threads of the parallel DijkstraDistanceMatrix
+	void clearChokeNodes(); // frees the tables of buildChokeNodes()
+	const ChokepointDistanceTable& getChokepointDistanceTable(); // built on first use
 }
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "ProcessLock.h"
+
+#include <algorithm>
+#include <cerrno>
+
+#ifndef _WIN32
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace BWTA
+{
+	static bool sharedAnalysis = false;
+
+	void setSharedAnalysis(bool enabled)
+	{
+		sharedAnalysis = enabled;
+	}
+
+	bool isSharedAnalysisEnabled()
+	{
+		return sharedAnalysis;
+	}
+
+#ifdef _WIN32
+	ProcessLock::ProcessLock()
+		: _locked(false), _mutexHandle(nullptr)
+	{}
+#else
+	ProcessLock::ProcessLock()
+		: _locked(false), _fd(-1)
+	{}
+#endif
+
+	ProcessLock::~ProcessLock()
+	{
+		unlock();
+	}
+
+#ifdef _WIN32
+	bool ProcessLock::lock(const std::string& name)
+	{
+		unlock();
+
+		// the name is a path, kernel object names cannot contain backslashes
+		std::string objectName(name);
+		std::replace(objectName.begin(), objectName.end(), '\\', '_');
+		std::replace(objectName.begin(), objectName.end(), '/', '_');
+		_mutexHandle = CreateMutexA(nullptr, FALSE, ("Local\\BWTA2_" + objectName).c_str());
+		if (_mutexHandle == nullptr) return false;
+
+		// WAIT_ABANDONED: the previous owner died, we own the mutex anyway
+		DWORD result = WaitForSingleObject(_mutexHandle, INFINITE);
+		if (result != WAIT_OBJECT_0 && result != WAIT_ABANDONED) {
+			CloseHandle(_mutexHandle);
+			_mutexHandle = nullptr;
+			return false;
+		}
+		_locked = true;
+		return true;
+	}
+
+	void ProcessLock::unlock()
+	{
+		if (_locked) ReleaseMutex(_mutexHandle);
+		if (_mutexHandle != nullptr) CloseHandle(_mutexHandle);
+		_locked = false;
+		_mutexHandle = nullptr;
+	}
+#else
+	bool ProcessLock::lock(const std::string& name)
+	{
+		unlock();
+
+		// the lock file is never deleted, removing it would let two processes lock different files
+		_fd = ::open((name + ".lock").c_str(), O_RDWR | O_CREAT, 0644);
+		if (_fd < 0) return false;
+
+		int result;
+		do {
+			result = flock(_fd, LOCK_EX);
+		} while (result != 0 && errno == EINTR);
+		if (result != 0) {
+			::close(_fd);
+			_fd = -1;
+			return false;
+		}
+		_locked = true;
+		return true;
+	}
+
+	void ProcessLock::unlock()
+	{
+		if (_locked) flock(_fd, LOCK_UN);
+		if (_fd >= 0) ::close(_fd);
+		_locked = false;
+		_fd = -1;
+	}
+#endif
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+namespace BWTA
+{
+	/**
+	 * Exclusive lock shared by all the processes of the host, identified by a file path.
+	 * On Windows it is a named mutex, elsewhere an flock() on <name>.lock. Both are released by
+	 * the OS if the owner dies, so a crashed bot never blocks the others.
+	 */
+	class ProcessLock
+	{
+	public:
+		ProcessLock();
+		~ProcessLock();
+
+		// blocks until the lock is acquired, returns false if it could not be created
+		bool lock(const std::string& name);
+		void unlock();
+
+		bool isLocked() const { return _locked; }
+
+	private:
+		// non-copyable
+		ProcessLock(const ProcessLock&);
+		ProcessLock& operator=(const ProcessLock&);
+
+		bool _locked;
+#ifdef _WIN32
+		void* _mutexHandle;
+#else
+		int _fd;
+#endif
+	};
+
+	// only one process analyses a map, the others wait for its cache file
+	bool isSharedAnalysisEnabled();
+}
@@ -3,13 +3,11 @@
 #include "Painter.h"
 #include <boost/geometry/index/rtree.hpp>
 #include "BWTA_Result.h"
+#include "AnalysisParameters.h"
 
 namespace BWTA
 {
 //	static const int SKIP_NEAR_BORDER = 3;
-	static const double DIFF_COEFICIENT = 0.31; // relative difference to consider a change between region<->chokepoint
-	static const int MIN_NODE_DIST = 7; // minimum distance between nodes
-	static const double MIN_REGION_OBST_DIST = 9.7; // minimum distance to object to be considered as a region
 // 	#define DEBUG_NODE_DETECTION  // uncomment to print node detection process
 
 	bool enoughDifference(const double& A, const double& B)
@@ -577,6 +575,41 @@ namespace BWTA
 		return stream.str();
 	}
 
+	void buildSkeleton(const RegionGraph& graph, Skeleton& skeleton)
+	{
+		// pruning leaves the removed nodes isolated, only keep the connected ones and isolated regions
+		std::vector<int> newId(graph.nodes.size(), Skeleton::INVALID_NODE);
+		std::vector<BWAPI::WalkPosition> positions;
+		std::vector<double> clearances;
+		std::vector<Skeleton::NodeType> types;
+		for (size_t id = 0; id < graph.nodes.size(); ++id) {
+			bool connected = id < graph.adjacencyList.size() && !graph.adjacencyList[id].empty();
+			if (!connected && graph.nodeType[id] != RegionGraph::REGION) continue;
+			newId[id] = static_cast<int>(positions.size());
+			positions.push_back(graph.nodes[id]);
+			clearances.push_back(graph.minDistToObstacle[id]);
+			switch (graph.nodeType[id]) {
+				case RegionGraph::REGION:     types.push_back(Skeleton::REGION);     break;
+				case RegionGraph::CHOKEPOINT: types.push_back(Skeleton::CHOKEPOINT); break;
+				default:                      types.push_back(Skeleton::NONE);       break;
+			}
+		}
+
+		std::vector<int> adjacencyStart(1, 0);
+		std::vector<int> adjacency;
+		for (size_t id = 0; id < graph.nodes.size(); ++id) {
+			if (newId[id] == Skeleton::INVALID_NODE) continue;
+			if (id < graph.adjacencyList.size()) {
+				for (const auto& neighbor : graph.adjacencyList[id]) {
+					if (newId[neighbor] != Skeleton::INVALID_NODE) adjacency.push_back(newId[neighbor]);
+				}
+			}
+			adjacencyStart.push_back(static_cast<int>(adjacency.size()));
+		}
+
+		skeleton.assign(positions, clearances, types, adjacencyStart, adjacency);
+	}
+
 	void simplifyGraph(const RegionGraph& graph, RegionGraph& graphSimplified)
 	{
 		// containers to mark visited nodes, and parent list
@@ -852,8 +885,7 @@ namespace BWTA
 		}
 
 		// expand (buffer) the choke lines to ensure they will "cross" regions
-		const double buffer_distance = 0.5;
-		boost::geometry::strategy::buffer::distance_symmetric<double> distance_strategy(buffer_distance);
+		boost::geometry::strategy::buffer::distance_symmetric<double> distance_strategy(CHOKE_BUFFER_DISTANCE);
 		boost::geometry::strategy::buffer::join_miter join_strategy;
 		boost::geometry::strategy::buffer::end_round end_strategy;
 		boost::geometry::strategy::buffer::point_square circle_strategy;
@@ -6,6 +6,7 @@
 #include "RegionImpl.h"
 #include "ChokepointImpl.h"
 #include "Utils.h"
+#include <BWTA/Skeleton.h>
 
 namespace BWTA
 {
@@ -52,6 +53,8 @@ namespace BWTA
 	void pruneGraph(RegionGraph& graph);
 	void detectNodes(RegionGraph& graph, const std::vector<Polygon*>& polygons);
 	void simplifyGraph(const RegionGraph& graph, RegionGraph& graphSimplified);
+	// compact copy of the pruned graph (without the pruned nodes) kept as BWTA_Result::skeleton
+	void buildSkeleton(const RegionGraph& graph, Skeleton& skeleton);
 	void mergeRegionNodes(RegionGraph& graph);
 	void getChokepointSides(const RegionGraph& graph, const bgi::rtree<BoostSegmentI, bgi::quadratic<16> >& rtree, std::map<nodeID, chokeSides_t>& chokepointSides);
 	void createRegionsFromGraph(const std::vector<BoostPolygon>& polygons, const RectangleArray<int>& labelMap,
@@ -0,0 +1,134 @@
+#include "RleColumnArray.h"
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define BWTA_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace BWTA
+{
+	void fillInt32(int* dst, size_t count, int value)
+	{
+#ifdef BWTA_USE_SSE2
+		// short runs are not worth the setup
+		if (count >= 16) {
+			// align the destination to 16 bytes
+			while ((reinterpret_cast<uintptr_t>(dst) & 15) != 0 && count > 0) {
+				*dst++ = value;
+				--count;
+			}
+			const __m128i v = _mm_set1_epi32(value);
+			for (; count >= 8; count -= 8, dst += 8) {
+				_mm_store_si128(reinterpret_cast<__m128i*>(dst), v);
+				_mm_store_si128(reinterpret_cast<__m128i*>(dst + 4), v);
+			}
+		}
+#endif
+		std::fill_n(dst, count, value);
+	}
+
+	void RleColumnArray::clear()
+	{
+		_width = 0;
+		_height = 0;
+		_columnStart.clear();
+		_runEnd.clear();
+		_runValue.clear();
+	}
+
+	void RleColumnArray::encode(const RectangleArray<int>& grid)
+	{
+		clear();
+		_width = grid.getWidth();
+		_height = grid.getHeight();
+		_columnStart.reserve(_width + 1);
+		for (unsigned int x = 0; x < _width; ++x) {
+			_columnStart.push_back(static_cast<int32_t>(_runValue.size()));
+			const int* column = grid[x];
+			unsigned int y = 0;
+			while (y < _height) {
+				int value = column[y];
+				unsigned int end = y + 1;
+				while (end < _height && column[end] == value) ++end;
+				_runEnd.push_back(end);
+				_runValue.push_back(value);
+				y = end;
+			}
+		}
+		_columnStart.push_back(static_cast<int32_t>(_runValue.size()));
+	}
+
+	void RleColumnArray::decode(RectangleArray<int>& grid) const
+	{
+		grid.resize(_width, _height);
+		for (unsigned int x = 0; x < _width; ++x) {
+			int* column = grid[x];
+			int32_t begin = 0;
+			for (int32_t run = _columnStart[x]; run < _columnStart[x + 1]; ++run) {
+				fillInt32(column + begin, _runEnd[run] - begin, _runValue[run]);
+				begin = _runEnd[run];
+			}
+		}
+	}
+
+	int RleColumnArray::getItem(unsigned int x, unsigned int y) const
+	{
+		auto first = _runEnd.begin() + _columnStart[x];
+		auto last = _runEnd.begin() + _columnStart[x + 1];
+		// first run whose end is past y
+		auto it = std::upper_bound(first, last, static_cast<int32_t>(y));
+		return _runValue[it - _runEnd.begin()];
+	}
+
+	size_t RleColumnArray::byteSize() const
+	{
+		return (3 + _columnStart.size() + _runEnd.size() + _runValue.size()) * sizeof(int32_t);
+	}
+
+	void RleColumnArray::write(CacheWriter& out) const
+	{
+		out.writeInt(_width);
+		out.writeInt(_height);
+		out.writeInt(_runValue.size());
+		for (const auto& start : _columnStart) out.writeInt(start);
+		for (const auto& end : _runEnd) out.writeInt(end);
+		for (const auto& value : _runValue) out.writeInt(value);
+	}
+
+	bool RleColumnArray::read(SectionCursor& in, unsigned int maxWidth, unsigned int maxHeight)
+	{
+		clear();
+		int width = in.readInt();
+		int height = in.readInt();
+		int runCount = in.readCount(2 * sizeof(int32_t));
+		if (!in.ok() || width <= 0 || height <= 0) return false;
+		if ((unsigned int)width > maxWidth || (unsigned int)height > maxHeight) return false;
+		// the column starts and the runs must fit in what is left of the section before allocating them
+		if ((size_t)width + 1 + 2 * (size_t)runCount > in.remaining() / sizeof(int32_t)) return false;
+		_columnStart.resize(width + 1);
+		_runEnd.resize(runCount);
+		_runValue.resize(runCount);
+		for (auto& start : _columnStart) start = in.readInt();
+		for (auto& end : _runEnd) end = in.readInt();
+		for (auto& value : _runValue) value = in.readInt();
+		if (!in.ok()) {
+			clear();
+			return false;
+		}
+
+		// validate, so decode() and getItem() never go out of bounds
+		if (_columnStart.front() != 0 || _columnStart.back() != runCount) { clear(); return false; }
+		for (int x = 0; x < width; ++x) {
+			if (_columnStart[x] >= _columnStart[x + 1]) { clear(); return false; }
+			int32_t previous = 0;
+			for (int32_t run = _columnStart[x]; run < _columnStart[x + 1]; ++run) {
+				if (_runEnd[run] <= previous || _runEnd[run] > height) { clear(); return false; }
+				previous = _runEnd[run];
+			}
+			if (previous != height) { clear(); return false; }
+		}
+		_width = width;
+		_height = height;
+		return true;
+	}
+}
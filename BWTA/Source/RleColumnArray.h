@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CacheFile.h"
+
+namespace BWTA
+{
+	/**
+	 * Column-wise run-length encoding of a RectangleArray<int>.
+	 * Label maps are mostly long vertical runs of the same value, so they compress several times over.
+	 * Runs are kept as flat int32 arrays: decoding is a sequence of (vectorised) fills and
+	 * getItem() does a binary search inside the runs of one column, so it can also be used as a
+	 * compact in-memory replacement of the dense array.
+	 */
+	class RleColumnArray
+	{
+	public:
+		RleColumnArray() : _width(0), _height(0) {}
+
+		void encode(const RectangleArray<int>& grid);
+		void decode(RectangleArray<int>& grid) const;
+		int getItem(unsigned int x, unsigned int y) const;
+
+		unsigned int getWidth() const { return _width; }
+		unsigned int getHeight() const { return _height; }
+		size_t getRunCount() const { return _runValue.size(); }
+		bool empty() const { return _width == 0; }
+		void clear();
+
+		// size in bytes of the serialized (and in-memory) runs
+		size_t byteSize() const;
+
+		void write(CacheWriter& out) const;
+		// fails on a grid larger than maxWidth x maxHeight or runs that do not fit in the section
+		bool read(SectionCursor& in, unsigned int maxWidth, unsigned int maxHeight);
+
+	private:
+		unsigned int _width;
+		unsigned int _height;
+		std::vector<int32_t> _columnStart;	// index of the first run of each column (width + 1 entries)
+		std::vector<int32_t> _runEnd;		// y (exclusive) where each run ends inside its column
+		std::vector<int32_t> _runValue;
+	};
+
+	// Sets count ints starting at dst to value (SSE2 stores when available)
+	void fillInt32(int* dst, size_t count, int value);
+}
@@ -0,0 +1,156 @@
+#include <BWTA/Skeleton.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace BWTA
+{
+	const int Skeleton::INVALID_NODE;
+
+	static const int BUCKET_SIZE = 16; // walk tiles per bucket side
+
+	void Skeleton::assign(const std::vector<BWAPI::WalkPosition>& positions, const std::vector<double>& clearances,
+		const std::vector<NodeType>& types, const std::vector<int>& adjacencyStart, const std::vector<int>& adjacency)
+	{
+		_positions = positions;
+		_clearances = clearances;
+		_types = types;
+		_adjacencyStart = adjacencyStart;
+		_adjacency = adjacency;
+		buildBuckets();
+	}
+
+	void Skeleton::clear()
+	{
+		_positions.clear();
+		_clearances.clear();
+		_types.clear();
+		_adjacencyStart.clear();
+		_adjacency.clear();
+		_bucketColumns = 0;
+		_bucketRows = 0;
+		_bucketStart.clear();
+		_bucketNodes.clear();
+	}
+
+	void Skeleton::buildBuckets()
+	{
+		_bucketColumns = 0;
+		_bucketRows = 0;
+		for (const auto& pos : _positions) {
+			_bucketColumns = std::max(_bucketColumns, pos.x / BUCKET_SIZE + 1);
+			_bucketRows = std::max(_bucketRows, pos.y / BUCKET_SIZE + 1);
+		}
+
+		// counting sort of the nodes by bucket
+		_bucketStart.assign(_bucketColumns * _bucketRows + 1, 0);
+		for (const auto& pos : _positions) {
+			_bucketStart[(pos.x / BUCKET_SIZE) * _bucketRows + pos.y / BUCKET_SIZE + 1]++;
+		}
+		for (size_t i = 1; i < _bucketStart.size(); ++i) _bucketStart[i] += _bucketStart[i - 1];
+		_bucketNodes.resize(_positions.size());
+		std::vector<int> next(_bucketStart.begin(), _bucketStart.end() - 1);
+		for (int node = 0; node < size(); ++node) {
+			const BWAPI::WalkPosition& pos = _positions[node];
+			_bucketNodes[next[(pos.x / BUCKET_SIZE) * _bucketRows + pos.y / BUCKET_SIZE]++] = node;
+		}
+	}
+
+	int Skeleton::getNearestNode(const BWAPI::WalkPosition& pos) const
+	{
+		if (empty()) return INVALID_NODE;
+
+		int cx = std::min(std::max(pos.x / BUCKET_SIZE, 0), _bucketColumns - 1);
+		int cy = std::min(std::max(pos.y / BUCKET_SIZE, 0), _bucketRows - 1);
+		int best = INVALID_NODE;
+		int bestDist2 = std::numeric_limits<int>::max();
+		int maxRing = std::max(_bucketColumns, _bucketRows);
+		for (int ring = 0; ring <= maxRing; ++ring) {
+			for (int x = cx - ring; x <= cx + ring; ++x) {
+				if (x < 0 || x >= _bucketColumns) continue;
+				// only the border of the ring
+				int step = (x == cx - ring || x == cx + ring) ? 1 : 2 * ring;
+				for (int y = cy - ring; y <= cy + ring; y += std::max(step, 1)) {
+					if (y < 0 || y >= _bucketRows) continue;
+					int bucket = x * _bucketRows + y;
+					for (int i = _bucketStart[bucket]; i < _bucketStart[bucket + 1]; ++i) {
+						int node = _bucketNodes[i];
+						int dx = _positions[node].x - pos.x;
+						int dy = _positions[node].y - pos.y;
+						int dist2 = dx * dx + dy * dy;
+						if (dist2 < bestDist2) {
+							bestDist2 = dist2;
+							best = node;
+						}
+					}
+				}
+			}
+			// nodes in the next rings are at least ring * BUCKET_SIZE away
+			int reach = ring * BUCKET_SIZE;
+			if (best != INVALID_NODE && bestDist2 <= reach * reach) break;
+		}
+		return best;
+	}
+
+	std::vector<int> Skeleton::walk(int node, int next, int maxNodes) const
+	{
+		std::vector<int> path;
+		if (node < 0 || node >= size() || next < 0 || next >= size()) return path;
+		path.push_back(node);
+		int previous = node;
+		int current = next;
+		while (maxNodes == 0 || (int)path.size() < maxNodes) {
+			path.push_back(current);
+			if (getDegree(current) != 2 || current == node) break;
+			const int* neighbors = getNeighbors(current);
+			int following = (neighbors[0] == previous) ? neighbors[1] : neighbors[0];
+			previous = current;
+			current = following;
+		}
+		return path;
+	}
+
+	std::vector<int> Skeleton::getPath(int start, int end) const
+	{
+		std::vector<int> path;
+		if (start < 0 || start >= size() || end < 0 || end >= size()) return path;
+
+		// A* with euclidean edge lengths
+		auto distance = [this](int a, int b) {
+			double dx = _positions[a].x - _positions[b].x;
+			double dy = _positions[a].y - _positions[b].y;
+			return std::sqrt(dx * dx + dy * dy);
+		};
+		std::vector<double> cost(size(), std::numeric_limits<double>::max());
+		std::vector<int> parent(size(), INVALID_NODE);
+		typedef std::pair<double, int> QueueItem;
+		std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem> > open;
+		cost[start] = 0;
+		open.push(QueueItem(distance(start, end), start));
+		while (!open.empty()) {
+			int current = open.top().second;
+			double estimate = open.top().first;
+			open.pop();
+			if (current == end) break;
+			if (estimate - distance(current, end) > cost[current] + 1e-9) continue; // outdated entry
+			const int* neighbors = getNeighbors(current);
+			for (int i = 0; i < getDegree(current); ++i) {
+				int neighbor = neighbors[i];
+				double newCost = cost[current] + distance(current, neighbor);
+				if (newCost < cost[neighbor]) {
+					cost[neighbor] = newCost;
+					parent[neighbor] = current;
+					open.push(QueueItem(newCost + distance(neighbor, end), neighbor));
+				}
+			}
+		}
+		if (start != end && parent[end] == INVALID_NODE) return path;
+
+		for (int node = end; node != INVALID_NODE; node = parent[node]) path.push_back(node);
+		std::reverse(path.begin(), path.end());
+		return path;
+	}
+}
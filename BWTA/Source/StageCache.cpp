@@ -0,0 +1,239 @@
+#include "StageCache.h"
+
+#include "AnalysisParameters.h"
+#include "BWTA_Result.h"
+#include "LoadData.h"
+#include "filesystem/path.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace BWTA
+{
+	static bool analysisCheckpoints = false;
+
+	void setAnalysisCheckpoints(bool enabled)
+	{
+		analysisCheckpoints = enabled;
+	}
+
+	bool areAnalysisCheckpointsEnabled()
+	{
+		return analysisCheckpoints;
+	}
+
+	// sections only used by the checkpoints, the rest reuse the ids of the cache file
+	enum StageSectionId : uint32_t {
+		STAGE_BOOST_POLYGONS = 100,
+		STAGE_GRAPH_NODES,
+		STAGE_CHOKEPOINT_SIDES
+	};
+
+	static void writeRing(CacheWriter& out, const BoostPolygon::ring_type& ring)
+	{
+		out.writeInt(ring.size());
+		for (const auto& p : ring) {
+			out.writeDouble(p.x());
+			out.writeDouble(p.y());
+		}
+	}
+
+	static void readRing(SectionCursor& in, BoostPolygon::ring_type& ring)
+	{
+		int size = in.readCount(2 * sizeof(double));
+		ring.reserve(size);
+		for (int i = 0; i < size; ++i) {
+			double x = in.readDouble();
+			double y = in.readDouble();
+			ring.emplace_back(x, y);
+		}
+	}
+
+	static void writeNodeSet(CacheWriter& out, const std::set<nodeID>& nodes)
+	{
+		out.writeInt(nodes.size());
+		for (const auto& id : nodes) out.writeInt(id);
+	}
+
+	static bool readNodeSet(SectionCursor& in, std::set<nodeID>& nodes, int nodeCount)
+	{
+		int size = in.readCount();
+		for (int i = 0; i < size; ++i) {
+			int id = in.readInt();
+			if (id < 0 || id >= nodeCount) return false;
+			nodes.insert(id);
+		}
+		return in.ok();
+	}
+
+	StageCache::StageCache(const std::string& directory)
+		: _index(directory, ".stage")
+	{
+		filesystem::path folder(filesystem::path::get_cwd() / directory);
+		if (!folder.exists()) folder.mkdirp();
+		_index.load();
+
+		Fnv1a hasher;
+		hasher.add(BWTA_FILE_VERSION);
+		hasher.add(MapData::rawWalkability);
+		hasher.add(MapData::walkability);
+		for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+			// chained: a stage key changes whenever the key of any previous stage changes
+			hasher.add(static_cast<int32_t>(stage));
+			switch (stage) {
+				case STAGE_POLYGONS: hashPolygonParameters(hasher); break;
+				case STAGE_GRAPH:    hashGraphParameters(hasher);   break;
+				case STAGE_REGIONS:  hashRegionParameters(hasher);  break;
+			}
+			std::ostringstream key;
+			key << std::hex << std::setw(16) << std::setfill('0') << hasher.value();
+			_keys[stage] = key.str();
+		}
+	}
+
+	AnalysisStage StageCache::resume(AnalysisState& state)
+	{
+		for (int stage = STAGE_COUNT - 1; stage >= 0; --stage) {
+			if (!filesystem::path(_index.fileName(_keys[stage])).exists()) continue;
+			if (load(static_cast<AnalysisStage>(stage), state)) {
+				_index.touch(_keys[stage]);
+				_index.save();
+				return static_cast<AnalysisStage>(stage);
+			}
+			LOG("WARNING analysis checkpoint " << _keys[stage] << " is corrupted");
+		}
+		return STAGE_NONE;
+	}
+
+	bool StageCache::load(AnalysisStage stage, AnalysisState& state)
+	{
+		CacheReader in;
+		if (!in.open(_index.fileName(_keys[stage]), BWTA_FILE_VERSION)) return false;
+		if (in.getWidth() != MapData::mapWidthTileRes || in.getHeight() != MapData::mapHeightTileRes) return false;
+
+		// everything is read into temporaries first, so a corrupted file leaves no partial state
+		std::vector<BoostPolygon> boostPolygons;
+		SectionCursor polygonsIn = in.section(STAGE_BOOST_POLYGONS);
+		int polygonCount = polygonsIn.readCount();
+		for (int i = 0; i < polygonCount && polygonsIn.ok(); ++i) {
+			boostPolygons.emplace_back();
+			readRing(polygonsIn, boostPolygons.back().outer());
+			int innerCount = polygonsIn.readCount();
+			boostPolygons.back().inners().resize(innerCount);
+			for (auto& inner : boostPolygons.back().inners()) readRing(polygonsIn, inner);
+		}
+		if (!polygonsIn.ok()) return false;
+
+		RectangleArray<int> obstacleLabelMap;
+		if (!in.attachGrid(CacheFile::OBSTACLE_LABEL_MAP, obstacleLabelMap)) return false;
+
+		RegionGraph graph;
+		std::map<nodeID, chokeSides_t> chokepointSides;
+		if (stage == STAGE_GRAPH) {
+			SectionCursor graphIn = in.section(STAGE_GRAPH_NODES);
+			int nodeCount = graphIn.readCount(4 * sizeof(int32_t) + sizeof(double));
+			for (int i = 0; i < nodeCount && graphIn.ok(); ++i) {
+				graph.nodes.push_back(graphIn.readPoint<BWAPI::WalkPosition>());
+				graph.minDistToObstacle.push_back(graphIn.readDouble());
+				int type = graphIn.readInt();
+				if (type < RegionGraph::NONE || type > RegionGraph::CHOKEGATEB) return false;
+				graph.nodeType.push_back(static_cast<RegionGraph::NodeType>(type));
+				graph.adjacencyList.emplace_back();
+				if (!readNodeSet(graphIn, graph.adjacencyList.back(), nodeCount)) return false;
+			}
+			bool ok = graphIn.ok()
+				&& readNodeSet(graphIn, graph.regionNodes, nodeCount)
+				&& readNodeSet(graphIn, graph.chokeNodes, nodeCount)
+				&& readNodeSet(graphIn, graph.gateNodesA, nodeCount)
+				&& readNodeSet(graphIn, graph.gateNodesB, nodeCount);
+			if (!ok) return false;
+
+			SectionCursor sidesIn = in.section(STAGE_CHOKEPOINT_SIDES);
+			int sideCount = sidesIn.readCount(5 * sizeof(int32_t));
+			for (int i = 0; i < sideCount; ++i) {
+				int id = sidesIn.readInt();
+				if (id < 0 || id >= nodeCount) return false;
+				BWAPI::WalkPosition side1 = sidesIn.readPoint<BWAPI::WalkPosition>();
+				BWAPI::WalkPosition side2 = sidesIn.readPoint<BWAPI::WalkPosition>();
+				chokepointSides.emplace(id, chokeSides_t(side1, side2));
+			}
+			if (!sidesIn.ok()) return false;
+		}
+
+		if (stage >= STAGE_GRAPH && !load_skeleton(in)) return false;
+
+		RectangleArray<int> regionLabelMap;
+		if (stage == STAGE_REGIONS) {
+			if (!in.attachGrid(CacheFile::REGION_LABEL_MAP, regionLabelMap) || !load_regions(in)) {
+				BWTA_Result::skeleton.clear();
+				return false;
+			}
+			BWTA_Result::regionLabelMap = regionLabelMap; // copy, the file is closed on return
+		}
+
+		state.boostPolygons.swap(boostPolygons);
+		state.graphSimplified = graph;
+		state.chokepointSides.swap(chokepointSides);
+		BWTA_Result::obstacleLabelMap = obstacleLabelMap;
+		return true;
+	}
+
+	void StageCache::save(AnalysisStage stage, const AnalysisState& state)
+	{
+		CacheWriter out;
+
+		out.beginSection(STAGE_BOOST_POLYGONS);
+		out.writeInt(state.boostPolygons.size());
+		for (const auto& polygon : state.boostPolygons) {
+			writeRing(out, polygon.outer());
+			out.writeInt(polygon.inners().size());
+			for (const auto& inner : polygon.inners()) writeRing(out, inner);
+		}
+		out.endSection();
+
+		out.writeGridSection(CacheFile::OBSTACLE_LABEL_MAP, BWTA_Result::obstacleLabelMap);
+
+		if (stage == STAGE_GRAPH) {
+			const RegionGraph& graph = state.graphSimplified;
+			out.beginSection(STAGE_GRAPH_NODES);
+			out.writeInt(graph.nodes.size());
+			for (size_t i = 0; i < graph.nodes.size(); ++i) {
+				out.writePoint(graph.nodes[i]);
+				out.writeDouble(graph.minDistToObstacle[i]);
+				out.writeInt(graph.nodeType[i]);
+				writeNodeSet(out, graph.adjacencyList[i]);
+			}
+			writeNodeSet(out, graph.regionNodes);
+			writeNodeSet(out, graph.chokeNodes);
+			writeNodeSet(out, graph.gateNodesA);
+			writeNodeSet(out, graph.gateNodesB);
+			out.endSection();
+
+			out.beginSection(STAGE_CHOKEPOINT_SIDES);
+			out.writeInt(state.chokepointSides.size());
+			for (const auto& sides : state.chokepointSides) {
+				out.writeInt(sides.first);
+				out.writePoint(sides.second.side1);
+				out.writePoint(sides.second.side2);
+			}
+			out.endSection();
+		}
+
+		// the skeleton is built together with the graph
+		if (stage >= STAGE_GRAPH) save_skeleton(out);
+
+		if (stage == STAGE_REGIONS) {
+			out.writeGridSection(CacheFile::REGION_LABEL_MAP, BWTA_Result::regionLabelMap);
+			save_regions(out);
+		}
+
+		const std::string& key = _keys[stage];
+		if (!out.save(_index.fileName(key), BWTA_FILE_VERSION, MapData::mapWidthTileRes, MapData::mapHeightTileRes)) {
+			LOG("WARNING could not save analysis checkpoint " << key);
+			return;
+		}
+		_index.touch(key);
+		_index.evict(getCacheSizeLimit(), key);
+		_index.save();
+	}
+}
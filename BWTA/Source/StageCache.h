@@ -0,0 +1,48 @@
+#pragma once
+
+#include "RegionGenerator.h"
+#include "CacheIndex.h"
+
+namespace BWTA
+{
+	/**
+	 * Stages of analyze_map() that can be checkpointed. Each checkpoint holds everything the
+	 * following stages need:
+	 *   STAGE_POLYGONS : obstacle polygons and obstacleLabelMap
+	 *   STAGE_GRAPH    : + skeleton, simplified region graph and chokepoint sides (Voronoi ... wall-off)
+	 *   STAGE_REGIONS  : + regions, chokepoints and regionLabelMap (without the graph)
+	 * Base locations, closest maps and coverage points are not checkpointed, the final cache
+	 * file already covers a complete run.
+	 */
+	enum AnalysisStage { STAGE_NONE = -1, STAGE_POLYGONS, STAGE_GRAPH, STAGE_REGIONS, STAGE_COUNT };
+
+	// intermediate results passed between the stages of analyze_map()
+	struct AnalysisState {
+		std::vector<BoostPolygon> boostPolygons;
+		RegionGraph graphSimplified;
+		std::map<nodeID, chokeSides_t> chokepointSides;
+	};
+
+	bool areAnalysisCheckpointsEnabled();
+
+	/**
+	 * Checkpoint files of analyze_map() in <directory> (same format as the cache file).
+	 * The key of a stage hashes the terrain, the key of the previous stage and the parameters of
+	 * the stage, so a run resumes after the last stage whose inputs did not change.
+	 */
+	class StageCache
+	{
+	public:
+		explicit StageCache(const std::string& directory);
+
+		// loads the latest available checkpoint into state and BWTA_Result, returns its stage
+		AnalysisStage resume(AnalysisState& state);
+		void save(AnalysisStage stage, const AnalysisState& state);
+
+	private:
+		bool load(AnalysisStage stage, AnalysisState& state);
+
+		std::string _keys[STAGE_COUNT];
+		CacheIndex _index;
+	};
+}
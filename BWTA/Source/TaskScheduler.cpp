@@ -0,0 +1,148 @@
+#include "TaskScheduler.h"
+
+#include <algorithm>
+
+namespace BWTA
+{
+	static unsigned int analysisThreadCount = 0;
+
+	void setAnalysisThreadCount(unsigned int threads)
+	{
+		analysisThreadCount = threads;
+	}
+
+	unsigned int getAnalysisThreadCount()
+	{
+		return analysisThreadCount;
+	}
+
+	//------------------------------------------------ GRAPH ------------------------------------------------
+
+	TaskGraph::TaskId TaskGraph::add(const std::function<void()>& work, const Dependencies& dependencies)
+	{
+		TaskId id = static_cast<TaskId>(_tasks.size());
+		_tasks.emplace_back(new Task());
+		Task* task = _tasks.back().get();
+		task->work = work;
+		task->dependencyCount = static_cast<int>(dependencies.size());
+		for (const auto& dependency : dependencies) {
+			assert(dependency >= 0 && dependency < id);
+			_tasks[dependency]->successors.push_back(task);
+		}
+		return id;
+	}
+
+	TaskGraph::TaskId TaskGraph::addParallelFor(const std::function<int()>& count, const std::function<void(int)>& body,
+		int chunks, const Dependencies& dependencies)
+	{
+		Dependencies chunkTasks;
+		for (int chunk = 0; chunk < chunks; ++chunk) {
+			chunkTasks.push_back(add([count, body, chunk, chunks]() {
+				int end = count();
+				for (int i = chunk; i < end; i += chunks) body(i);
+			}, dependencies));
+		}
+		return add([]() {}, chunkTasks);
+	}
+
+	//---------------------------------------------- SCHEDULER ----------------------------------------------
+
+	TaskScheduler::TaskScheduler(unsigned int threadCount)
+		: _queuedTasks(0), _remainingTasks(0), _stop(false)
+	{
+		if (threadCount == 0) threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+		for (unsigned int i = 0; i < threadCount; ++i) _queues.emplace_back(new WorkQueue());
+		for (unsigned int i = 1; i < threadCount; ++i) _threads.emplace_back(&TaskScheduler::workerLoop, this, i);
+	}
+
+	TaskScheduler::~TaskScheduler()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_sleepMutex);
+			_stop = true;
+		}
+		_wakeUp.notify_all();
+		for (auto& thread : _threads) thread.join();
+	}
+
+	void TaskScheduler::run(TaskGraph& graph)
+	{
+		if (graph._tasks.empty()) return;
+
+		_remainingTasks.store(static_cast<int>(graph._tasks.size()));
+		for (auto& task : graph._tasks) task->pendingDependencies.store(task->dependencyCount);
+		for (auto& task : graph._tasks) {
+			if (task->dependencyCount == 0) push(0, task.get());
+		}
+
+		while (_remainingTasks.load() > 0) {
+			TaskGraph::Task* task = pop(0);
+			if (task != nullptr) {
+				execute(0, task);
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(_sleepMutex);
+			_wakeUp.wait(lock, [this]() { return _queuedTasks.load() > 0 || _remainingTasks.load() == 0; });
+		}
+	}
+
+	void TaskScheduler::workerLoop(unsigned int index)
+	{
+		while (true) {
+			TaskGraph::Task* task = pop(index);
+			if (task != nullptr) {
+				execute(index, task);
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(_sleepMutex);
+			_wakeUp.wait(lock, [this]() { return _stop || _queuedTasks.load() > 0; });
+			if (_stop) return;
+		}
+	}
+
+	void TaskScheduler::push(unsigned int index, TaskGraph::Task* task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+			_queues[index]->tasks.push_back(task);
+		}
+		_queuedTasks.fetch_add(1);
+		// taking the lock orders the notification after the predicate check of a thread going to sleep
+		{ std::lock_guard<std::mutex> lock(_sleepMutex); }
+		_wakeUp.notify_all();
+	}
+
+	TaskGraph::Task* TaskScheduler::pop(unsigned int index)
+	{
+		const unsigned int threadCount = getThreadCount();
+		for (unsigned int i = 0; i < threadCount; ++i) {
+			const unsigned int victim = (index + i) % threadCount;
+			WorkQueue& queue = *_queues[victim];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (queue.tasks.empty()) continue;
+			TaskGraph::Task* task;
+			if (victim == index) {
+				task = queue.tasks.back();
+				queue.tasks.pop_back();
+			} else {
+				task = queue.tasks.front();
+				queue.tasks.pop_front();
+			}
+			_queuedTasks.fetch_sub(1);
+			return task;
+		}
+		return nullptr;
+	}
+
+	void TaskScheduler::execute(unsigned int index, TaskGraph::Task* task)
+	{
+		task->work();
+		for (auto successor : task->successors) {
+			if (successor->pendingDependencies.fetch_sub(1) == 1) push(index, successor);
+		}
+		if (_remainingTasks.fetch_sub(1) == 1) {
+			std::lock_guard<std::mutex> lock(_sleepMutex);
+			_wakeUp.notify_all();
+		}
+	}
+}
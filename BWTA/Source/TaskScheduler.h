@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace BWTA
+{
+	/**
+	 * Set of tasks with dependencies (a DAG, a task can only depend on tasks added before it).
+	 * A task starts once all its dependencies finished. Tasks that can run at the same time must
+	 * write disjoint data, then the result does not depend on the number of threads.
+	 */
+	class TaskGraph
+	{
+	public:
+		typedef int TaskId;
+		typedef std::vector<TaskId> Dependencies;
+
+		TaskId add(const std::function<void()>& work, const Dependencies& dependencies = Dependencies());
+		/**
+		 * Adds chunks tasks that call body(i) for every i in [0, count()), chunk c takes the indices
+		 * i % chunks == c. count is evaluated when the dependencies are done, so it can be the size of
+		 * something they produce. Returns a task that finishes after all the chunks.
+		 */
+		TaskId addParallelFor(const std::function<int()>& count, const std::function<void(int)>& body,
+			int chunks, const Dependencies& dependencies = Dependencies());
+
+		size_t size() const { return _tasks.size(); }
+
+	private:
+		friend class TaskScheduler;
+
+		struct Task {
+			std::function<void()> work;
+			std::vector<Task*> successors;
+			int dependencyCount;
+			std::atomic<int> pendingDependencies;
+		};
+		std::vector<std::unique_ptr<Task>> _tasks;
+	};
+
+	/**
+	 * Work-stealing thread pool: each thread pushes the tasks it unlocks to the back of its own queue
+	 * and runs them from there (LIFO, the data is still in cache), idle threads steal from the front
+	 * of the other queues.
+	 */
+	class TaskScheduler
+	{
+	public:
+		// threadCount includes the thread calling run(), 0 = one per core
+		explicit TaskScheduler(unsigned int threadCount = 0);
+		~TaskScheduler();
+
+		unsigned int getThreadCount() const { return static_cast<unsigned int>(_queues.size()); }
+		// runs every task of graph, the calling thread takes part; returns when all of them are done
+		void run(TaskGraph& graph);
+
+	private:
+		// non-copyable
+		TaskScheduler(const TaskScheduler&);
+		TaskScheduler& operator=(const TaskScheduler&);
+
+		struct WorkQueue {
+			std::mutex mutex;
+			std::deque<TaskGraph::Task*> tasks;
+		};
+
+		void workerLoop(unsigned int index);
+		void push(unsigned int index, TaskGraph::Task* task);
+		TaskGraph::Task* pop(unsigned int index);
+		void execute(unsigned int index, TaskGraph::Task* task);
+
+		std::vector<std::unique_ptr<WorkQueue>> _queues; // _queues[0] belongs to the thread calling run()
+		std::vector<std::thread> _threads;
+		std::mutex _sleepMutex;
+		std::condition_variable _wakeUp;
+		std::atomic<int> _queuedTasks;
+		std::atomic<int> _remainingTasks;
+		bool _stop; // guarded by _sleepMutex
+	};
+
+	// number of threads used by analyze_map(), see setAnalysisThreadCount
+	unsigned int getAnalysisThreadCount();
+}
@@ -8,50 +8,223 @@
 #include "PolygonGenerator.h"
 #include "RegionGenerator.h"
 #include "ClosestObjectMap.h"
+#include "CacheIndex.h"
+#include "StageCache.h"
+#include "ProcessLock.h"
+#include "ObstacleOverlay.h"
+#include "TaskScheduler.h"
 #include "filesystem/path.h"
 
+#include <atomic>
+#include <memory>
+#include <thread>
+
 namespace BWTA
 {
 	void analyze_map();
 
-	void analyze()
+	// progress of the current analysis (AnalysisStep), published with release semantics so a thread
+	// that sees a step also sees the results written before it
+	static std::atomic<int> analysisStep(ANALYSIS_NOT_STARTED);
+	static std::atomic<bool> analysisRunDone(false); // runAnalysis() returned, finishAnalysis() is pending
+	static std::thread analysisThread;
+
+	static void setAnalysisStep(AnalysisStep step)
 	{
-		cleanMemory();
-		Timer timer;
+		analysisStep.store(step, std::memory_order_release);
+	}
+
+	// first part of analyze(), it calls BWAPI so it runs on the caller thread
+	static void prepareAnalysis()
+	{
+		clearResults(); // analyze() already waited for the previous analysis
+		// the analysis reads lowResWalkability (and caches what it builds from it) until finishAnalysis()
+		getObstacleOverlay().beginDeferral();
+		setAnalysisStep(ANALYSIS_NOT_STARTED);
+		analysisRunDone.store(false);
 
 #ifndef OFFLINE
 		loadMapFromBWAPI();
 #endif
 		
 		loadMap(); // compute extra map info
+	}
+
+	// loads the cache file or analyzes the map, it only uses MapData so it can run on a worker thread
+	static void runAnalysis()
+	{
+		Timer timer;
 
 		// Verify if "BWTA2" directory exists, and create it if it doesn't.
 		std::string bwtaPath(BWTA_PATH);
 		filesystem::path bwtaFolder(filesystem::path::get_cwd() / bwtaPath);
 		if (!bwtaFolder.exists()) bwtaFolder.mkdirp();
 
-		std::string filename = bwtaPath + MapData::hash + ".bwta";
+		// the cache is keyed by the terrain and the analysis parameters instead of the map file hash
+		std::string cacheKey = computeCacheKey();
+		CacheIndex cacheIndex(bwtaPath);
+		std::string filename = cacheIndex.fileName(cacheKey);
+		LOG("Map hash " << MapData::hash << ", cache key " << cacheKey);
+
+		// with shared analysis only one process at a time checks, analyses and saves a map, so the bots
+		// started while the first one is analysing just wait and then map its cache file
+		ProcessLock analysisLock;
+		if (isSharedAnalysisEnabled() && !analysisLock.lock(bwtaPath + cacheKey)) {
+			LOG("WARNING could not lock the analysis of " << cacheKey << ", analysing anyway");
+		}
+
+		bool loaded = false;
+		if (isFileVersionCorrect(filename)) {
+			LOG("Recognized map, loading map data...");
 
-//		if (isFileVersionCorrect(filename)) {
-//			LOG("Recognized map, loading map data...");
-//
-//			timer.start();
-//			load_data(filename);
-//			LOG("Loaded map data in " << timer.stopAndGetTime() << " seconds");
-//		} else {
+			timer.start();
+			loaded = load_data(filename);
+			if (loaded) LOG("Loaded map data in " << timer.stopAndGetTime() << " seconds");
+		}
+
+		if (!loaded) {
 			LOG("Analyzing new map...");
 
 			timer.start();
 			analyze_map();
 			LOG("Map analyzed in " << timer.stopAndGetTime() << " seconds");
 
-// 			save_data(filename);
-// 			LOG("Saved map data.");
-//		}
+			if (save_data(filename)) {
+				LOG("Saved map data.");
+			} else {
+				LOG("WARNING could not save map data to " << filename);
+			}
+		}
+
+		// every process reads, updates and writes the index under the same lock (shared analysis or
+		// not), otherwise two bots ending together would lose each other's updates
+		ProcessLock indexLock;
+		if (!indexLock.lock(bwtaPath + "cache.index")) LOG("WARNING could not lock the cache index");
+		cacheIndex.load();
+		cacheIndex.touch(cacheKey);
+		cacheIndex.evict(getCacheSizeLimit(), cacheKey);
+		if (!cacheIndex.save()) LOG("WARNING could not save the cache index");
+		indexLock.unlock();
+		analysisLock.unlock();
+
+		if (loaded) setAnalysisStep(ANALYSIS_CLOSEST_MAPS);
+		analysisRunDone.store(true, std::memory_order_release);
+	}
 
+	// last part of analyze(), on the caller thread again
+	static void finishAnalysis()
+	{
+		// a loaded cache is already compact (see load_data)
+		if (BWTA_Result::compactLabelMaps && !BWTA_Result::pendingMembers[BWTA_Result::LAZY_REGION_LABEL].load()) {
+			BWTA_Result::compressLabelMaps();
+		}
 #ifndef OFFLINE
 		attachResourcePointersToBaseLocations(BWTA_Result::baselocations);
 #endif
+		setAnalysisStep(ANALYSIS_DONE);
+		getObstacleOverlay().endDeferral();
+	}
+
+	void analyze()
+	{
+		waitForAnalysis();
+		prepareAnalysis();
+		runAnalysis();
+		finishAnalysis();
+	}
+
+	void analyzeAsync()
+	{
+		waitForAnalysis();
+		prepareAnalysis();
+		analysisThread = std::thread(runAnalysis);
+	}
+
+	AnalysisStep getAnalysisStep()
+	{
+		return static_cast<AnalysisStep>(analysisStep.load(std::memory_order_acquire));
+	}
+
+	bool isReady(AnalysisStep step)
+	{
+		if (analysisThread.joinable() && analysisRunDone.load(std::memory_order_acquire)) {
+			// the worker is done, finish on this thread
+			analysisThread.join();
+			finishAnalysis();
+		}
+		return getAnalysisStep() >= step;
+	}
+
+	void waitForAnalysis()
+	{
+		if (!analysisThread.joinable()) return;
+		analysisThread.join();
+		finishAnalysis();
+	}
+
+	// coverage points of a region, the first one is its openness point
+	static void computeCoveragePoints(RegionImpl* r)
+	{
+		BWAPI::WalkPosition pos(r->_opennessPoint);
+		r->_coveragePositions.push_back(pos);
+		int regionID = BWTA_Result::regionLabelMap[pos.x][pos.y];
+
+		// compute max lenght of the bounding box
+		int minX = std::numeric_limits<int>::max();
+		int minY = std::numeric_limits<int>::max();
+		int maxX = 0;
+		int maxY = 0;
+		for (const auto& p : r->_polygon) {
+			minX = std::min(minX, p.x);
+			minY = std::min(minY, p.y);
+			maxX = std::max(maxX, p.x);
+			maxY = std::max(maxY, p.y);
+		}
+		int maxBoundingBoxLength = std::max(maxX-minX, maxY-minY);
+		maxBoundingBoxLength /= 16; // lenght is in pixel, translate to walkTiles
+		maxBoundingBoxLength *= 2;
+
+		//searches outward in a spiral.
+		int x      = pos.x;
+		int y      = pos.y;
+		int length = 1;
+		int j      = 0;
+		bool first = true;
+		int dx     = 0;
+		int dy     = 1;	
+		while (length < maxBoundingBoxLength) {
+			// if valid position
+			if (x >= 0 && x < BWTA_Result::regionLabelMap.getWidth() && 
+				y >= 0 && y < BWTA_Result::regionLabelMap.getHeight() &&
+				regionID == BWTA_Result::regionLabelMap[x][y]) {
+					// check if we are far enough
+					int minDistance = std::numeric_limits<int>::max();
+					for (const auto& coverPos : r->_coveragePositions) {
+						minDistance = std::min(minDistance, std::abs(coverPos.x-x)+std::abs(coverPos.y-y) );
+					}
+					if (minDistance > COVERAGE_SIGHT_RANGE) r->_coveragePositions.emplace_back(x,y);
+			}
+
+			//otherwise, move to another position
+			x = x + dx;
+			y = y + dy;
+			//count how many steps we take in this direction
+			j++;
+			if (j == length) { //if we've reached the end, its time to turn
+				j = 0;
+				if (!first) length++;
+				first =! first;
+				//turn counter clockwise 90 degrees:
+				if (dx == 0) {
+					dx = dy;
+					dy = 0;
+				} else {
+					dy = -dx;
+					dx = 0;
+				}
+			}
+			//Spiral out. Keep going.
+		}
 	}
 
 	void analyze_map()
@@ -67,16 +240,33 @@ namespace BWTA
 		Timer timer;
 		timer.start();
 
-		std::vector<BoostPolygon> boostPolygons;
-		BWTA_Result::obstacleLabelMap.resize(MapData::walkability.getWidth(), MapData::walkability.getHeight());
-		BWTA_Result::obstacleLabelMap.setTo(0);
-		generatePolygons(boostPolygons, BWTA_Result::obstacleLabelMap);
+		// intermediate results, restored from the latest checkpoint whose inputs did not change
+		AnalysisState state;
+		std::vector<BoostPolygon>& boostPolygons = state.boostPolygons;
+		RegionGraph& graphSimplified = state.graphSimplified;
+		std::map<nodeID, chokeSides_t>& chokepointSides = state.chokepointSides;
+		AnalysisStage resumed = STAGE_NONE;
+		std::unique_ptr<StageCache> stageCache;
+		if (areAnalysisCheckpointsEnabled()) {
+			stageCache.reset(new StageCache(std::string(BWTA_PATH) + "stages/"));
+			resumed = stageCache->resume(state);
+			if (resumed != STAGE_NONE) LOG(" [Resumed analysis after stage " << resumed << "]");
+		}
+
+		if (resumed < STAGE_POLYGONS) {
+			BWTA_Result::obstacleLabelMap.resize(MapData::walkability.getWidth(), MapData::walkability.getHeight());
+			BWTA_Result::obstacleLabelMap.setTo(0);
+			generatePolygons(boostPolygons, BWTA_Result::obstacleLabelMap);
+
+			if (stageCache) stageCache->save(STAGE_POLYGONS, state);
+		}
 
 		// translate Boost polygons to BWTA polygons
 		for (const auto& pol : boostPolygons) {
 			Polygon* bwtaPol = new PolygonImpl(pol);
 			BWTA_Result::unwalkablePolygons.push_back(bwtaPol);
 		}
+		setAnalysisStep(ANALYSIS_POLYGONS);
 
 		LOG(" [Detected polygons in " << timer.stopAndGetTime() << " seconds]");
 #ifdef DEBUG_DRAW
@@ -88,116 +278,166 @@ namespace BWTA
 // 			painter.render();
 // 		}
 #endif
-		timer.start();
+		// the rest of the analysis is a graph of tasks, the stages that do not depend on each other run in
+		// parallel (each task writes its own results, so they do not depend on the number of threads)
+		TaskScheduler scheduler(getAnalysisThreadCount());
+		TaskGraph pipeline;
+		const int chunks = 4 * scheduler.getThreadCount();
+
+		// only needs the polygons, it overlaps with the Voronoi and region stages
+		TaskGraph::TaskId closestObstacles = pipeline.add(computeClosestObstacleLabelMap);
+		// only needs the tile walkability
+		pipeline.add([]() { BWTA_Result::jumpTable.build(MapData::lowResWalkability); });
+		// same for the hierarchy of GroundDistanceOracle, the longest task on large maps
+		if (isGroundDistanceOracleEnabled()) {
+			pipeline.add([]() {
+				Timer hierarchyTimer;
+				hierarchyTimer.start();
+				BWTA_Result::contractionHierarchy.build(MapData::lowResWalkability);
+				LOG(" [Built the contraction hierarchy (" << BWTA_Result::contractionHierarchy.getEdgeTarget().size()
+					<< " edges) in " << hierarchyTimer.stopAndGetTime() << " seconds]");
+			});
+		}
 
-		RegionGraph graph;
-		bgi::rtree<BoostSegmentI, bgi::quadratic<16> > rtree;
-		generateVoronoid(BWTA_Result::unwalkablePolygons, BWTA_Result::obstacleLabelMap, graph, rtree);
-		
-		LOG(" [Computed Voronoi in " << timer.stopAndGetTime() << " seconds]");
-#ifdef DEBUG_DRAW
-		painter.drawPolygons(BWTA_Result::unwalkablePolygons, Painter::Scale::Walk, imageScale);
-		painter.drawGraph(graph, Painter::Scale::Walk, imageScale);
-		painter.render("02-Voronoi");
-#endif
-		timer.start();
+		// only needs the polygons
+		pipeline.add([&]() {
+			Timer meshTimer;
+			meshTimer.start();
+			BWTA_Result::navMesh.build(boostPolygons, MapData::walkability.getWidth(), MapData::walkability.getHeight());
+			LOG(" [Built the navigation mesh (" << BWTA_Result::navMesh.getTriangleCount()
+				<< " triangles) in " << meshTimer.stopAndGetTime() << " seconds]");
+		});
 
-		pruneGraph(graph);
+		TaskGraph::TaskId regions = pipeline.add([&]() {
+			timer.start();
 
-		LOG(" [Pruned Voronoi in " << timer.stopAndGetTime() << " seconds]");
+			if (resumed < STAGE_GRAPH) {
+				RegionGraph graph;
+				bgi::rtree<BoostSegmentI, bgi::quadratic<16> > rtree;
+				generateVoronoid(BWTA_Result::unwalkablePolygons, BWTA_Result::obstacleLabelMap, graph, rtree);
+			
+				LOG(" [Computed Voronoi in " << timer.stopAndGetTime() << " seconds]");
 #ifdef DEBUG_DRAW
-		painter.drawPolygons(BWTA_Result::unwalkablePolygons, Painter::Scale::Walk, imageScale);
-		painter.drawGraph(graph, Painter::Scale::Walk, imageScale);
-		painter.render("03-VoronoiPruned");
+				painter.drawPolygons(BWTA_Result::unwalkablePolygons, Painter::Scale::Walk, imageScale);
+				painter.drawGraph(graph, Painter::Scale::Walk, imageScale);
+				painter.render("02-Voronoi");
 #endif
-		timer.start();
+				timer.start();
 
-		detectNodes(graph, BWTA_Result::unwalkablePolygons);
+				pruneGraph(graph);
 
-		LOG(" [Identified region/chokepoints nodes in " << timer.stopAndGetTime() << " seconds]");
+				LOG(" [Pruned Voronoi in " << timer.stopAndGetTime() << " seconds]");
 #ifdef DEBUG_DRAW
-		painter.drawPolygons(BWTA_Result::unwalkablePolygons, Painter::Scale::Walk, imageScale);
-		painter.drawGraph(graph, Painter::Scale::Walk, imageScale);
-		painter.drawNodes(graph, graph.regionNodes, Qt::blue, Painter::Scale::Walk, imageScale);
-		painter.drawNodes(graph, graph.chokeNodes, Qt::red, Painter::Scale::Walk, imageScale);
-		painter.render("05-NodesDetected");
+				painter.drawPolygons(BWTA_Result::unwalkablePolygons, Painter::Scale::Walk, imageScale);
+				painter.drawGraph(graph, Painter::Scale::Walk, imageScale);
+				painter.render("03-VoronoiPruned");
 #endif
-		timer.start();
+				timer.start();
 
-		RegionGraph graphSimplified;
-		simplifyGraph(graph, graphSimplified);
+				detectNodes(graph, BWTA_Result::unwalkablePolygons);
+				buildSkeleton(graph, BWTA_Result::skeleton);
 
-		LOG(" [Simplified graph in " << timer.stopAndGetTime() << " seconds]");
+				LOG(" [Identified region/chokepoints nodes in " << timer.stopAndGetTime() << " seconds]");
 #ifdef DEBUG_DRAW
-		painter.drawPolygons(BWTA_Result::unwalkablePolygons, Painter::Scale::Walk, imageScale);
-		painter.drawGraph(graphSimplified, Painter::Scale::Walk, imageScale);
-		painter.drawNodes(graphSimplified, graphSimplified.regionNodes, Qt::blue, Painter::Scale::Walk, imageScale);
-		painter.drawNodes(graphSimplified, graphSimplified.chokeNodes, Qt::red, Painter::Scale::Walk, imageScale);
-		painter.render("06-GraphPruned");
+				painter.drawPolygons(BWTA_Result::unwalkablePolygons, Painter::Scale::Walk, imageScale);
+				painter.drawGraph(graph, Painter::Scale::Walk, imageScale);
+				painter.drawNodes(graph, graph.regionNodes, Qt::blue, Painter::Scale::Walk, imageScale);
+				painter.drawNodes(graph, graph.chokeNodes, Qt::red, Painter::Scale::Walk, imageScale);
+				painter.render("05-NodesDetected");
 #endif
-		timer.start();
+				timer.start();
 
-		mergeRegionNodes(graphSimplified);
+				simplifyGraph(graph, graphSimplified);
 
-		LOG(" [Merged consecutive region nodes in " << timer.stopAndGetTime() << " seconds]");
+				LOG(" [Simplified graph in " << timer.stopAndGetTime() << " seconds]");
 #ifdef DEBUG_DRAW
-		painter.drawPolygons(BWTA_Result::unwalkablePolygons, Painter::Scale::Walk, imageScale);
-		painter.drawGraph(graphSimplified, Painter::Scale::Walk, imageScale);
-		painter.drawNodes(graphSimplified, graphSimplified.regionNodes, Qt::blue, Painter::Scale::Walk, imageScale);
-		painter.drawNodes(graphSimplified, graphSimplified.chokeNodes, Qt::red, Painter::Scale::Walk, imageScale);
-		painter.render("07-GraphMerged");
+				painter.drawPolygons(BWTA_Result::unwalkablePolygons, Painter::Scale::Walk, imageScale);
+				painter.drawGraph(graphSimplified, Painter::Scale::Walk, imageScale);
+				painter.drawNodes(graphSimplified, graphSimplified.regionNodes, Qt::blue, Painter::Scale::Walk, imageScale);
+				painter.drawNodes(graphSimplified, graphSimplified.chokeNodes, Qt::red, Painter::Scale::Walk, imageScale);
+				painter.render("06-GraphPruned");
 #endif
-		timer.start();
+				timer.start();
 
-		std::map<nodeID, chokeSides_t> chokepointSides;
-		getChokepointSides(graphSimplified, rtree, chokepointSides);
+				mergeRegionNodes(graphSimplified);
 
-		LOG(" [Chokepoints sides computed in " << timer.stopAndGetTime() << " seconds]");
+				LOG(" [Merged consecutive region nodes in " << timer.stopAndGetTime() << " seconds]");
 #ifdef DEBUG_DRAW
-		painter.drawPolygons(BWTA_Result::unwalkablePolygons, Painter::Scale::Walk, imageScale);
-		painter.drawGraph(graphSimplified, Painter::Scale::Walk, imageScale);
-		painter.drawNodes(graphSimplified, graphSimplified.regionNodes, Qt::blue, Painter::Scale::Walk, imageScale);
-		painter.drawChokepointsSides(chokepointSides, Qt::red, Painter::Scale::Walk, imageScale);
-		painter.render("08-WallOffChokepoints");
+				painter.drawPolygons(BWTA_Result::unwalkablePolygons, Painter::Scale::Walk, imageScale);
+				painter.drawGraph(graphSimplified, Painter::Scale::Walk, imageScale);
+				painter.drawNodes(graphSimplified, graphSimplified.regionNodes, Qt::blue, Painter::Scale::Walk, imageScale);
+				painter.drawNodes(graphSimplified, graphSimplified.chokeNodes, Qt::red, Painter::Scale::Walk, imageScale);
+				painter.render("07-GraphMerged");
 #endif
-		timer.start();
+				timer.start();
 
-		std::vector<BoostPolygon> polReg;
-		createRegionsFromGraph(boostPolygons, BWTA_Result::obstacleLabelMap, graphSimplified, chokepointSides,
-			BWTA_Result::regions, BWTA_Result::chokepoints, polReg);
+				getChokepointSides(graphSimplified, rtree, chokepointSides);
 
-		LOG(" [Created BWTA regions/chokepoints in " << timer.stopAndGetTime() << " seconds]");
+				LOG(" [Chokepoints sides computed in " << timer.stopAndGetTime() << " seconds]");
 #ifdef DEBUG_DRAW
-		painter.drawPolygons(BWTA_Result::unwalkablePolygons, Painter::Scale::Walk, imageScale);
-		painter.drawRegions(BWTA_Result::regions, Painter::Scale::Pixel, imageScale);
-		painter.drawChokepoints(BWTA_Result::chokepoints, imageScale);
-		painter.render("09-Regions");
+				painter.drawPolygons(BWTA_Result::unwalkablePolygons, Painter::Scale::Walk, imageScale);
+				painter.drawGraph(graphSimplified, Painter::Scale::Walk, imageScale);
+				painter.drawNodes(graphSimplified, graphSimplified.regionNodes, Qt::blue, Painter::Scale::Walk, imageScale);
+				painter.drawChokepointsSides(chokepointSides, Qt::red, Painter::Scale::Walk, imageScale);
+				painter.render("08-WallOffChokepoints");
 #endif
-		timer.start();
-
-		detectBaseLocations(BWTA_Result::baselocations);
-// 		for (auto i : BWTA_Result::baselocations) {
-// 			log("BaseLocation at Position " << i->getPosition() << " Tile " << i->getTilePosition());
-// 		}
-
-		LOG(" [Calculated base locations in " << timer.stopAndGetTime() << " seconds]");
-		timer.start();
+				if (stageCache) stageCache->save(STAGE_GRAPH, state);
+				timer.start();
+			}
 
-		computeAllClosestObjectMaps();
+			if (resumed < STAGE_REGIONS) {
+				std::vector<BoostPolygon> polReg;
+				createRegionsFromGraph(boostPolygons, BWTA_Result::obstacleLabelMap, graphSimplified, chokepointSides,
+					BWTA_Result::regions, BWTA_Result::chokepoints, polReg);
 
-		LOG(" [Calculated closest maps in " << timer.stopAndGetTime() << " seconds]");
-		timer.start();
+				LOG(" [Created BWTA regions/chokepoints in " << timer.stopAndGetTime() << " seconds]");
+#ifdef DEBUG_DRAW
+				painter.drawPolygons(BWTA_Result::unwalkablePolygons, Painter::Scale::Walk, imageScale);
+				painter.drawRegions(BWTA_Result::regions, Painter::Scale::Pixel, imageScale);
+				painter.drawChokepoints(BWTA_Result::chokepoints, imageScale);
+				painter.render("09-Regions");
+#endif
+				if (stageCache) stageCache->save(STAGE_REGIONS, state);
+				timer.start();
+			}
+			setAnalysisStep(ANALYSIS_REGIONS);
+		});
+
+		std::vector<BaseLocation*> baseLocations;
+		std::vector<BWAPI::TilePosition> landmarkTiles;
+		TaskGraph::TaskId bases = pipeline.add([&]() {
+			Timer baseTimer;
+			baseTimer.start();
+			detectBaseLocations(BWTA_Result::baselocations);
+			baseLocations.assign(BWTA_Result::baselocations.begin(), BWTA_Result::baselocations.end());
+			std::vector<BWAPI::TilePosition> baseTiles;
+			for (const auto& base : baseLocations) baseTiles.push_back(base->getTilePosition());
+			landmarkTiles = LandmarkTable::selectLandmarks(baseTiles);
+			BWTA_Result::landmarks.resize(MapData::mapWidthTileRes, MapData::mapHeightTileRes, (int)landmarkTiles.size());
+			LOG(" [Calculated base locations in " << baseTimer.stopAndGetTime() << " seconds]");
+		}, { regions });
+
+		TaskGraph::TaskId closestBases = pipeline.add(computeClosestBaseLocationMap, { bases });
+		TaskGraph::TaskId closestChokepoints = pipeline.add(computeClosestChokepointMap, { regions });
+		pipeline.add([]() { setAnalysisStep(ANALYSIS_CLOSEST_MAPS); }, { closestObstacles, closestBases, closestChokepoints });
+
+		// one ground distance map per base location
+		TaskGraph::TaskId baseDistances = pipeline.addParallelFor([&]() { return (int)baseLocations.size(); },
+			[&](int i) { calculateBaseLocationDistances(baseLocations[i]); }, chunks, { bases });
+		pipeline.add(assignBaseLocationsToRegions, { baseDistances });
+		// the same kind of field in the units of the searches for the ALT heuristic, from the bases spread
+		// the most (getGroundDistanceMap steps are 32/45 and ignore the corner rule, not a valid bound)
+		pipeline.addParallelFor([&]() { return (int)landmarkTiles.size(); },
+			[&](int i) { BWTA_Result::landmarks.compute(i, landmarkTiles[i]); }, chunks, { bases });
 
-		calculateBaseLocationProperties();
-// 		log("Debug BaseLocationProperties");
-// 		for (const auto& base : BWTA_Result::baselocations) {
-// 			BaseLocationImpl* baseI = (BaseLocationImpl*)base;
-// 			log("Base Position" << baseI->getTilePosition() << ",isIsland:" << baseI->isIsland()
-// 				<< ",isStartLocation:" << baseI->isStartLocation()
-// 				<< ",regionCenter" << baseI->getRegion()->getCenter());
-// 		}
+		// TODO tile res should be enough
+		pipeline.addParallelFor([]() { return (int)BWTA_Result::regions.size(); },
+			[](int i) { computeCoveragePoints(static_cast<RegionImpl*>(BWTA_Result::regions[i])); }, chunks, { regions });
 
-		LOG(" [Calculated base location properties in " << timer.stopAndGetTime() << " seconds]");
+		Timer pipelineTimer;
+		pipelineTimer.start();
+		scheduler.run(pipeline);
+		LOG(" [Ran the analysis tasks on " << scheduler.getThreadCount() << " threads in " << pipelineTimer.stopAndGetTime() << " seconds]");
 #ifdef DEBUG_DRAW
 //		painter.drawClosestBaseLocationMap(BWTA_Result::getBaseLocationW, BWTA_Result::baselocations);
 //		painter.render("ClosestBaseLocationMap");
@@ -208,86 +448,13 @@ namespace BWTA
 		painter.drawChokepoints(BWTA_Result::chokepoints, imageScale);
 		painter.drawBaseLocations(BWTA_Result::baselocations, imageScale);
 		painter.render("10-Final");
-#endif
-		timer.start();
-
-		// compute coverage points of each region
-		// TODO tile res should be enough
-		const int SIGHT_RANGE = 7 * 2 * 4; // SCV = 7 tiles * 2, transformed into walk tiles
-		for (auto region : BWTA_Result::regions) {
-			RegionImpl* r = dynamic_cast<RegionImpl*>(region);
-			// first coverage point is openness point
-			BWAPI::WalkPosition pos(r->_opennessPoint);
-			r->_coveragePositions.push_back(pos);
-			int regionID = BWTA_Result::regionLabelMap[pos.x][pos.y];
-
-			// compute max lenght of the bounding box
-			int minX = std::numeric_limits<int>::max();
-			int minY = std::numeric_limits<int>::max();
-			int maxX = 0;
-			int maxY = 0;
-			for (const auto& p : r->_polygon) {
-				minX = std::min(minX, p.x);
-				minY = std::min(minY, p.y);
-				maxX = std::max(maxX, p.x);
-				maxY = std::max(maxY, p.y);
-			}
-			int maxBoundingBoxLength = std::max(maxX-minX, maxY-minY);
-			maxBoundingBoxLength /= 16; // lenght is in pixel, translate to walkTiles
-			maxBoundingBoxLength *= 2;
-
-			//searches outward in a spiral.
-			int x      = pos.x;
-			int y      = pos.y;
-			int length = 1;
-			int j      = 0;
-			bool first = true;
-			int dx     = 0;
-			int dy     = 1;	
-			while (length < maxBoundingBoxLength) {
-				// if valid position
-				if (x >= 0 && x < BWTA_Result::regionLabelMap.getWidth() && 
-					y >= 0 && y < BWTA_Result::regionLabelMap.getHeight() &&
-					regionID == BWTA_Result::regionLabelMap[x][y]) {
-						// check if we are far enough
-						int minDistance = std::numeric_limits<int>::max();
-						for (const auto& coverPos : r->_coveragePositions) {
-							minDistance = std::min(minDistance, std::abs(coverPos.x-x)+std::abs(coverPos.y-y) );
-						}
-						if (minDistance > SIGHT_RANGE) r->_coveragePositions.emplace_back(x,y);
-				}
-
-				//otherwise, move to another position
-				x = x + dx;
-				y = y + dy;
-				//count how many steps we take in this direction
-				j++;
-				if (j == length) { //if we've reached the end, its time to turn
-					j = 0;
-					if (!first) length++;
-					first =! first;
-					//turn counter clockwise 90 degrees:
-					if (dx == 0) {
-						dx = dy;
-						dy = 0;
-					} else {
-						dy = -dx;
-						dx = 0;
-					}
-				}
-				//Spiral out. Keep going.
-			}
-		}
 
-		LOG(" [Calculated region coverage positions in " << timer.stopAndGetTime() << " seconds]");
-#ifdef DEBUG_DRAW
 		painter.drawPolygons(BWTA_Result::unwalkablePolygons, Painter::Scale::Walk, imageScale);
 		painter.drawRegions(BWTA_Result::regions, Painter::Scale::Pixel, imageScale);
 		painter.drawChokepoints(BWTA_Result::chokepoints, imageScale);
 		painter.drawCoverPoints(BWTA_Result::regions, imageScale);
 		painter.render("11-CoverPoints");
 #endif
-
 	}
 
 }
\ No newline at end of file
@@ -34,6 +34,14 @@ public:
 		return (double(elapsedTime) / lFreq.QuadPart);
 	}
 
+	// Return the time since start() in microseconds, without stopping
+	inline double getMicrosecondsSinceStart()
+	{
+		LARGE_INTEGER lNow;
+		QueryPerformanceCounter(&lNow);
+		return double(lNow.QuadPart - lStart.QuadPart) * 1000000.0 / lFreq.QuadPart;
+	}
+
 	// Return duration in seconds
 	inline double stopAndGetTime()
 	{
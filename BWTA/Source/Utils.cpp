@@ -1,4 +1,5 @@
 #include "Utils.h"
+#include "CacheFile.h"
 #include "filesystem/path.h"
 
 namespace BWTA
@@ -125,15 +126,12 @@ namespace BWTA
 	{
 		filesystem::path filePath(filesystem::path::get_cwd() / filename);
 		if (filePath.exists()) {
-			// get file version
-			std::ifstream file_in;
-			file_in.open(filename.c_str());
-			int version;
-			file_in >> version;
-			file_in.close();
+			// get file version from the binary header
+			CacheFile::Header header;
+			if (!CacheFile::readHeader(filename, header)) return false;
 
 			// return comparison
-			return version == BWTA_FILE_VERSION;
+			return header.version == BWTA_FILE_VERSION;
 		}
 		return false;
 	}
@@ -15,7 +15,7 @@ typedef boost::polygon::segment_data<int32> VoronoiSegment;
 
 namespace BWTA
 {
-	int const BWTA_FILE_VERSION = 6;
+	int const BWTA_FILE_VERSION = 13;
 
 	/**
 	* The scanline flood fill algorithm works by intersecting scanline with polygon edges and
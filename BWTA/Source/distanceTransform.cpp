@@ -1,9 +1,19 @@
 #include "DistanceTransform.h"
 
+#include <mutex>
+
 using namespace std;
 using namespace BWAPI;
 namespace BWTA
 {
+	static std::mutex distanceTransformMutex;
+
+	void requireDistanceTransform()
+	{
+		std::lock_guard<std::mutex> lock(distanceTransformMutex);
+		if (MapData::maxDistanceTransform == 0) distanceTransform();
+	}
+
 	void distanceTransform()
 	{
 		bool finish = false;
@@ -18,7 +28,7 @@ namespace BWTA
 						else if (y > 0 && MapData::distanceTransform[x][y - 1] == maxDistance) MapData::distanceTransform[x][y] = maxDistance + 1;
 						else if (x + 1 < MapData::mapWidthWalkRes && y > 0 && MapData::distanceTransform[x + 1][y - 1] == maxDistance) MapData::distanceTransform[x][y] = maxDistance + 1;
 						else if (x > 0 && MapData::distanceTransform[x - 1][y] == maxDistance) MapData::distanceTransform[x][y] = maxDistance + 1;
-						else if (x > 0 && MapData::distanceTransform[x + 1][y] == maxDistance) MapData::distanceTransform[x][y] = maxDistance + 1;
+						else if (x + 1 < MapData::mapWidthWalkRes && MapData::distanceTransform[x + 1][y] == maxDistance) MapData::distanceTransform[x][y] = maxDistance + 1;
 						else if (x > 0 && y + 1 < MapData::mapHeightWalkRes && MapData::distanceTransform[x - 1][y + 1] == maxDistance) MapData::distanceTransform[x][y] = maxDistance + 1;
 						else if (y + 1 < MapData::mapHeightWalkRes && MapData::distanceTransform[x][y + 1] == maxDistance) MapData::distanceTransform[x][y] = maxDistance + 1;
 						else if (x + 1 < MapData::mapWidthWalkRes && y + 1 < MapData::mapHeightWalkRes && MapData::distanceTransform[x + 1][y + 1] == maxDistance) MapData::distanceTransform[x][y] = maxDistance + 1;
@@ -31,6 +41,13 @@ namespace BWTA
 			maxDistance++;
 		}
 		MapData::maxDistanceTransform = maxDistance;
+
+		MapData::tileClearance.resize(MapData::mapWidthTileRes, MapData::mapHeightTileRes);
+		for (int x = 0; x < MapData::mapWidthTileRes; ++x) {
+			for (int y = 0; y < MapData::mapHeightTileRes; ++y) {
+				MapData::tileClearance[x][y] = getMaxTransformDistance(x, y);
+			}
+		}
 	}
 
 	int getMaxTransformDistance(int x, int y)
@@ -78,7 +95,7 @@ namespace BWTA
 	void computeDistanceTransform()
 	{
 		// compute distance transform map
-		distanceTransform();
+		requireDistanceTransform();
 
 		// calculate maximum distance of each region
 		maxDistanceOfRegion();
@@ -1,270 +1,235 @@
 #include "Pathfinding.h"
+#include "BWTA_Result.h"
+#include "TaskScheduler.h"
+#include "ObstacleOverlay.h"
 
 namespace BWTA
 {
-  double AstarSearchDistance(BWAPI::TilePosition start, BWAPI::TilePosition end)
+  static PathfindingMode pathfindingMode = PATHFINDING_ASTAR;
+  static int bidirectionalSearchDistance = 64; // tiles, 0 = never
+  // threads of the parallel DijkstraDistanceMatrix, started on the first call and kept for the next
+  // ones; the mutex lets one matrix at a time use them
+  static std::unique_ptr<TaskScheduler> matrixScheduler;
+  static unsigned int matrixSchedulerThreads; // the setAnalysisThreadCount it was started with
+  static std::mutex matrixSchedulerMutex;
+
+  void setPathfindingMode(PathfindingMode mode)
   {
-    Heap<BWAPI::TilePosition,int> openTiles(true);
-    std::map<BWAPI::TilePosition,int> gmap;
-    std::set<BWAPI::TilePosition> closedTiles;
-    openTiles.push(std::make_pair(start,0));
-    gmap[start]=0;
-    while(!openTiles.empty())
-    {
-      BWAPI::TilePosition p=openTiles.top().first;
-      if (p==end)
-        return gmap[p]*32.0/10.0;
-      int fvalue=openTiles.top().second;
-      int gvalue=gmap[p];
-      openTiles.pop();
-      closedTiles.insert(p);
-	  int minx = std::max(p.x - 1, 0);
-	  int maxx = std::min(p.x + 1, MapData::mapWidthTileRes - 1);
-	  int miny = std::max(p.y - 1, 0);
-	  int maxy = std::min(p.y + 1, MapData::mapHeightTileRes - 1);
-      for(int x=minx;x<=maxx;x++)
-        for(int y=miny;y<=maxy;y++)
-        {
-          if (!MapData::lowResWalkability[x][y]) continue;
-          if (p.x != x && p.y != y && !MapData::lowResWalkability[p.x][y] && !MapData::lowResWalkability[x][p.y]) continue;
-          BWAPI::TilePosition t(x,y);
-          if (closedTiles.find(t)!=closedTiles.end()) continue;
+    pathfindingMode = mode;
+  }
 
-          int g=gvalue+10; if (x!=p.x && y!=p.y) g+=4;
-		  int dx = std::abs(x - end.x); int dy = std::abs(y - end.y);
-		  int h = std::abs(dx - dy) * 10 + std::min(dx, dy) * 14;
-          int f=g+h;
-          if (gmap.find(t)==gmap.end() || gmap[t]>g)
-          {
-            gmap[t]=g;
-            openTiles.set(t,f);
-          }
-        }
-    }
-    return -1;
+  PathfindingMode getPathfindingMode()
+  {
+    return pathfindingMode;
   }
-  std::pair<BWAPI::TilePosition,double> AstarSearchDistance(BWAPI::TilePosition start, std::set<BWAPI::TilePosition>& end)
+
+  void setBidirectionalSearchDistance(int tiles)
   {
-    Heap<BWAPI::TilePosition,int> openTiles(true);
-    std::map<BWAPI::TilePosition,int> gmap;
-    std::set<BWAPI::TilePosition> closedTiles;
-    openTiles.push(std::make_pair(start,0));
-    gmap[start]=0;
-    while(!openTiles.empty())
-    {
-      BWAPI::TilePosition p=openTiles.top().first;
-      if (end.find(p)!=end.end())
-        return std::make_pair(p,gmap[p]*32.0/10.0);
-      int fvalue=openTiles.top().second;
-      int gvalue=gmap[p];
-      openTiles.pop();
-      closedTiles.insert(p);
-	  int minx = std::max(p.x - 1, 0);
-	  int maxx = std::min(p.x + 1, MapData::mapWidthTileRes - 1);
-	  int miny = std::max(p.y - 1, 0);
-	  int maxy = std::min(p.y + 1, MapData::mapHeightTileRes - 1);
-      for(int x=minx;x<=maxx;x++)
-        for(int y=miny;y<=maxy;y++)
-        {
-          if (!MapData::lowResWalkability[x][y]) continue;
-          if (p.x != x && p.y != y && !MapData::lowResWalkability[p.x][y] && !MapData::lowResWalkability[x][p.y]) continue;
-          BWAPI::TilePosition t(x,y);
-          if (closedTiles.find(t)!=closedTiles.end()) continue;
+    bidirectionalSearchDistance = tiles;
+  }
 
-          int g=gvalue+10; if (x!=p.x && y!=p.y) g+=4;
-          int h=-1;
-          for(std::set<BWAPI::TilePosition>::iterator i=end.begin();i!=end.end();i++)
-          {
-			  int dx = std::abs(x - i->x); int dy = std::abs(y - i->y);
-			  int ch = std::abs(dx - dy) * 10 + std::min(dx, dy) * 14;
-            if (h==-1 || ch<h)
-              h=ch;
-          }
-          int f=g+h;
-          if (gmap.find(t)==gmap.end() || gmap[t]>g)
-          {
-            gmap[t]=g;
-            openTiles.set(t,f);
-          }
-        }
-    }
-    return std::make_pair(BWAPI::TilePositions::None,-1);
+  // all the variants share the searches in GridSearch.h and JumpPointSearch.h, they only differ in
+  // their policies; the mode is read once per query
+  template <class Path, class Goal, class Heuristic>
+  static int search(PathfindingMode mode, GridSearchContext& context, BWAPI::TilePosition start, Goal& goal, const Heuristic& heuristic)
+  {
+    if (mode == PATHFINDING_ASTAR) return gridSearch<Path>(context, start, goal, heuristic);
+    return jumpPointSearch(context, start, goal, heuristic);
   }
-  std::map<BWAPI::TilePosition,double> AstarSearchDistanceAll(BWAPI::TilePosition start, std::set<BWAPI::TilePosition>& end)
+
+  template <class Path>
+  static int searchTarget(PathfindingMode mode, GridSearchContext& context, BWAPI::TilePosition start, BWAPI::TilePosition end)
   {
-    Heap<BWAPI::TilePosition,int> openTiles(true);
-    std::map<BWAPI::TilePosition,int> gmap;
-    std::set<BWAPI::TilePosition> closedTiles;
-    openTiles.push(std::make_pair(start,0));
-    gmap[start]=0;
-    std::map<BWAPI::TilePosition,double> result;
-    while(!openTiles.empty())
-    {
-      BWAPI::TilePosition p=openTiles.top().first;
-      if (end.find(p)!=end.end())
-      {
-        result[p]=gmap[p]*32.0/10.0;
-        end.erase(p);
-        if (end.empty())
-          return result;
+    // the jump table is written by the analysis, only use it once the analysis is done and while
+    // no tile is blocked (it does not know about them). It has no jumps out of an unwalkable tile,
+    // a search from one steps out of it with JPS instead
+    const RectangleArray<bool>& walkable = MapData::lowResWalkability;
+    const bool walkableStart = start.x >= 0 && start.y >= 0 && start.x < (int)walkable.getWidth()
+      && start.y < (int)walkable.getHeight() && walkable[start.x][start.y];
+    if (mode == PATHFINDING_JPS_PLUS && walkableStart && getAnalysisStep() == ANALYSIS_DONE && getObstacleOverlay().empty()) {
+      BWTA_Result::require(BWTA_Result::LAZY_JUMP_TABLE);
+      if (!BWTA_Result::jumpTable.empty()) return jumpPointSearchPlus(context, start, end, BWTA_Result::jumpTable);
+    }
+    SingleGoal goal(end);
+    // same for the landmarks, the ALT bound is never below the octile distance
+    if (getAnalysisStep() == ANALYSIS_DONE) {
+      BWTA_Result::require(BWTA_Result::LAZY_LANDMARKS);
+      if (!BWTA_Result::landmarks.empty()) {
+        return search<Path>(mode, context, start, goal, LandmarkHeuristic(BWTA_Result::landmarks, start, end));
       }
-      int fvalue=openTiles.top().second;
-      int gvalue=gmap[p];
-      openTiles.pop();
-      closedTiles.insert(p);
-	  int minx = std::max(p.x - 1, 0);
-	  int maxx = std::min(p.x + 1, MapData::mapWidthTileRes - 1);
-	  int miny = std::max(p.y - 1, 0);
-	  int maxy = std::min(p.y + 1, MapData::mapHeightTileRes - 1);
-      for(int x=minx;x<=maxx;x++)
-        for(int y=miny;y<=maxy;y++)
-        {
-          if (!MapData::lowResWalkability[x][y]) continue;
-          if (p.x != x && p.y != y && !MapData::lowResWalkability[p.x][y] && !MapData::lowResWalkability[x][p.y]) continue;
-          BWAPI::TilePosition t(x,y);
-          if (closedTiles.find(t)!=closedTiles.end()) continue;
-
-          int g=gvalue+10; if (x!=p.x && y!=p.y) g+=4;
-          int h=-1;
-          for(std::set<BWAPI::TilePosition>::iterator i=end.begin();i!=end.end();i++)
-          {
-			  int dx = std::abs(x - i->x); int dy = std::abs(y - i->y);
-			  int ch = std::abs(dx - dy) * 10 + std::min(dx, dy) * 14;
-            if (h==-1 || ch<h)
-              h=ch;
-          }
-          int f=g+h;
-          if (gmap.find(t)==gmap.end() || gmap[t]>g)
-          {
-            gmap[t]=g;
-            openTiles.set(t,f);
-          }
-        }
     }
-    return result;
+    return search<Path>(mode, context, start, goal, OctileHeuristic(end));
   }
-  std::vector<BWAPI::TilePosition> AstarSearchPath(BWAPI::TilePosition start, BWAPI::TilePosition end)
+
+  static std::vector<BWAPI::TilePosition> getPath(PathfindingMode mode, const GridSearchContext& context, int node)
   {
+    if (node == -1) return std::vector<BWAPI::TilePosition>();
+    if (mode == PATHFINDING_ASTAR) return context.getPath(node);
+    return getJumpPath(context, node);
+  }
 
-    Heap<BWAPI::TilePosition,int> openTiles(true);
-    std::map<BWAPI::TilePosition,int> gmap;
-    std::map<BWAPI::TilePosition,BWAPI::TilePosition> parent;
-    std::set<BWAPI::TilePosition> closedTiles;
-    openTiles.push(std::make_pair(start,0));
-    gmap[start]=0;
-    parent[start]=start;
-    while(!openTiles.empty())
-    {
-      BWAPI::TilePosition p=openTiles.top().first;
-      if (p==end)
-      {
-        std::vector<BWAPI::TilePosition> reverse_path;
-        while(p!=parent[p])
-        {
-          reverse_path.push_back(p);
-          p=parent[p];
-        }
-        reverse_path.push_back(start);
-        std::vector<BWAPI::TilePosition> path;
-        for(int i=reverse_path.size()-1;i>=0;i--)
-          path.push_back(reverse_path[i]);
-        return path;
+  // distance only, from both ends at once (the landmarks bound both sides as well)
+  static int bidirectionalSearch(BWAPI::TilePosition start, BWAPI::TilePosition end)
+  {
+    GridSearchLease forward;
+    GridSearchLease backward;
+    const WalkableGrid grid(MapData::lowResWalkability);
+    if (getAnalysisStep() == ANALYSIS_DONE) {
+      BWTA_Result::require(BWTA_Result::LAZY_LANDMARKS);
+      if (!BWTA_Result::landmarks.empty()) {
+        return bidirectionalGridSearch(*forward, *backward, grid, start, end,
+          LandmarkHeuristic(BWTA_Result::landmarks, start, end), LandmarkHeuristic(BWTA_Result::landmarks, end, start));
       }
-      int fvalue=openTiles.top().second;
-      int gvalue=gmap[p];
-      openTiles.pop();
-      closedTiles.insert(p);
-	  int minx = std::max(p.x - 1, 0);
-	  int maxx = std::min(p.x + 1, MapData::mapWidthTileRes - 1);
-	  int miny = std::max(p.y - 1, 0);
-	  int maxy = std::min(p.y + 1, MapData::mapHeightTileRes - 1);
-      for(int x=minx;x<=maxx;x++)
-        for(int y=miny;y<=maxy;y++)
-        {
-          if (!MapData::lowResWalkability[x][y]) continue;
-          if (p.x != x && p.y != y && !MapData::lowResWalkability[p.x][y] && !MapData::lowResWalkability[x][p.y]) continue;
-          BWAPI::TilePosition t(x,y);
-          if (closedTiles.find(t)!=closedTiles.end()) continue;
+    }
+    return bidirectionalGridSearch(*forward, *backward, grid, start, end, OctileHeuristic(end), OctileHeuristic(start));
+  }
 
-          int g=gvalue+10;
-          if (x!=p.x && y!=p.y) g+=4;
-		  int dx = std::abs(x - end.x);
-		  int dy = std::abs(y - end.y);
-		  int h = std::abs(dx - dy) * 10 + std::min(dx, dy) * 14;
-          int f=g+h;
-          if (gmap.find(t)==gmap.end() || g<gmap.find(t)->second)
-          {
-            gmap[t]=g;
-            openTiles.set(t,f);
-            parent[t]=p;
-          }
-        }
+  double AstarSearchDistance(BWAPI::TilePosition start, BWAPI::TilePosition end)
+  {
+    // the JPS variants already skip most of the frontier of long searches
+    const int threshold = bidirectionalSearchDistance;
+    if (pathfindingMode == PATHFINDING_ASTAR && threshold > 0 && octileDistance(end.x - start.x, end.y - start.y) > threshold * 10) {
+      int cost = bidirectionalSearch(start, end);
+      if (cost == -1) return -1;
+      return cost * 32.0 / 10.0;
     }
-    std::vector<BWAPI::TilePosition> nopath;
-    return nopath;
+    GridSearchLease context;
+    int found = searchTarget<CostOnly>(pathfindingMode, *context, start, end);
+    if (found == -1) return -1;
+    return context->getCost(found) * 32.0 / 10.0;
+  }
+  std::pair<BWAPI::TilePosition, double> AstarSearchDistance(BWAPI::TilePosition start, std::set<BWAPI::TilePosition>& end)
+  {
+    if (end.empty()) return std::make_pair(BWAPI::TilePositions::None, -1);
+    GridSearchLease context;
+    AnyGoal goal(end);
+    int found = search<CostOnly>(pathfindingMode, *context, start, goal, MultiOctileHeuristic(end));
+    if (found == -1) return std::make_pair(BWAPI::TilePositions::None, -1);
+    return std::make_pair(context->position(found), context->getCost(found) * 32.0 / 10.0);
+  }
+  std::map<BWAPI::TilePosition, double> AstarSearchDistanceAll(BWAPI::TilePosition start, std::set<BWAPI::TilePosition>& end)
+  {
+    std::map<BWAPI::TilePosition, double> result;
+    if (end.empty()) return result;
+    GridSearchLease context;
+    AllGoals goal(end, result);
+    search<CostOnly>(pathfindingMode, *context, start, goal, MultiOctileHeuristic(end));
+    return result;
+  }
+  std::vector<BWAPI::TilePosition> AstarSearchPath(BWAPI::TilePosition start, BWAPI::TilePosition end)
+  {
+    const PathfindingMode mode = pathfindingMode;
+    GridSearchLease context;
+    return getPath(mode, *context, searchTarget<RecordPath>(mode, *context, start, end));
   }
   std::vector<BWAPI::TilePosition> AstarSearchPath(BWAPI::TilePosition start, std::set<BWAPI::TilePosition> end)
   {
-    Heap<BWAPI::TilePosition,int> openTiles(true);
-    std::map<BWAPI::TilePosition,int> gmap;
-    std::map<BWAPI::TilePosition,BWAPI::TilePosition> parent;
-    std::set<BWAPI::TilePosition> closedTiles;
-    openTiles.push(std::make_pair(start,0));
-    gmap[start]=0;
-    parent[start]=start;
-    while(!openTiles.empty())
-    {
-      BWAPI::TilePosition p=openTiles.top().first;
-      if (end.find(p)!=end.end())
-      {
-        std::vector<BWAPI::TilePosition> reverse_path;
-        while(p!=parent[p])
-        {
-          reverse_path.push_back(p);
-          p=parent[p];
+    if (end.empty()) return std::vector<BWAPI::TilePosition>();
+    const PathfindingMode mode = pathfindingMode;
+    GridSearchLease context;
+    AnyGoal goal(end);
+    return getPath(mode, *context, search<RecordPath>(mode, *context, start, goal, MultiOctileHeuristic(end)));
+  }
+
+  void DijkstraDistanceMatrix(const std::vector<BWAPI::TilePosition>& sources, const std::vector<BWAPI::TilePosition>& targets,
+    const std::vector<char>& connected, RectangleArray<double>& matrix, bool parallel)
+  {
+    matrix.resize(sources.size(), targets.size());
+    for (size_t i = 0; i < sources.size(); ++i) {
+      for (size_t j = 0; j < targets.size(); ++j) matrix[i][j] = -1;
+    }
+
+    // the grid is undirected, so the searches can start from the smaller side; only a search
+    // starting on an unwalkable tile differs (it can step out of it, but nothing steps into one)
+    const bool reverse = targets.size() < sources.size();
+    const std::vector<BWAPI::TilePosition>& starts = reverse ? targets : sources;
+    const std::vector<BWAPI::TilePosition>& ends = reverse ? sources : targets;
+    const RectangleArray<bool>& walkable = MapData::lowResWalkability;
+    const int width = MapData::mapWidthTileRes;
+    const int height = MapData::mapHeightTileRes;
+    auto isInside = [&](int x, int y) { return x >= 0 && y >= 0 && x < width && y < height; };
+    auto isWanted = [&](size_t start, size_t end) {
+      return connected[reverse ? end * targets.size() + start : start * targets.size() + end] != 0;
+    };
+
+    auto searchFrom = [&](int i) {
+      const BWAPI::TilePosition from = starts[i];
+      if (!isInside(from.x, from.y)) return;
+      // nodes whose cost is needed: the ends, or for an unwalkable source the tiles it can step to
+      std::vector<int> nodes;
+      for (size_t j = 0; j < ends.size(); ++j) {
+        const BWAPI::TilePosition to = ends[j];
+        if (!isWanted(i, j) || !isInside(to.x, to.y)) continue;
+        if (!reverse || walkable[to.x][to.y]) {
+          nodes.push_back(to.x * height + to.y);
+          continue;
+        }
+        for (int x = std::max(to.x - 1, 0); x <= std::min(to.x + 1, width - 1); ++x) {
+          for (int y = std::max(to.y - 1, 0); y <= std::min(to.y + 1, height - 1); ++y) {
+            if (walkable[x][y]) nodes.push_back(x * height + y);
+          }
         }
-        reverse_path.push_back(start);
-        std::vector<BWAPI::TilePosition> path;
-        for(int i=reverse_path.size()-1;i>=0;i--)
-          path.push_back(reverse_path[i]);
-        return path;
       }
-      int fvalue=openTiles.top().second;
-      int gvalue=gmap[p];
-      openTiles.pop();
-      closedTiles.insert(p);
-	  int minx = std::max(p.x - 1, 0);
-	  int maxx = std::min(p.x + 1, MapData::mapWidthTileRes - 1);
-	  int miny = std::max(p.y - 1, 0);
-	  int maxy = std::min(p.y + 1, MapData::mapHeightTileRes - 1);
-      for(int x=minx;x<=maxx;x++)
-        for(int y=miny;y<=maxy;y++)
-        {
-          if (!MapData::lowResWalkability[x][y]) continue;
-          if (p.x != x && p.y != y && !MapData::lowResWalkability[p.x][y] && !MapData::lowResWalkability[x][p.y]) continue;
-          BWAPI::TilePosition t(x,y);
-          if (closedTiles.find(t)!=closedTiles.end()) continue;
 
-          int g=gvalue+10; if (x!=p.x && y!=p.y) g+=4;
-          int h=-1;
-          for(std::set<BWAPI::TilePosition>::iterator i=end.begin();i!=end.end();i++)
-          {
-			  int dx = std::abs(x - i->x); int dy = std::abs(y - i->y);
-			  int ch = std::abs(dx - dy) * 10 + std::min(dx, dy) * 14;
-            if (h==-1 || ch<h)
-              h=ch;
-          }
-          int f=g+h;
-          if (gmap.find(t)==gmap.end() || gmap[t]>g)
-          {
-            gmap[t]=g;
-            openTiles.set(t,f);
-            parent[t]=p;
+      GridSearchLease context;
+      if (!nodes.empty()) {
+        NodeSetGoal goal(nodes);
+        gridSearch<CostOnly>(*context, from, goal, ZeroHeuristic());
+      }
+      auto getCost = [&](int x, int y) {
+        int node = x * height + y;
+        return (!nodes.empty() && walkable[x][y] && context->isSeen(node)) ? context->getCost(node) : -1;
+      };
+
+      for (size_t j = 0; j < ends.size(); ++j) {
+        const BWAPI::TilePosition to = ends[j];
+        if (!isWanted(i, j) || !isInside(to.x, to.y)) continue;
+        int cost = -1;
+        if (to == from) {
+          cost = 0;
+        } else if (reverse && !walkable[from.x][from.y]) {
+          continue; // the target is unwalkable
+        } else if (!reverse || walkable[to.x][to.y]) {
+          cost = getCost(to.x, to.y);
+        } else {
+          // the source is unwalkable: best first step out of it
+          for (int x = std::max(to.x - 1, 0); x <= std::min(to.x + 1, width - 1); ++x) {
+            for (int y = std::max(to.y - 1, 0); y <= std::min(to.y + 1, height - 1); ++y) {
+              int next = getCost(x, y);
+              if (next == -1) continue;
+              bool diagonal = (x != to.x && y != to.y);
+              if (diagonal && !walkable[to.x][y] && !walkable[x][to.y]) continue;
+              next += diagonal ? 14 : 10;
+              if (cost == -1 || next < cost) cost = next;
+            }
           }
         }
+        if (cost == -1) continue;
+        double& distance = reverse ? matrix[j][i] : matrix[i][j];
+        distance = cost * 32.0 / 10.0;
+      }
+    };
+
+    if (!parallel) {
+      for (size_t i = 0; i < starts.size(); ++i) searchFrom((int)i);
+      return;
     }
-    std::vector<BWAPI::TilePosition> nopath;
-    return nopath;
+    std::lock_guard<std::mutex> lock(matrixSchedulerMutex);
+    const unsigned int threads = getAnalysisThreadCount();
+    if (!matrixScheduler || matrixSchedulerThreads != threads) {
+      matrixScheduler.reset(); // join the old threads before starting the new ones
+      matrixScheduler.reset(new TaskScheduler(threads));
+      matrixSchedulerThreads = threads;
+    }
+    TaskGraph graph;
+    graph.addParallelFor([&]() { return (int)starts.size(); }, searchFrom, matrixScheduler->getThreadCount());
+    matrixScheduler->run(graph);
+  }
+
+  void clearDistanceMatrixScheduler()
+  {
+    std::lock_guard<std::mutex> lock(matrixSchedulerMutex);
+    matrixScheduler.reset();
   }
 
   // ******************************
@@ -272,205 +237,44 @@ namespace BWTA
   // ******************************
 
 
+	// built by buildChokeNodes(), see ChokepointDistanceTable.h
+	static ChokepointDistanceTable chokepointDistances;
+
 	void buildChokeNodes()
 	{
-		for (const auto& region : BWTA::getRegions()) {
-			const std::set<BWTA::Chokepoint*> chokes = region->getChokepoints();
-			for (std::set<BWTA::Chokepoint*>::const_iterator choke1 = chokes.begin(); choke1 != chokes.end(); ++choke1) {
-				for (std::set<BWTA::Chokepoint*>::const_iterator choke2 = choke1; choke2 != chokes.end(); ++choke2) {
-					if (choke1 == choke2) continue;
-					// calculate cost between two chokepoints
-					int cost = (int)AstarSearchDistance(BWAPI::TilePosition((*choke1)->getCenter()), BWAPI::TilePosition((*choke2)->getCenter()));
-					if (cost != -1) { // save cost
-						MapData::chokeNodes[*choke1].insert(std::make_pair(*choke2, cost));
-						MapData::chokeNodes[*choke2].insert(std::make_pair(*choke1, cost));
-					}
-				}
-			}
-		}
+		chokepointDistances.build();
 	}
 
-	ChokePath getShortestPath2(BWAPI::TilePosition start, BWAPI::TilePosition target)
+	void clearChokeNodes()
 	{
-		// TODO check if buildChokeNodes was called (MapData::chokeNodes was populated)
-		// TODO add case where start and target are in the same region
-		// copy chokeNodeGraph and add final nodes
-		ChokepointGraph tmpChokeNodes = MapData::chokeNodes;
-		BWTA::Region* region = BWTA::getRegion(BWAPI::TilePosition(target));
-		std::set<BWTA::Chokepoint*> chokes = region->getChokepoints();
-		// get cost to each entrance of the target
-		for (std::set<BWTA::Chokepoint*>::const_iterator it = chokes.begin(); it != chokes.end(); ++it) {
-			// get cost to target
-			int cost = (int)AstarSearchDistance(target, BWAPI::TilePosition((*it)->getCenter()));
-			if (cost != -1) tmpChokeNodes[(*it)].insert(std::make_pair((BWTA::Chokepoint *)NULL, cost));
-		}
-
-		// Execute A* on tmpChokeNodes graph
-		ChokePath path;
-		std::multimap<int, BWTA::Chokepoint*> openNodes;
-		std::map<BWTA::Chokepoint*, int> gmap;
-		std::map<BWTA::Chokepoint*, BWTA::Chokepoint*> parent;
-		std::set<BWTA::Chokepoint*> closedNodes;
-
-		// set first nodes as the cost to get to region start entrances
-		region = BWTA::getRegion(BWAPI::TilePosition(start));
-		chokes = region->getChokepoints();
-		// get cost to each entrance of the start
-		for (std::set<BWTA::Chokepoint*>::const_iterator it = chokes.begin(); it != chokes.end(); ++it) {
-			// get cost to start
-			int cost = (int)AstarSearchDistance(start, BWAPI::TilePosition((*it)->getCenter()));
-			if (cost != -1) {
-				openNodes.insert(std::make_pair(cost, *it));
-				gmap[*it] = cost;
-				parent[*it] = *it;
-			}
-		}
-
-		while(!openNodes.empty()) {
-			BWTA::Chokepoint* p = openNodes.begin()->second;
-			
-			int gvalue = gmap[p];
-
-			int fvalue = openNodes.begin()->first;
-
-			openNodes.erase(openNodes.begin());
-			closedNodes.insert(p);
-
-			// child 
-			ChokeCost childNodes = tmpChokeNodes[p];
-			for (std::set< std::pair<BWTA::Chokepoint*, int> >::const_iterator child = childNodes.begin(); child != childNodes.end(); ++child) {
-				BWTA::Chokepoint* t = child->first;
-				if(t == NULL) { // we found the path 
-					//BWTA::Chokepoint* p = openNodes.begin()->second;
-					while(p != parent[p]) {
-						path.push_front(p);
-						p = parent[p];
-					}
-					path.push_front(p);
-					//DEBUG(" Path size: " << path.size() );
-					return path;
-				}
-				
-				if(closedNodes.find(t) != closedNodes.end()) continue;
-
-				int g = gvalue + child->second;
-				BWAPI::TilePosition tileCenter = BWAPI::TilePosition(t->getCenter());
-				int dx = std::abs(tileCenter.x - target.x);
-				int dy = std::abs(tileCenter.y - target.y);
-				int h = std::abs(dx - dy) * 10 + std::min(dx, dy) * 14;
-				int f = g + h;
-				if (gmap.find(t) == gmap.end() || g < gmap.find(t)->second) {
-					gmap[t] = g;
+		chokepointDistances.clear();
+	}
 
-					std::pair<std::multimap<int, BWTA::Chokepoint*>::iterator, std::multimap<int, BWTA::Chokepoint*>::iterator> itp = openNodes.equal_range(f);
-					if (itp.second == itp.first) 
-						openNodes.insert(std::make_pair(f, t));
-					else {
-						for (std::multimap<int, BWTA::Chokepoint*>::const_iterator it = itp.first; it != itp.second; ++it) {
-							if (it->second == t) {
-								openNodes.erase(it);
-								break;
-							} 
-						}
-						openNodes.insert(std::make_pair(f, t));
-					}
-					parent[t] = p;
-				}
-			}
-		}
+	const ChokepointDistanceTable& getChokepointDistanceTable()
+	{
+		if (chokepointDistances.empty()) buildChokeNodes();
+		return chokepointDistances;
+	}
 
-		return path;
+	ChokePath getShortestPath2(BWAPI::TilePosition start, BWAPI::TilePosition target)
+	{
+		if (chokepointDistances.empty()) buildChokeNodes();
+		return chokepointDistances.getPath(start, target);
 	}
 
 	int getGroundDistance2(BWAPI::TilePosition start, BWAPI::TilePosition target)
 	{
-		// TODO check if buildChokeNodes was called (MapData::chokeNodes was populated)
-		BWTA::Region* startRegion = BWTA::getRegion(start);
-		BWTA::Region* targetRegion = BWTA::getRegion(target);
-		if (startRegion == nullptr || targetRegion == nullptr) {
+		if (chokepointDistances.empty()) buildChokeNodes();
+		int startRegion = chokepointDistances.getRegionIndex(start);
+		int targetRegion = chokepointDistances.getRegionIndex(target);
+		if (startRegion == -1 || targetRegion == -1) {
 			return -1;
 		}
 		if (startRegion == targetRegion) {
 			return (int)AstarSearchDistance(start,target);
 		}
-		// copy chokeNodeGraph and add final nodes
-		ChokepointGraph tmpChokeNodes = MapData::chokeNodes;
-		std::set<BWTA::Chokepoint*> chokes = targetRegion->getChokepoints();
-		// get cost to each entrance of the target
-		for (const auto& choke : chokes) {
-			// get cost to target
-			int cost = (int)AstarSearchDistance(target, BWAPI::TilePosition(choke->getCenter()));
-			//log("[TARGET] Cost to chokepoint (" << BWAPI::TilePosition((*it)->getCenter()).x() << "," << BWAPI::TilePosition((*it)->getCenter()).y() << ": " << cost );
-			if (cost != -1) tmpChokeNodes[choke].insert(std::make_pair((BWTA::Chokepoint *)NULL, cost));
-		}
-
-		// Execute A* on tmpChokeNodes graph
-		ChokePath path;
-		std::multimap<int, BWTA::Chokepoint*> openNodes;
-		std::map<BWTA::Chokepoint*, int> gmap;
-		std::map<BWTA::Chokepoint*, BWTA::Chokepoint*> parent;
-		std::set<BWTA::Chokepoint*> closedNodes;
-
-		// set first nodes as the cost to get to region start entrances
-		chokes = startRegion->getChokepoints();
-		// get cost to each entrance of the start
-		for (const auto& choke : chokes) {
-			// get cost to start
-			int cost = (int)AstarSearchDistance(start, BWAPI::TilePosition(choke->getCenter()));
-			//log("[START] Cost to chokepoint (" << BWAPI::TilePosition((*it)->getCenter()).x() << "," << BWAPI::TilePosition((*it)->getCenter()).y() << ": " << cost );
-			if (cost != -1) {
-				openNodes.insert(std::make_pair(cost, choke));
-				gmap[choke] = cost;
-				parent[choke] = choke;
-			}
-		}
-
-		while(!openNodes.empty()) {
-			BWTA::Chokepoint* p = openNodes.begin()->second;
-			
-			int gvalue = gmap[p];
-
-			int fvalue = openNodes.begin()->first;
-
-			openNodes.erase(openNodes.begin());
-			closedNodes.insert(p);
-
-			// child 
-			ChokeCost childNodes = tmpChokeNodes[p];
-			for (std::set< std::pair<BWTA::Chokepoint*, int> >::const_iterator child = childNodes.begin(); child != childNodes.end(); ++child) {
-				BWTA::Chokepoint* t = child->first;
-				if(t == NULL) { // we found the path 
-					return gvalue + child->second;
-				}
-				
-				if(closedNodes.find(t) != closedNodes.end()) continue;
-
-				int g = gvalue + child->second;
-				BWAPI::TilePosition tileCenter = BWAPI::TilePosition(t->getCenter());
-				int dx = std::abs(tileCenter.x - target.x);
-				int dy = std::abs(tileCenter.y - target.y);
-				int h = std::abs(dx - dy) * 10 + std::min(dx, dy) * 14;
-				int f = g + h;
-				if (gmap.find(t) == gmap.end() || g < gmap.find(t)->second) {
-					gmap[t] = g;
-
-					std::pair<std::multimap<int, BWTA::Chokepoint*>::iterator, std::multimap<int, BWTA::Chokepoint*>::iterator> itp = openNodes.equal_range(f);
-					if (itp.second == itp.first) 
-						openNodes.insert(std::make_pair(f, t));
-					else {
-						for (std::multimap<int, BWTA::Chokepoint*>::const_iterator it = itp.first; it != itp.second; ++it) {
-							if (it->second == t) {
-								openNodes.erase(it);
-								break;
-							} 
-						}
-						openNodes.insert(std::make_pair(f, t));
-					}
-					parent[t] = p;
-				}
-			}
-		}
-
-		return -1;
+		int distance = chokepointDistances.getDistance(start, target);
+		if (distance == -1) return -1;
+		return (int)(distance * 32.0 / 10.0);
 	}
-}
\ No newline at end of file
+}
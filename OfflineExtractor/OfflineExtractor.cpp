@@ -24,6 +24,7 @@ int main(int argc, char * argv[])
 
 	// Normal procedure to analyze map
 	std::cout << "All info loaded, analyzing map as regular..." << std::endl;
+	BWTA::setAnalysisCheckpoints(true); // re-runs after tuning a parameter only redo the affected stages
 	BWTA::analyze();
 	std::cout << "DONE" << std::endl;
 
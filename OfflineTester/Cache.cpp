@@ -0,0 +1,297 @@
+#include "Cache.h"
+#include "../BWTA/Source/BWTA_Result.h"
+#include "../BWTA/Source/LoadData.h"
+#include "../BWTA/Source/RleColumnArray.h"
+#include "../BWTA/Source/Timer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <iterator>
+#include <tuple>
+
+namespace BWTA
+{
+	void analyze_map(); // TerrainAnalysis.cpp
+}
+
+static void timeDecoding(const char* name, const BWTA::RectangleArray<int>& grid)
+{
+	const int loops = 100;
+	Timer timer;
+
+	BWTA::RleColumnArray rle;
+	rle.encode(grid);
+	BWTA::RectangleArray<int> decoded;
+	timer.start();
+	for (int i = 0; i < loops; ++i) rle.decode(decoded);
+	double decodeTime = timer.stopAndGetTime() / loops;
+
+	// what loading a raw section costs at least: one copy of the values
+	BWTA::RectangleArray<int> copy(grid.getWidth(), grid.getHeight());
+	const size_t bytes = sizeof(int) * grid.getWidth() * grid.getHeight();
+	timer.start();
+	for (int i = 0; i < loops; ++i) memcpy(copy[0], grid[0], bytes);
+	double copyTime = timer.stopAndGetTime() / loops;
+
+	bool same = true;
+	for (unsigned int x = 0; x < grid.getWidth() && same; ++x) {
+		same = memcmp(decoded[x], grid[x], sizeof(int) * grid.getHeight()) == 0;
+	}
+	std::cout << name << ": " << rle.getRunCount() << " runs (" << rle.byteSize() << " bytes instead of " << bytes
+		<< "), decoded in " << decodeTime * 1000 << " ms, copied in " << copyTime * 1000 << " ms"
+		<< (same ? "" : ", DECODED GRID DIFFERS") << std::endl;
+}
+
+void timeLabelMapDecoding()
+{
+	timeDecoding("Region labels", BWTA::BWTA_Result::regionLabelMap);
+	timeDecoding("Obstacle labels", BWTA::BWTA_Result::obstacleLabelMap);
+	timeDecoding("Closest obstacle labels", BWTA::BWTA_Result::closestObstacleLabelMap);
+}
+
+// The analysis results in a form that does not depend on the addresses of the objects: the regions and
+// polygons by their index, the chokepoints and base locations sorted by position
+struct ResultSnapshot
+{
+	std::map<std::string, std::string> products;
+	std::map<std::string, std::vector<int>> grids;
+};
+
+template <class Object>
+static std::map<Object*, int> indices(const std::vector<Object*>& objects)
+{
+	std::map<Object*, int> ids;
+	for (size_t i = 0; i < objects.size(); ++i) ids[objects[i]] = (int)i;
+	ids[nullptr] = -1;
+	return ids;
+}
+
+template <class Object>
+static std::string idList(const std::set<Object*>& objects, std::map<Object*, int>& ids)
+{
+	std::vector<int> list;
+	for (const auto& object : objects) list.push_back(ids[object]);
+	std::sort(list.begin(), list.end());
+	std::ostringstream out;
+	for (int id : list) out << id << " ";
+	return out.str();
+}
+
+static void writePoints(std::ostream& out, const std::vector<BWAPI::Position>& points)
+{
+	out << points.size() << ":";
+	for (const auto& p : points) out << " " << p.x << "," << p.y;
+	out << "\n";
+}
+
+template <class Type, class Id>
+static std::vector<int> gridValues(const BWTA::RectangleArray<Type>& grid, Id id)
+{
+	std::vector<int> values;
+	values.push_back(grid.getWidth());
+	values.push_back(grid.getHeight());
+	for (unsigned int x = 0; x < grid.getWidth(); ++x) {
+		for (unsigned int y = 0; y < grid.getHeight(); ++y) values.push_back(id(grid[x][y]));
+	}
+	return values;
+}
+
+// the bytes save(out) writes, for the tables without pointers
+static std::string serialized(void (*save)(BWTA::CacheWriter&))
+{
+	const char* filename = "roundtrip-section.tmp";
+	BWTA::CacheWriter out;
+	save(out);
+	if (!out.save(filename, 0, 0, 0)) return std::string();
+	std::string bytes;
+	{
+		std::ifstream in(filename, std::ios::in | std::ios::binary);
+		bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+	std::remove(filename);
+	return bytes;
+}
+
+static ResultSnapshot takeSnapshot()
+{
+	using namespace BWTA;
+	for (int member = 0; member < BWTA_Result::LAZY_MEMBER_COUNT; ++member) {
+		BWTA_Result::require(static_cast<BWTA_Result::LazyMember>(member));
+	}
+
+	std::vector<Chokepoint*> chokepoints(BWTA_Result::chokepoints.begin(), BWTA_Result::chokepoints.end());
+	std::sort(chokepoints.begin(), chokepoints.end(), [](Chokepoint* a, Chokepoint* b) {
+		return std::make_tuple(a->getSides().first.x, a->getSides().first.y, a->getSides().second.x, a->getSides().second.y)
+			< std::make_tuple(b->getSides().first.x, b->getSides().first.y, b->getSides().second.x, b->getSides().second.y);
+	});
+	std::vector<BaseLocation*> bases(BWTA_Result::baselocations.begin(), BWTA_Result::baselocations.end());
+	std::sort(bases.begin(), bases.end(), [](BaseLocation* a, BaseLocation* b) {
+		return std::make_pair(a->getTilePosition().x, a->getTilePosition().y) < std::make_pair(b->getTilePosition().x, b->getTilePosition().y);
+	});
+	std::map<Region*, int> rid = indices(BWTA_Result::regions);
+	std::map<Polygon*, int> pid = indices(BWTA_Result::unwalkablePolygons);
+	std::map<Chokepoint*, int> cid = indices(chokepoints);
+	std::map<BaseLocation*, int> bid = indices(bases);
+
+	ResultSnapshot snapshot;
+	std::ostringstream out;
+	out << std::setprecision(17);
+	for (const auto& polygon : BWTA_Result::unwalkablePolygons) {
+		writePoints(out, *polygon);
+		for (const auto& hole : polygon->getHoles()) writePoints(out, *hole);
+	}
+	snapshot.products["polygons"] = out.str();
+
+	out.str("");
+	for (const auto& region : BWTA_Result::regions) {
+		out << region->getLabel() << " " << region->getCenter() << " " << region->getOpennessPosition() << " "
+			<< region->getOpennessDistance() << " " << region->getMaxDistance() << " " << region->getColorLabel() << " "
+			<< region->getHUE() << "\n";
+		writePoints(out, region->getPolygon());
+		for (const auto& hole : region->getPolygon().getHoles()) writePoints(out, *hole);
+		out << idList(region->getChokepoints(), cid) << "| " << idList(region->getBaseLocations(), bid)
+			<< "| " << idList(region->getReachableRegions(), rid) << "\n";
+		for (const auto& cover : region->getCoverPoints()) out << cover << " ";
+		out << "\n";
+	}
+	snapshot.products["regions"] = out.str();
+
+	out.str("");
+	for (const auto& chokepoint : chokepoints) {
+		out << rid[chokepoint->getRegions().first] << " " << rid[chokepoint->getRegions().second] << " "
+			<< chokepoint->getSides().first << " " << chokepoint->getSides().second << " "
+			<< chokepoint->getCenter() << " " << chokepoint->getWidth() << "\n";
+	}
+	snapshot.products["chokepoints"] = out.str();
+
+	out.str("");
+	for (const auto& base : bases) {
+		out << base->getPosition() << " " << base->getTilePosition() << " " << rid[base->getRegion()] << " "
+			<< base->isIsland() << " " << base->isStartLocation() << " " << base->minerals() << " " << base->gas() << "\n";
+		for (const auto& other : bases) out << base->getGroundDistance(other) << " " << base->getAirDistance(other) << " ";
+		out << "\n";
+	}
+	out << idList(BWTA_Result::startlocations, bid) << "\n";
+	snapshot.products["base locations"] = out.str();
+
+	snapshot.products["skeleton"] = serialized(save_skeleton);
+	snapshot.products["jump table"] = serialized(save_jump_table);
+	snapshot.products["landmarks"] = serialized(save_landmarks);
+	snapshot.products["contraction hierarchy"] = serialized(save_contraction_hierarchy);
+	snapshot.products["navigation mesh"] = serialized(save_navmesh);
+
+	snapshot.grids["getRegion"] = gridValues(BWTA_Result::getRegion, [&](Region* r) { return rid[r]; });
+	snapshot.grids["getChokepoint"] = gridValues(BWTA_Result::getChokepoint, [&](Chokepoint* c) { return cid[c]; });
+	snapshot.grids["getChokepointW"] = gridValues(BWTA_Result::getChokepointW, [&](Chokepoint* c) { return cid[c]; });
+	snapshot.grids["getBaseLocation"] = gridValues(BWTA_Result::getBaseLocation, [&](BaseLocation* b) { return bid[b]; });
+	snapshot.grids["getBaseLocationW"] = gridValues(BWTA_Result::getBaseLocationW, [&](BaseLocation* b) { return bid[b]; });
+	snapshot.grids["getUnwalkablePolygon"] = gridValues(BWTA_Result::getUnwalkablePolygon, [&](Polygon* p) { return pid[p]; });
+	auto label = [](int value) { return value; };
+	snapshot.grids["regionLabelMap"] = gridValues(BWTA_Result::regionLabelMap, label);
+	snapshot.grids["obstacleLabelMap"] = gridValues(BWTA_Result::obstacleLabelMap, label);
+	snapshot.grids["closestObstacleLabelMap"] = gridValues(BWTA_Result::closestObstacleLabelMap, label);
+	return snapshot;
+}
+
+// prints the products and grids that differ, returns how many
+static int compareSnapshots(const char* step, const ResultSnapshot& expected, const ResultSnapshot& actual)
+{
+	int differences = 0;
+	for (const auto& product : expected.products) {
+		auto it = actual.products.find(product.first);
+		if (it == actual.products.end() || it->second != product.second) {
+			++differences;
+			std::cout << " " << step << ": " << product.first << " differ" << std::endl;
+		}
+	}
+	for (const auto& grid : expected.grids) {
+		auto it = actual.grids.find(grid.first);
+		if (it == actual.grids.end() || it->second != grid.second) {
+			++differences;
+			std::cout << " " << step << ": " << grid.first << " differs" << std::endl;
+		}
+	}
+	std::cout << step << ": " << differences << " differences" << std::endl;
+	return differences;
+}
+
+static std::string readFile(const std::string& filename)
+{
+	std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void writeFile(const std::string& filename, const std::string& bytes)
+{
+	std::ofstream out(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	out.write(bytes.data(), bytes.size());
+}
+
+// what runAnalysis does with a cache file that does not load: loadMap() and a fresh analysis
+static void checkFallback(const char* step, const std::string& filename, const ResultSnapshot& expected)
+{
+	BWTA::clearResults();
+	BWTA::loadMap();
+	if (BWTA::load_data(filename)) {
+		std::cout << step << ": the file was loaded" << std::endl;
+		return;
+	}
+	if (!BWTA::BWTA_Result::regions.empty() || !BWTA::BWTA_Result::chokepoints.empty() || !BWTA::BWTA_Result::baselocations.empty()) {
+		std::cout << " " << step << ": the failed load left results behind" << std::endl;
+	}
+	BWTA::analyze_map();
+	compareSnapshots(step, expected, takeSnapshot());
+}
+
+void testCacheRoundTrip()
+{
+	const std::string filename = "roundtrip.bwta";
+	const std::string brokenFilename = "roundtrip-broken.bwta";
+
+	// a fresh analysis, the results of analyze() may come from an older cache file
+	BWTA::clearResults();
+	BWTA::loadMap();
+	BWTA::analyze_map();
+	ResultSnapshot analysed = takeSnapshot();
+
+	if (!BWTA::save_data(filename)) {
+		std::cout << "Cache round trip: could not save " << filename << std::endl;
+		return;
+	}
+	BWTA::clearResults();
+	BWTA::loadMap();
+	if (BWTA::load_data(filename)) {
+		compareSnapshots("Cache round trip", analysed, takeSnapshot());
+	} else {
+		std::cout << "Cache round trip: could not load " << filename << std::endl;
+	}
+
+	std::string bytes = readFile(filename);
+	BWTA::clearResults(); // unmaps the file
+
+	// cut in the middle of the sections
+	writeFile(brokenFilename, bytes.substr(0, bytes.size() / 2));
+	checkFallback("Truncated cache file", brokenFilename, analysed);
+
+	// a polygon count far larger than the section
+	BWTA::CacheFile::Header header;
+	if (BWTA::CacheFile::readHeader(filename, header)) {
+		std::string corrupted = bytes;
+		for (uint32_t i = 0; i < header.sectionCount; ++i) {
+			const size_t entry = BWTA::CacheFile::HEADER_SIZE + i * BWTA::CacheFile::SECTION_ENTRY_SIZE;
+			const unsigned char* e = reinterpret_cast<const unsigned char*>(corrupted.data()) + entry;
+			if (BWTA::CacheFile::readUInt32(e) != BWTA::CacheFile::POLYGONS) continue;
+			const size_t offset = BWTA::CacheFile::readUInt32(e + 8);
+			corrupted[offset] = corrupted[offset + 1] = corrupted[offset + 2] = '\xFF';
+			corrupted[offset + 3] = '\x7F';
+		}
+		BWTA::clearResults();
+		writeFile(brokenFilename, corrupted);
+		checkFallback("Corrupted cache file", brokenFilename, analysed);
+	}
+
+	BWTA::clearResults();
+	std::remove(filename.c_str());
+	std::remove(brokenFilename.c_str());
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "BWTA.h"
+
+// decoding the run-length encoded label maps against copying their raw values
+void timeLabelMapDecoding();
+// save_data then load_data gives the results of the analysis back, and a truncated or corrupted
+// cache file is rejected so the map is analysed again
+void testCacheRoundTrip();
@@ -2,6 +2,7 @@
 #include "WallingGHOST.h"
 #include "WallingASP.h"
 #include "Pathfinding.h"
+#include "Cache.h"
 
 #include <tlhelp32.h>
 #include <chrono>
@@ -14,11 +15,15 @@ int main(int argc, char * argv[])
 	// Off-line map file parsing
 	bool ok = BWTA::parseMapFile("maps\\(3)Aztec.scx");
 	if (!ok) return 1;
+	// the contraction hierarchy checked by patfhindingTest
+	BWTA::setGroundDistanceOracle(true);
 	// Normal procedure to analyze map
 	BWTA::analyze();
 
 
 	patfhindingTest();
+	timeLabelMapDecoding();
+	testCacheRoundTrip();
 // 	wallingTest(); // Tests with "maps\\(3)Aztec.scx"
 
 
@@ -32,6 +37,16 @@ void patfhindingTest() {
 	compareDistance(BWAPI::TilePosition(9, 84), BWAPI::TilePosition(69, 7));
 	compareDistance(BWAPI::TilePosition(9, 84), BWAPI::TilePosition(118, 101));
 	compareDistance(BWAPI::TilePosition(69, 7), BWAPI::TilePosition(118, 101));
+
+	std::vector<BWAPI::TilePosition> positions = { BWAPI::TilePosition(9, 84), BWAPI::TilePosition(69, 7), BWAPI::TilePosition(118, 101) };
+	for (const auto& base : BWTA::getBaseLocations()) positions.push_back(base->getTilePosition());
+	testDistanceMatrix(positions);
+	testJumpPointSearch(positions);
+	testHierarchicalDistance(positions);
+	testContractionHierarchy(positions);
+	testBidirectionalSearch(positions);
+	testDynamicPaths();
+	testPathRequests();
 }
 
 void wallingTest()
@@ -1,6 +1,10 @@
 #include "Pathfinding.h"
 #include "../BWTA/Source/Timer.h"
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
 void compareDistance(BWAPI::TilePosition pos1, BWAPI::TilePosition pos2)
 {
 	std::cout << "Distance between " << pos1 << " and " << pos2 << std::endl;
@@ -14,4 +18,357 @@ void compareDistance(BWAPI::TilePosition pos1, BWAPI::TilePosition pos2)
 	timer.start();
 	int dist2 = BWTA::getGroundDistance2(pos1, pos2);
 	std::cout << " Distance2: " << dist2 << " computed in " << timer.stopAndGetTime() << " seconds" << std::endl;
-}
\ No newline at end of file
+}
+
+// an unwalkable tile next to a walkable one, the searches must step out of it
+static BWAPI::TilePosition findUnwalkableStart()
+{
+	const BWTA::RectangleArray<bool>& walkable = BWTA::MapData::lowResWalkability;
+	for (int x = 1; x + 1 < (int)walkable.getWidth(); ++x) {
+		for (int y = 1; y + 1 < (int)walkable.getHeight(); ++y) {
+			if (!walkable[x][y] && (walkable[x - 1][y] || walkable[x + 1][y] || walkable[x][y - 1] || walkable[x][y + 1])) {
+				return BWAPI::TilePosition(x, y);
+			}
+		}
+	}
+	return BWAPI::TilePositions::None;
+}
+
+static bool sameDistance(double a, double b)
+{
+	return std::abs(a - b) < 0.001;
+}
+
+// the positions with an unwalkable start tile first
+static std::vector<BWAPI::TilePosition> withUnwalkableStart(std::vector<BWAPI::TilePosition> positions)
+{
+	BWAPI::TilePosition unwalkable = findUnwalkableStart();
+	if (unwalkable != BWAPI::TilePositions::None) {
+		std::cout << "Unwalkable start " << unwalkable << std::endl;
+		positions.insert(positions.begin(), unwalkable);
+	}
+	return positions;
+}
+
+// distances of every pair of positions with unidirectional A*, the reference of the tests below
+static BWTA::RectangleArray<double> astarDistances(const std::vector<BWAPI::TilePosition>& positions)
+{
+	BWTA::PathfindingMode previousMode = BWTA::getPathfindingMode();
+	BWTA::setPathfindingMode(BWTA::PATHFINDING_ASTAR);
+	BWTA::setBidirectionalSearchDistance(0);
+	BWTA::RectangleArray<double> reference(positions.size(), positions.size());
+	for (size_t i = 0; i < positions.size(); ++i) {
+		for (size_t j = 0; j < positions.size(); ++j) reference[i][j] = BWTA::getGroundDistance(positions[i], positions[j]);
+	}
+	BWTA::setBidirectionalSearchDistance(64); // default
+	BWTA::setPathfindingMode(previousMode);
+	return reference;
+}
+
+// distance(i, j) against the reference for the first rows x columns pairs (all by default), returns
+// the mismatches
+static int compareWithAstar(const char* name, const std::vector<BWAPI::TilePosition>& positions,
+	const BWTA::RectangleArray<double>& reference, std::function<double(size_t, size_t)> distance,
+	size_t rows = 0, size_t columns = 0)
+{
+	if (rows == 0) rows = positions.size();
+	if (columns == 0) columns = positions.size();
+	int mismatches = 0;
+	Timer timer;
+	timer.start();
+	for (size_t i = 0; i < rows; ++i) {
+		for (size_t j = 0; j < columns; ++j) {
+			double dist = distance(i, j);
+			if (!sameDistance(dist, reference[i][j])) {
+				++mismatches;
+				std::cout << " " << name << " " << positions[i] << " -> " << positions[j] << ": " << dist
+					<< " instead of " << reference[i][j] << std::endl;
+			}
+		}
+	}
+	std::cout << name << ": " << mismatches << " mismatches in " << timer.stopAndGetTime() << " seconds" << std::endl;
+	return mismatches;
+}
+
+void testDistanceMatrix(const std::vector<BWAPI::TilePosition>& tiles)
+{
+	std::vector<BWAPI::TilePosition> positions = withUnwalkableStart(tiles);
+	BWTA::RectangleArray<double> reference = astarDistances(positions);
+
+	// one Dijkstra per source, or per target when there are fewer targets (from an unwalkable target)
+	const size_t few = std::min<size_t>(2, positions.size());
+	std::vector<BWAPI::TilePosition> firstPositions(positions.begin(), positions.begin() + few);
+	for (int parallel = 0; parallel < 2; ++parallel) {
+		BWTA::RectangleArray<double> matrix;
+		BWTA::getGroundDistanceMatrix(positions, positions, matrix, parallel != 0);
+		compareWithAstar(parallel ? "Distance matrix (parallel)" : "Distance matrix", positions, reference,
+			[&](size_t i, size_t j) { return matrix[i][j]; });
+		BWTA::getGroundDistanceMatrix(firstPositions, positions, matrix, parallel != 0);
+		compareWithAstar(parallel ? "Distance matrix, few sources (parallel)" : "Distance matrix, few sources", positions, reference,
+			[&](size_t i, size_t j) { return matrix[i][j]; }, few, positions.size());
+		BWTA::getGroundDistanceMatrix(positions, firstPositions, matrix, parallel != 0);
+		compareWithAstar(parallel ? "Distance matrix, few targets (parallel)" : "Distance matrix, few targets", positions, reference,
+			[&](size_t i, size_t j) { return matrix[i][j]; }, positions.size(), few);
+	}
+}
+
+void testJumpPointSearch(const std::vector<BWAPI::TilePosition>& tiles)
+{
+	std::vector<BWAPI::TilePosition> positions = withUnwalkableStart(tiles);
+	BWTA::RectangleArray<double> reference = astarDistances(positions);
+	BWTA::PathfindingMode previousMode = BWTA::getPathfindingMode();
+
+	BWTA::setPathfindingMode(BWTA::PATHFINDING_JPS);
+	compareWithAstar("JPS", positions, reference,
+		[&](size_t i, size_t j) { return BWTA::getGroundDistance(positions[i], positions[j]); });
+	// from the unwalkable start tile it falls back to JPS
+	BWTA::setPathfindingMode(BWTA::PATHFINDING_JPS_PLUS);
+	compareWithAstar("JPS+", positions, reference,
+		[&](size_t i, size_t j) { return BWTA::getGroundDistance(positions[i], positions[j]); });
+
+	BWTA::setPathfindingMode(previousMode);
+}
+
+void testHierarchicalDistance(const std::vector<BWAPI::TilePosition>& tiles)
+{
+	std::vector<BWAPI::TilePosition> positions = withUnwalkableStart(tiles);
+	BWTA::RectangleArray<double> reference = astarDistances(positions);
+	const size_t count = positions.size();
+
+	// HPA* goes through the chokepoint centers, it is never shorter than A* (distances truncated to int);
+	// it has no distance for a tile outside the regions, as the unwalkable start tile may be
+	int shorter = 0;
+	int outside = 0;
+	double maxOverhead = 0;
+	Timer timer;
+	timer.start();
+	for (size_t i = 0; i < count; ++i) {
+		for (size_t j = 0; j < count; ++j) {
+			int dist = BWTA::getGroundDistance2(positions[i], positions[j]);
+			if (dist == -1 && (BWTA::getRegion(positions[i]) == nullptr || BWTA::getRegion(positions[j]) == nullptr)) {
+				++outside;
+			} else if ((dist == -1) != (reference[i][j] < 0) || (dist != -1 && dist < (int)reference[i][j])) {
+				++shorter;
+				std::cout << " HPA* " << positions[i] << " -> " << positions[j] << ": " << dist
+					<< " for " << reference[i][j] << std::endl;
+			} else if (dist > 0) {
+				maxOverhead = std::max(maxOverhead, dist / reference[i][j] - 1.0);
+			}
+		}
+	}
+	std::cout << "HPA*: " << shorter << " mismatches (" << outside << " pairs outside the regions), at most "
+		<< maxOverhead * 100 << "% longer, in " << timer.stopAndGetTime() << " seconds" << std::endl;
+}
+
+void testContractionHierarchy(const std::vector<BWAPI::TilePosition>& tiles)
+{
+	std::vector<BWAPI::TilePosition> positions = withUnwalkableStart(tiles);
+	BWTA::RectangleArray<double> reference = astarDistances(positions);
+
+	// the hierarchy needs setGroundDistanceOracle(true) before analyze(), else it is A* again
+	std::cout << "Contraction hierarchy " << (BWTA::GroundDistanceOracle::isAvailable() ? "available" : "not available") << std::endl;
+	BWTA::GroundDistanceOracle oracle;
+	compareWithAstar("Contraction hierarchy", positions, reference,
+		[&](size_t i, size_t j) { return oracle.getDistance(positions[i], positions[j]); });
+
+	// while tiles are blocked it answers with getGroundDistance
+	BWTA::blockTiles(positions.back(), 1, 1);
+	BWTA::RectangleArray<double> blockedReference = astarDistances(positions);
+	compareWithAstar("Contraction hierarchy, a tile blocked", positions, blockedReference,
+		[&](size_t i, size_t j) { return oracle.getDistance(positions[i], positions[j]); });
+	BWTA::unblockAllTiles();
+}
+
+void testBidirectionalSearch(const std::vector<BWAPI::TilePosition>& tiles)
+{
+	std::vector<BWAPI::TilePosition> positions = withUnwalkableStart(tiles);
+	BWTA::RectangleArray<double> reference = astarDistances(positions);
+	BWTA::PathfindingMode previousMode = BWTA::getPathfindingMode();
+
+	// searched from both ends whatever the distance
+	BWTA::setPathfindingMode(BWTA::PATHFINDING_ASTAR);
+	BWTA::setBidirectionalSearchDistance(1);
+	compareWithAstar("Bidirectional A*", positions, reference,
+		[&](size_t i, size_t j) { return BWTA::getGroundDistance(positions[i], positions[j]); });
+	BWTA::setBidirectionalSearchDistance(64); // default
+	BWTA::setPathfindingMode(previousMode);
+}
+
+// DynamicPath and DynamicDistanceMap against a fresh getGroundDistance, returns the mismatches
+static int checkDynamic(const char* step, BWTA::DynamicPath& path, BWTA::DynamicDistanceMap& distanceMap,
+	const std::vector<BWAPI::TilePosition>& tiles)
+{
+	int mismatches = 0;
+	double expected = BWTA::getGroundDistance(path.getStart(), path.getEnd());
+	double dist = path.getDistance();
+	if (!sameDistance(dist, expected)) {
+		++mismatches;
+		std::cout << " DynamicPath " << path.getStart() << " -> " << path.getEnd() << ": " << dist << " instead of " << expected << std::endl;
+	}
+	std::vector<BWAPI::TilePosition> tilePath = path.getPath();
+	if (tilePath.empty() != (expected < 0)
+		|| (!tilePath.empty() && (tilePath.front() != path.getStart() || tilePath.back() != path.getEnd()))) {
+		++mismatches;
+		std::cout << " DynamicPath: path of " << tilePath.size() << " tiles does not join start and end" << std::endl;
+	}
+	for (const auto& tile : tilePath) {
+		if (BWTA::isTileBlocked(tile)) {
+			++mismatches;
+			std::cout << " DynamicPath: goes through the blocked tile " << tile << std::endl;
+			break;
+		}
+	}
+
+	for (const auto& tile : tiles) {
+		expected = BWTA::getGroundDistance(distanceMap.getStart(), tile);
+		dist = distanceMap.getDistance(tile);
+		if (!sameDistance(dist, expected)) {
+			++mismatches;
+			std::cout << " DynamicDistanceMap " << distanceMap.getStart() << " -> " << tile << ": " << dist
+				<< " instead of " << expected << std::endl;
+		}
+	}
+	std::cout << step << ": " << mismatches << " mismatches" << std::endl;
+	return mismatches;
+}
+
+void testDynamicPaths()
+{
+	const std::set<BWTA::BaseLocation*>& starts = BWTA::getStartLocations();
+	if (starts.size() < 2) return;
+	BWAPI::TilePosition start = (*starts.begin())->getTilePosition();
+	BWAPI::TilePosition end = (*starts.rbegin())->getTilePosition();
+
+	BWTA::DynamicPath path(start, end);
+	BWTA::DynamicDistanceMap distanceMap(start);
+	std::vector<BWAPI::TilePosition> tiles;
+	for (const auto& base : BWTA::getBaseLocations()) tiles.push_back(base->getTilePosition());
+
+	// a 7x7 square on the middle of the path, the distances are checked around it too
+	auto blockAcrossPath = [&](BWAPI::TilePosition& topLeft) {
+		std::vector<BWAPI::TilePosition> current = BWTA::getShortestPath(start, end);
+		if (current.empty()) return false;
+		BWAPI::TilePosition middle = current[current.size() / 2];
+		topLeft = BWAPI::TilePosition(middle.x - 3, middle.y - 3);
+		BWTA::blockTiles(topLeft, 7, 7);
+		for (int i = -1; i <= 7; ++i) {
+			tiles.push_back(BWAPI::TilePosition(topLeft.x + i, topLeft.y - 1));
+			tiles.push_back(BWAPI::TilePosition(topLeft.x + i, topLeft.y + 7));
+			tiles.push_back(BWAPI::TilePosition(topLeft.x - 1, topLeft.y + i));
+			tiles.push_back(BWAPI::TilePosition(topLeft.x + 7, topLeft.y + i));
+		}
+		return true;
+	};
+
+	int mismatches = checkDynamic("Dynamic paths, no blocked tiles", path, distanceMap, tiles);
+	BWAPI::TilePosition first, second;
+	if (!blockAcrossPath(first)) return;
+	mismatches += checkDynamic("Dynamic paths, first square blocked", path, distanceMap, tiles);
+	bool secondBlocked = blockAcrossPath(second);
+	if (secondBlocked) mismatches += checkDynamic("Dynamic paths, second square blocked", path, distanceMap, tiles);
+	BWTA::unblockTiles(first, 7, 7);
+	mismatches += checkDynamic("Dynamic paths, first square unblocked", path, distanceMap, tiles);
+	if (secondBlocked) {
+		BWTA::unblockTiles(second, 7, 7);
+		mismatches += checkDynamic("Dynamic paths, second square unblocked", path, distanceMap, tiles);
+	}
+	BWTA::unblockAllTiles();
+	std::cout << "Dynamic paths: " << mismatches << " mismatches" << std::endl;
+}
+
+// steps the request with the smallest budget until it is done, calling between(steps) after each step
+static int runPathRequest(BWTA::PathRequest& request, const std::function<void(int)>& between)
+{
+	int steps = 0;
+	while (request.step(0) == BWTA::PathRequest::PENDING) {
+		++steps;
+		between(steps);
+	}
+	return steps + 1;
+}
+
+// length in pixels of a path of adjacent tiles, -1 if two tiles are not adjacent or one is blocked
+static double pathLength(const std::vector<BWAPI::TilePosition>& path)
+{
+	if (path.empty()) return -1;
+	int cost = 0;
+	for (size_t i = 0; i < path.size(); ++i) {
+		if (BWTA::isTileBlocked(path[i])) return -1;
+		if (i == 0) continue;
+		int dx = std::abs(path[i].x - path[i - 1].x);
+		int dy = std::abs(path[i].y - path[i - 1].y);
+		if (dx > 1 || dy > 1 || dx + dy == 0) return -1;
+		cost += dx + dy == 2 ? 14 : 10;
+	}
+	return cost * 32.0 / 10.0;
+}
+
+// the finished request against getShortestPath and getGroundDistance on the current walkability; the
+// two searches use different heuristics, so of several shortest paths they may not pick the same one
+static int checkPathRequest(const char* step, const BWTA::PathRequest& request, int steps)
+{
+	int mismatches = 0;
+	std::vector<BWAPI::TilePosition> expectedPath = BWTA::getShortestPath(request.getStart(), request.getEnd());
+	double expected = BWTA::getGroundDistance(request.getStart(), request.getEnd());
+	if ((request.getStatus() == BWTA::PathRequest::FOUND) != !expectedPath.empty()) {
+		++mismatches;
+		std::cout << " PathRequest " << request.getStart() << " -> " << request.getEnd() << ": "
+			<< (request.getStatus() == BWTA::PathRequest::FOUND ? "found" : "not found") << " instead of "
+			<< (expectedPath.empty() ? "not found" : "found") << std::endl;
+	}
+	if (!sameDistance(request.getDistance(), expected)) {
+		++mismatches;
+		std::cout << " PathRequest " << request.getStart() << " -> " << request.getEnd() << ": " << request.getDistance()
+			<< " instead of " << expected << std::endl;
+	}
+	const std::vector<BWAPI::TilePosition>& path = request.getPath();
+	if (!path.empty() && (path.front() != request.getStart() || path.back() != request.getEnd()
+		|| !sameDistance(pathLength(path), request.getDistance()))) {
+		++mismatches;
+		std::cout << " PathRequest: path of " << path.size() << " tiles is " << pathLength(path)
+			<< " long or does not join start and end" << std::endl;
+	}
+	if (!sameDistance(pathLength(path), pathLength(expectedPath))) {
+		++mismatches;
+		std::cout << " PathRequest: path " << pathLength(path) << " long instead of getShortestPath's "
+			<< pathLength(expectedPath) << std::endl;
+	}
+	std::cout << step << ": " << steps << " steps, " << mismatches << " mismatches" << std::endl;
+	return mismatches;
+}
+
+void testPathRequests()
+{
+	const std::set<BWTA::BaseLocation*>& starts = BWTA::getStartLocations();
+	if (starts.size() < 2) return;
+	BWAPI::TilePosition start = (*starts.begin())->getTilePosition();
+	BWAPI::TilePosition end = (*starts.rbegin())->getTilePosition();
+	const BWTA::PathfindingMode mode = BWTA::getPathfindingMode();
+	BWTA::setPathfindingMode(BWTA::PATHFINDING_ASTAR);
+	std::vector<BWAPI::TilePosition> path = BWTA::getShortestPath(start, end);
+	if (path.empty()) {
+		BWTA::setPathfindingMode(mode);
+		return;
+	}
+	// a 7x7 square on the middle of the path
+	BWAPI::TilePosition topLeft(path[path.size() / 2].x - 3, path[path.size() / 2].y - 3);
+
+	BWTA::PathRequest unchanged(start, end);
+	int steps = runPathRequest(unchanged, [](int) {});
+	int mismatches = checkPathRequest("Path request", unchanged, steps);
+
+	// the square is blocked after the first step, the search has to go around it
+	BWTA::PathRequest blocked(start, end);
+	steps = runPathRequest(blocked, [&](int step) { if (step == 1) BWTA::blockTiles(topLeft, 7, 7); });
+	if (steps == 1) std::cout << " Path request: finished in one step, nothing was blocked during the search" << std::endl;
+	mismatches += checkPathRequest("Path request, square blocked during the search", blocked, steps);
+
+	// and unblocked again, the search has to find the straight path
+	BWTA::PathRequest unblocked(start, end);
+	steps = runPathRequest(unblocked, [&](int step) { if (step == 1) BWTA::unblockTiles(topLeft, 7, 7); });
+	mismatches += checkPathRequest("Path request, square unblocked during the search", unblocked, steps);
+
+	BWTA::unblockAllTiles();
+	BWTA::setPathfindingMode(mode);
+	std::cout << "Path requests: " << mismatches << " mismatches" << std::endl;
+}
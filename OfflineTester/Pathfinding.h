@@ -3,4 +3,25 @@
 #include "BWTA.h"
 #include "..\BWTA\Source\MapData.h"
 
-void compareDistance(BWAPI::TilePosition pos1, BWAPI::TilePosition pos2);
\ No newline at end of file
+void compareDistance(BWAPI::TilePosition pos1, BWAPI::TilePosition pos2);
+
+// The tests below compare every pair of positions, plus an unwalkable start tile, with unidirectional A*.
+
+// getGroundDistanceMatrix, serial and parallel, from the sources and from the targets
+void testDistanceMatrix(const std::vector<BWAPI::TilePosition>& positions);
+// JPS and JPS+ (getGroundDistance with each pathfinding mode)
+void testJumpPointSearch(const std::vector<BWAPI::TilePosition>& positions);
+// HPA* (getGroundDistance2), never shorter than A*, and how much longer it is
+void testHierarchicalDistance(const std::vector<BWAPI::TilePosition>& positions);
+// GroundDistanceOracle, with and without a blocked tile (setGroundDistanceOracle(true) before analyze())
+void testContractionHierarchy(const std::vector<BWAPI::TilePosition>& positions);
+// bidirectional A* on every query
+void testBidirectionalSearch(const std::vector<BWAPI::TilePosition>& positions);
+
+// DynamicPath and DynamicDistanceMap between two start locations against getGroundDistance, while
+// squares are blocked and unblocked across the path
+void testDynamicPaths();
+
+// PathRequest stepped with the smallest budget against getShortestPath, with a square across the path
+// blocked and then unblocked while the search is pending
+void testPathRequests();
\ No newline at end of file
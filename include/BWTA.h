@@ -5,21 +5,82 @@
 #include <BWTA/Region.h>
 #include <BWTA/BaseLocation.h>
 #include <BWTA/RectangleArray.h>
+#include <BWTA/GridView.h>
+#include <BWTA/Skeleton.h>
+#include <BWTA/PathRequest.h>
+#include <BWTA/DynamicPath.h>
+#include <BWTA/GroundDistanceOracle.h>
+#include <BWTA/FlowField.h>
+#include <BWTA/HierarchicalPath.h>
 namespace BWTA
 {
   void analyze(); // will check if we can load cache file or we need to analyze the map
+
+  // Steps of the analysis, in order. The results of a step can be queried as soon as it is reached.
+  enum AnalysisStep {
+    ANALYSIS_NOT_STARTED,
+    ANALYSIS_POLYGONS,      // getUnwalkablePolygons()
+    ANALYSIS_REGIONS,       // getRegions(), getChokepoints(), getRegion(), getSkeleton(), isConnected()
+                            // (not Region::getBaseLocations() nor Region::getCoverPoints())
+    ANALYSIS_CLOSEST_MAPS,  // getNearestChokepoint(), getNearestBaseLocation(), getNearestUnwalkablePolygon()
+    ANALYSIS_DONE           // everything, including the base location properties
+  };
+  // Same as analyze() but the analysis (or the cache loading) runs on a worker thread. Poll isReady()
+  // from the thread that called it (it uses BWAPI to finish the analysis), e.g. in onFrame.
+  void analyzeAsync();
+  bool isReady(AnalysisStep step = ANALYSIS_DONE);
+  AnalysisStep getAnalysisStep();
+  void waitForAnalysis(); // blocks until the analysis is done
   void computeDistanceTransform();
   void balanceAnalysis();
   void cleanMemory();
+  // keep the walk resolution label maps run-length encoded in memory, the dense arrays are
+  // only rebuilt if something needs them (call it before analyze)
+  void setCompactLabelMaps(bool compact);
+  // least recently used cache files are deleted when their total size goes over this (default 256 MB)
+  void setCacheSizeLimit(size_t bytes);
+  // save a checkpoint after each stage of the analysis and resume from the first stage whose inputs
+  // changed, useful when tuning the analysis parameters (default false)
+  void setAnalysisCheckpoints(bool enabled);
+  // for several bots on the same host: the first one to analyse a map publishes the cache file and
+  // the others wait for it and map it instead of analysing again (default false). Only the three walk
+  // resolution label maps stay in the mapping, with pages shared by the processes (not with
+  // setCompactLabelMaps). The rest is still copied in each process: regions, chokepoints, bases and
+  // polygons, the tile and walk resolution maps of pointers, and the tables loaded on first use
+  // (skeleton, jump table, landmarks, contraction hierarchy, navigation mesh).
+  void setSharedAnalysis(bool enabled);
+  // threads used by the analysis, 0 = one per core (default), 1 = no extra threads
+  void setAnalysisThreadCount(unsigned int threads);
+  // build the contraction hierarchy of GroundDistanceOracle during the analysis and keep it in the
+  // cache file; it takes about 0.25 s on a 128x128 map and 2 s on a 256x256 one (default false)
+  void setGroundDistanceOracle(bool enabled);
 
+  // the distance transform is computed on first use (or by computeDistanceTransform())
   int getMaxDistanceTransform();
   RectangleArray<int>* getDistanceTransformMap();
 
+  // Read-only views of the analysis grids, without copies. The label maps loaded from the cache point
+  // into the file mapping, except with setCompactLabelMaps(true): then the first call decodes the
+  // map on the heap. They are valid until the next analyze() or cleanMemory().
+  // Walk resolution:
+  GridView<bool> getWalkabilityView();
+  GridView<int> getDistanceTransformView(); // computed on first use
+  GridView<int> getRegionLabelView(); // Region::getLabel(), 0 if unwalkable
+  GridView<int> getClosestObstacleLabelView(); // label of the closest unwalkable polygon
+  GridView<Chokepoint*> getNearestChokepointWalkView();
+  GridView<BaseLocation*> getNearestBaseLocationWalkView();
+  // Tile resolution:
+  GridView<bool> getBuildabilityView();
+  GridView<Chokepoint*> getNearestChokepointView();
+  GridView<BaseLocation*> getNearestBaseLocationView();
+  GridView<Polygon*> getNearestUnwalkablePolygonView();
+
   const std::vector<Region*>& getRegions();
   const std::set<Chokepoint*>& getChokepoints();
   const std::set<BaseLocation*>& getBaseLocations();
   const std::set<BaseLocation*>& getStartLocations();
   const std::vector<Polygon*>& getUnwalkablePolygons();
+  const Skeleton& getSkeleton(); // medial axis of the walkable space (walk resolution)
 
   BaseLocation* getStartLocation(BWAPI::Player player);
 
@@ -43,15 +104,73 @@ namespace BWTA
   bool isConnected(int x1, int y1, int x2, int y2); // in TilePosition
   bool isConnected(BWAPI::TilePosition a, BWAPI::TilePosition b);
 
+  // Dynamic obstacles (buildings, a wall-in...) on top of the static tile walkability. The tile
+  // searches (getGroundDistance(s), getShortestPath, PathRequest, DynamicPath) and isConnected see
+  // them, JPS+ falls back to JPS while tiles are blocked. The HPA* tables and the BaseLocation
+  // distances keep the walkability they were computed with. analyze() drops the blocked tiles;
+  // the calls made while an analysis runs (analyzeAsync) take effect once it is ready.
+  void blockTiles(const std::vector<BWAPI::TilePosition>& tiles);
+  void blockTiles(BWAPI::TilePosition topLeft, int width, int height);
+  void unblockTiles(const std::vector<BWAPI::TilePosition>& tiles);
+  void unblockTiles(BWAPI::TilePosition topLeft, int width, int height);
+  void unblockAllTiles();
+  bool isTileBlocked(BWAPI::TilePosition tile);
+
   double getGroundDistance(BWAPI::TilePosition start, BWAPI::TilePosition end);
   std::pair<BWAPI::TilePosition, double> getNearestTilePosition(BWAPI::TilePosition start, const std::set<BWAPI::TilePosition>& targets);
   std::map<BWAPI::TilePosition, double> getGroundDistances(BWAPI::TilePosition start, const std::set<BWAPI::TilePosition>& targets);
+  // distance in pixels from start to each tile (32 straight, 45 diagonal), -1 if unreachable
   void getGroundDistanceMap(BWAPI::TilePosition start, RectangleArray<double>& distanceMap);
+  // same in 16 bits, 0xFFFF if unreachable or farther than 65534 pixels
+  void getGroundDistanceMap(BWAPI::TilePosition start, RectangleArray<uint16_t>& distanceMap);
+  // matrix[i][j] = getGroundDistance(sources[i], targets[j]), with one Dijkstra per source (or per target
+  // when there are fewer targets); parallel spreads the searches over the analysis threads
+  void getGroundDistanceMatrix(const std::vector<BWAPI::TilePosition>& sources, const std::vector<BWAPI::TilePosition>& targets,
+    RectangleArray<double>& matrix, bool parallel = false);
+  // one search for any number of units going to target: the next tile from every tile (see FlowField),
+  // the fields of the last targets are kept until tiles are blocked/unblocked or the next analyze()
+  FlowField getFlowField(BWAPI::TilePosition target);
+  void setFlowFieldCacheSize(size_t fields); // default 16, about 5 bytes per tile each
   std::vector<BWAPI::TilePosition> getShortestPath(BWAPI::TilePosition start, BWAPI::TilePosition end);
   std::vector<BWAPI::TilePosition> getShortestPath(BWAPI::TilePosition start, const std::set<BWAPI::TilePosition>& targets);
+  // Any-angle path: getShortestPath reduced to the tiles where it has to turn, each one in line of
+  // sight of the next. smoothPath does the same with any tile path, hasLineOfSight tells if every
+  // tile under the segment between the two tile centers is walkable (blocked tiles included).
+  std::vector<BWAPI::TilePosition> getAnyAnglePath(BWAPI::TilePosition start, BWAPI::TilePosition end);
+  std::vector<BWAPI::TilePosition> smoothPath(const std::vector<BWAPI::TilePosition>& path);
+  bool hasLineOfSight(BWAPI::TilePosition a, BWAPI::TilePosition b);
+  // Navigation mesh: the walkable area around the unwalkable polygons cut in triangles by analyze()
+  // (stored in the cache file). The path is an A* over the triangles pulled tight through them
+  // (funnel): the points where it turns, in pixels, from start to end, empty if unreachable. The
+  // polygons are simplified and units have no size, so it grazes the obstacle corners. While tiles
+  // are blocked, or if the polygons close a narrow passage, it follows getAnyAnglePath instead.
+  std::vector<BWAPI::Position> getNavMeshPath(BWAPI::Position start, BWAPI::Position end);
+
+  // Search used by getGroundDistance(s), getNearestTilePosition and getShortestPath. They all give the
+  // same distances, the paths may differ between paths of the same length.
+  enum PathfindingMode {
+    PATHFINDING_ASTAR,    // A* expanding every tile (default)
+    PATHFINDING_JPS,      // Jump Point Search, far fewer expansions on open ground
+    PATHFINDING_JPS_PLUS  // JPS with the jumps precomputed by the analysis (falls back to JPS until it is done)
+  };
+  void setPathfindingMode(PathfindingMode mode);
+  PathfindingMode getPathfindingMode();
+  // with PATHFINDING_ASTAR, getGroundDistance searches from both ends at once when start and end are
+  // more than this many tiles apart (octile distance, default 64, 0 = never); same distances
+  void setBidirectionalSearchDistance(int tiles);
+
+  // Walk resolution paths for a unit of a given size (its largest dimension in pixels, or the size of
+  // unitType): they only cross walk tiles far enough from the obstacles for the unit, using the
+  // distance transform (computed on first use). A tile resolution search picks a corridor first, so
+  // the path can be slightly longer than the shortest one. Empty path / -1 if there is none.
+  std::vector<BWAPI::WalkPosition> getClearancePath(BWAPI::WalkPosition start, BWAPI::WalkPosition end, int unitSize);
+  std::vector<BWAPI::WalkPosition> getClearancePath(BWAPI::WalkPosition start, BWAPI::WalkPosition end, BWAPI::UnitType unitType);
+  double getClearanceDistance(BWAPI::WalkPosition start, BWAPI::WalkPosition end, int unitSize); // in pixels
+  double getClearanceDistance(BWAPI::WalkPosition start, BWAPI::WalkPosition end, BWAPI::UnitType unitType);
 
    // HPA* implementation
   void buildChokeNodes();
+  // only the chokepoints of the route, see HierarchicalPath for the tiles
   std::list<Chokepoint*> getShortestPath2(BWAPI::TilePosition start, BWAPI::TilePosition target);
   int getGroundDistance2(BWAPI::TilePosition start, BWAPI::TilePosition end);
 
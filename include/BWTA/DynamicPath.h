@@ -0,0 +1,59 @@
+#pragma once
+#include <vector>
+#include <BWAPI.h>
+namespace BWTA
+{
+	class LpaSearch;
+
+	/**
+	 * Shortest path from start to end that follows blockTiles()/unblockTiles(): the search is kept
+	 * and, when tiles change, only the part of it that depends on them is searched again (LPA*).
+	 * Same distances as getShortestPath(). Use it from the thread that blocks the tiles, and create
+	 * it again after analyze().
+	 */
+	class DynamicPath
+	{
+	public:
+		DynamicPath(BWAPI::TilePosition start, BWAPI::TilePosition end);
+		~DynamicPath();
+
+		std::vector<BWAPI::TilePosition> getPath(); // empty if there is none
+		double getDistance(); // pixels, -1 if unreachable
+
+		BWAPI::TilePosition getStart() const { return _start; }
+		BWAPI::TilePosition getEnd() const { return _end; }
+
+	private:
+		// non-copyable
+		DynamicPath(const DynamicPath&);
+		DynamicPath& operator=(const DynamicPath&);
+
+		LpaSearch* _search;
+		BWAPI::TilePosition _start;
+		BWAPI::TilePosition _end;
+	};
+
+	/**
+	 * Ground distances from start to every tile, repaired the same way when tiles are blocked or
+	 * unblocked. Distances are those of getGroundDistance() (not getGroundDistanceMap()).
+	 */
+	class DynamicDistanceMap
+	{
+	public:
+		explicit DynamicDistanceMap(BWAPI::TilePosition start);
+		~DynamicDistanceMap();
+
+		double getDistance(BWAPI::TilePosition tile); // pixels, -1 if unreachable
+		std::vector<BWAPI::TilePosition> getPath(BWAPI::TilePosition tile); // from start, empty if unreachable
+
+		BWAPI::TilePosition getStart() const { return _start; }
+
+	private:
+		// non-copyable
+		DynamicDistanceMap(const DynamicDistanceMap&);
+		DynamicDistanceMap& operator=(const DynamicDistanceMap&);
+
+		LpaSearch* _search;
+		BWAPI::TilePosition _start;
+	};
+}
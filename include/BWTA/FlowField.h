@@ -0,0 +1,35 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <BWAPI.h>
+namespace BWTA
+{
+	struct FlowFieldData;
+
+	/**
+	 * Next step toward a target from every tile, from a single Dijkstra search out of the target with
+	 * the moves and costs of getShortestPath(): any number of units can follow it with one lookup
+	 * per unit and frame. Following getNextTile() gives a shortest path, the distances are those of
+	 * getGroundDistance(). An unwalkable tile steps to its best walkable neighbor (an unwalkable
+	 * target is reached from its walkable neighbors).
+	 * A FlowField is a cheap handle to an immutable field shared with the cache of getFlowField(),
+	 * it stays valid after the field is evicted, but keeps the walkability it was computed with.
+	 */
+	class FlowField
+	{
+	public:
+		FlowField() {}
+		explicit FlowField(const std::shared_ptr<const FlowFieldData>& data) : _data(data) {} // see getFlowField()
+
+		bool empty() const { return !_data; }
+		BWAPI::TilePosition getTarget() const;
+		// tile to move to, the target at the target, TilePositions::None if the target is unreachable
+		BWAPI::TilePosition getNextTile(BWAPI::TilePosition tile) const;
+		double getDistance(BWAPI::TilePosition tile) const; // pixels to the target, -1 if unreachable
+		// tiles from tile to the target following the field, empty if unreachable
+		std::vector<BWAPI::TilePosition> getPath(BWAPI::TilePosition tile) const;
+
+	private:
+		std::shared_ptr<const FlowFieldData> _data;
+	};
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <BWTA/RectangleArray.h>
+namespace BWTA
+{
+	/**
+	 * Non-owning, read-only view of a 2D grid. The grids are stored column-major like
+	 * RectangleArray: item (x,y) is data()[x * stride() + y], so each column is contiguous and
+	 * can be scanned without bounds checks.
+	 * A view is only valid while the grid it points to is alive (see the getters in BWTA.h).
+	 */
+	template <class Type>
+	class GridView
+	{
+	public:
+		GridView() : _data(nullptr), _width(0), _height(0), _stride(0) {}
+		GridView(const Type* data, int width, int height, int stride)
+			: _data(data), _width(width), _height(height), _stride(stride) {}
+		// an empty grid (not analyzed yet or cleared) gives an empty view
+		explicit GridView(const RectangleArray<Type>& grid)
+			: _data(nullptr), _width(0), _height(0), _stride(0)
+		{
+			if (grid.getWidth() == 0 || grid.getHeight() == 0) return;
+			_data = grid[0];
+			_width = grid.getWidth();
+			_height = grid.getHeight();
+			_stride = grid.getHeight();
+		}
+
+		const Type* data() const { return _data; }
+		int getWidth() const { return _width; }
+		int getHeight() const { return _height; }
+		int getStride() const { return _stride; } // items between the start of two consecutive columns
+		bool empty() const { return _data == nullptr || _width == 0 || _height == 0; }
+
+		const Type* getColumn(int x) const { return _data + x * _stride; }
+		const Type& operator()(int x, int y) const { return _data[x * _stride + y]; }
+		bool isValid(int x, int y) const { return x >= 0 && y >= 0 && x < _width && y < _height; }
+
+		// view of the rectangle [x, x+width) x [y, y+height), it must be inside this view
+		GridView subView(int x, int y, int width, int height) const
+		{
+			return GridView(_data + x * _stride + y, width, height, _stride);
+		}
+
+	private:
+		const Type* _data;
+		int _width;
+		int _height;
+		int _stride;
+	};
+}
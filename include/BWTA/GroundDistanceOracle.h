@@ -0,0 +1,32 @@
+#pragma once
+#include <BWAPI.h>
+namespace BWTA
+{
+	struct ContractionHierarchyQuery;
+
+	/**
+	 * Same distances as getGroundDistance(), answered in a few microseconds from a contraction
+	 * hierarchy of the tile graph instead of an A* search. The hierarchy is built by the analysis
+	 * when setGroundDistanceOracle(true) was called before analyze(), and stored in the cache file.
+	 * Until it is available, and while tiles are blocked (blockTiles), getDistance() calls
+	 * getGroundDistance(). Each object keeps its own search memory: use one per thread.
+	 */
+	class GroundDistanceOracle
+	{
+	public:
+		GroundDistanceOracle();
+		~GroundDistanceOracle();
+
+		double getDistance(BWAPI::TilePosition start, BWAPI::TilePosition end); // pixels, -1 if unreachable
+
+		// the hierarchy of the current map is loaded and no tile is blocked
+		static bool isAvailable();
+
+	private:
+		// non-copyable
+		GroundDistanceOracle(const GroundDistanceOracle&);
+		GroundDistanceOracle& operator=(const GroundDistanceOracle&);
+
+		ContractionHierarchyQuery* _query;
+	};
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <list>
+#include <vector>
+#include <BWAPI.h>
+namespace BWTA
+{
+	class Chokepoint;
+
+	/**
+	 * Path solved on the chokepoint graph first (the route of getShortestPath2) and refined into
+	 * tiles one segment at a time: segment i goes from waypoint i to waypoint i + 1 (start, the
+	 * center of each chokepoint of the route, target) with an A* that only crosses the tiles of the
+	 * regions of the route. Refining the segments as the unit advances, a long path only costs the
+	 * searches of the segments it actually follows, each of them a small part of the map.
+	 * The route goes through the chokepoint centers, so the path can be a bit longer than the one
+	 * of getShortestPath(). Create it after analyze() and use it from one thread.
+	 */
+	class HierarchicalPath
+	{
+	public:
+		HierarchicalPath(BWAPI::TilePosition start, BWAPI::TilePosition target);
+
+		BWAPI::TilePosition getStart() const { return _start; }
+		BWAPI::TilePosition getTarget() const { return _target; }
+		bool isReachable() const { return !_waypoints.empty(); } // the chokepoint graph has a route
+		const std::list<Chokepoint*>& getChokepoints() const { return _chokepoints; }
+		const std::vector<BWAPI::TilePosition>& getWaypoints() const { return _waypoints; }
+
+		int getSegmentCount() const { return (int)_segments.size(); }
+		// segment crossing the region of tile, -1 if the route does not go through it
+		int getSegmentIndex(BWAPI::TilePosition tile) const;
+		// tiles from waypoint index to waypoint index + 1, searched on the first call (empty if none
+		// or if index is not a segment)
+		const std::vector<BWAPI::TilePosition>& getSegment(int index);
+		bool isRefined(int index) const { return index >= 0 && index < getSegmentCount() && _refined[index] != 0; }
+		// every segment refined and joined, empty if one of them has no path
+		std::vector<BWAPI::TilePosition> getPath();
+
+	private:
+		BWAPI::TilePosition _start;
+		BWAPI::TilePosition _target;
+		std::list<Chokepoint*> _chokepoints;
+		std::vector<BWAPI::TilePosition> _waypoints;
+		std::vector<int> _segmentRegions;	// region crossed by each segment (index in getRegions())
+		std::vector<char> _inRoute;			// by region index + 1, tiles without region are allowed too
+		std::vector<std::vector<BWAPI::TilePosition>> _segments;
+		std::vector<char> _refined;
+	};
+}
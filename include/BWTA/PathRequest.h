@@ -0,0 +1,78 @@
+#pragma once
+#include <vector>
+#include <BWAPI.h>
+namespace BWTA
+{
+	/**
+	 * getShortestPath() that can be run a slice at a time: step() advances the search for a time
+	 * budget and the next call resumes it, so a long query can be spread over several frames. The
+	 * distance is the same as getGroundDistance(start, end) and the path as short as getShortestPath's
+	 * (where several paths are shortest, not always the same one). Blocking or unblocking tiles
+	 * between two steps starts the search again on the new walkability.
+	 * The map must not be analysed again while a request is pending.
+	 */
+	class PathRequest
+	{
+	public:
+		enum Status { PENDING, FOUND, NOT_FOUND };
+
+		PathRequest(BWAPI::TilePosition start, BWAPI::TilePosition end, int priority = 0);
+		~PathRequest();
+
+		// runs the search for about budgetMicroseconds (at least a few hundred tiles) unless it is
+		// already finished, returns the new status
+		Status step(double budgetMicroseconds);
+		// stops the search and frees its memory, the request stays NOT_FOUND
+		void cancel();
+
+		Status getStatus() const { return _status; }
+		bool isDone() const { return _status != PENDING; }
+		const std::vector<BWAPI::TilePosition>& getPath() const { return _path; } // empty unless FOUND
+		double getDistance() const { return _distance; } // pixels, -1 unless FOUND
+
+		BWAPI::TilePosition getStart() const { return _start; }
+		BWAPI::TilePosition getEnd() const { return _end; }
+		int getPriority() const { return _priority; }
+		void setPriority(int priority) { _priority = priority; }
+
+	private:
+		// non-copyable
+		PathRequest(const PathRequest&);
+		PathRequest& operator=(const PathRequest&);
+
+		void finish(int node);
+
+		struct Search;
+		Search* _search; // null until the first step and once done
+		BWAPI::TilePosition _start;
+		BWAPI::TilePosition _end;
+		int _priority;
+		Status _status;
+		std::vector<BWAPI::TilePosition> _path;
+		double _distance;
+	};
+
+	/**
+	 * Runs the pending PathRequests within a per-frame time budget, highest priority first (in the
+	 * order they were added for the same priority). The requests are not owned: they must stay
+	 * alive until they are done or removed.
+	 */
+	class PathScheduler
+	{
+	public:
+		explicit PathScheduler(double frameBudgetMicroseconds = 2000);
+
+		void add(PathRequest* request);
+		void remove(PathRequest* request);
+		// call once per frame, returns how many requests were finished
+		int update();
+
+		size_t getPendingCount() const { return _pending.size(); }
+		double getFrameBudget() const { return _frameBudget; }
+		void setFrameBudget(double microseconds) { _frameBudget = microseconds; }
+
+	private:
+		std::vector<PathRequest*> _pending;
+		double _frameBudget;
+	};
+}
@@ -49,6 +49,13 @@ namespace BWTA
         */
        void setItem(unsigned int x, unsigned int y, Type *item);
        void resize(unsigned int width, unsigned int height);
+       /**
+        * Uses external memory (width*height items, column-major) as array data.
+        * The array does not take ownership, the memory must outlive it or be replaced with resize.
+        */
+       void attach(unsigned int width, unsigned int height, Type* data);
+       /** Returns true if the array allocated (and will delete) its data */
+       bool isOwner() const { return owner; }
 	   void saveToFile(const std::string& fileName, char del = '\0');
 	   void saveToFile(std::ofstream& out, char del = '\0');
        /** Sets all fields of the array to the specified value */
@@ -130,6 +137,10 @@ namespace BWTA
   template <class Type>
   const RectangleArray<Type>& RectangleArray<Type>::operator=(const RectangleArray<Type>& rectangleArray)
   {
+	  if (this == &rectangleArray) return *this;
+	  delete [] this->columns;
+	  if (this->owner)
+	    delete [] this->data;
 	  this->setWidth(rectangleArray.getWidth());
 	  this->setHeight(rectangleArray.getHeight());
 	  this->owner = true;
@@ -212,16 +223,20 @@ namespace BWTA
   template <class Type>
   void RectangleArray<Type>::resize(unsigned int width, unsigned int height)
   {
-    if (this->getWidth() == width &&
+    // external data is always replaced by an owned buffer
+    if (this->owner &&
+        this->getWidth() == width &&
         this->getHeight() == height)
       return;
 
     delete [] this->columns;
-    delete [] this->data;  
+    if (this->owner)
+      delete [] this->data;
 
     this->setWidth(width);
     this->setHeight(height);
 
+    this->owner = true;
     this->data = new Type[this->width * this->height];
 
     this->columns = new Type*[this->width];
@@ -229,6 +244,25 @@ namespace BWTA
     for (unsigned int position = 0;i < this->width; i ++,position += this->height)
       columns[i] = &data[position];
   }
+  //------------------------------------------------- ATTACH -------------------------------------------------
+  template <class Type>
+  void RectangleArray<Type>::attach(unsigned int width, unsigned int height, Type* data)
+  {
+    delete [] this->columns;
+    if (this->owner)
+      delete [] this->data;
+
+    this->setWidth(width);
+    this->setHeight(height);
+
+    this->owner = false;
+    this->data = data;
+
+    this->columns = new Type*[this->width];
+    unsigned int i = 0;
+    for (unsigned int position = 0;i < this->width; i ++,position += this->height)
+      columns[i] = &data[position];
+  }
   //---------------------------------------------- SAVE TO FILE ----------------------------------------------
   template <class Type>
   void RectangleArray<Type>::saveToFile(const std::string& fileName, char del)
@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+#include <BWAPI.h>
+namespace BWTA
+{
+	/**
+	 * Medial axis of the walkable space: the Voronoi graph of the unwalkable polygons after pruning
+	 * the branches too close to an obstacle, in walk resolution. Useful to follow corridors or to
+	 * find kiting lanes without recomputing a Voronoi diagram.
+	 * Adjacency is stored in CSR form: the neighbors of node i are
+	 * getNeighbors(i)[0 .. getDegree(i)-1].
+	 */
+	class Skeleton
+	{
+	public:
+		enum NodeType { NONE, REGION, CHOKEPOINT };
+		static const int INVALID_NODE = -1;
+
+		Skeleton() : _bucketColumns(0), _bucketRows(0) {}
+
+		// replaces the graph, adjacencyStart has size()+1 entries
+		void assign(const std::vector<BWAPI::WalkPosition>& positions, const std::vector<double>& clearances,
+			const std::vector<NodeType>& types, const std::vector<int>& adjacencyStart, const std::vector<int>& adjacency);
+		void clear();
+
+		int size() const { return static_cast<int>(_positions.size()); }
+		bool empty() const { return _positions.empty(); }
+
+		const BWAPI::WalkPosition& getPosition(int node) const { return _positions[node]; }
+		double getClearance(int node) const { return _clearances[node]; } // distance to the closest obstacle (walk tiles)
+		NodeType getType(int node) const { return _types[node]; }
+		int getDegree(int node) const { return _adjacencyStart[node + 1] - _adjacencyStart[node]; }
+		const int* getNeighbors(int node) const { return _adjacency.data() + _adjacencyStart[node]; }
+
+		// closest node to pos (euclidean), INVALID_NODE if the skeleton is empty
+		int getNearestNode(const BWAPI::WalkPosition& pos) const;
+		/**
+		 * Follows the skeleton starting at node in the direction of its neighbor next, while the
+		 * nodes are part of a corridor (exactly two neighbors). Returns the visited nodes starting
+		 * with node and ending at the first junction or leaf, or after maxNodes nodes (0 = no limit).
+		 */
+		std::vector<int> walk(int node, int next, int maxNodes = 0) const;
+		// shortest sequence of nodes from start to end along the skeleton, empty if they are not connected
+		std::vector<int> getPath(int start, int end) const;
+
+		const std::vector<BWAPI::WalkPosition>& getPositions() const { return _positions; }
+		const std::vector<double>& getClearances() const { return _clearances; }
+		const std::vector<NodeType>& getTypes() const { return _types; }
+		const std::vector<int>& getAdjacencyStart() const { return _adjacencyStart; }
+		const std::vector<int>& getAdjacency() const { return _adjacency; }
+
+	private:
+		void buildBuckets();
+
+		std::vector<BWAPI::WalkPosition> _positions;
+		std::vector<double> _clearances;
+		std::vector<NodeType> _types;
+		std::vector<int> _adjacencyStart;
+		std::vector<int> _adjacency;
+
+		// nodes bucketed in square cells (CSR as well) to speed up getNearestNode
+		int _bucketColumns;
+		int _bucketRows;
+		std::vector<int> _bucketStart;
+		std::vector<int> _bucketNodes;
+	};
+}